@@ -56,8 +56,12 @@
 #include "i_endoom.h"
 #include "i_input.h"
 #include "i_joystick.h"
+#include "i_perf.h"
+#include "i_simd.h"
 #include "i_system.h"
+#include "i_timer.h"
 #include "g_game.h"
+#include "g_demobatch.h"
 #include "wi_stuff.h"
 #include "st_bar.h"
 #include "am_map.h"
@@ -200,6 +204,70 @@ static void ID_DrawMessageCentered (void)
     M_WriteTextCentered(63, player->messageCentered, player->messageCenteredColor);
 }
 
+// -----------------------------------------------------------------------------
+// D_ColumnBenchmark
+//  [JN] Renders the current view at every resolution multiplier with
+//  immediate and with batched column drawing, and prints average time
+//  of one frame for both. Done once, on the first frame of a level.
+// -----------------------------------------------------------------------------
+
+#define COLUMNBENCH_FRAMES 64
+
+static boolean columnbench;
+
+static void D_ColumnBenchmarkReInit (void)
+{
+    // Same as changing rendering resolution in the menu.
+    I_ReInitGraphics(REINIT_FRAMEBUFFERS | REINIT_TEXTURES | REINIT_ASPECTRATIO);
+    R_ExecuteSetViewSize();
+    R_FillBackScreen();
+    V_EnableLoadingDisk();
+    ST_InitElementsBackground();
+    AM_LevelInit(true);
+}
+
+static void D_ColumnBenchmark (void)
+{
+    const int old_resolution = vid_resolution;
+    const int old_column_batch = vid_column_batch;
+
+    printf("D_ColumnBenchmark: %d frames per run, ms per frame:\n",
+           COLUMNBENCH_FRAMES);
+
+    for (int res = 1 ; res <= MAXHIRES ; res++)
+    {
+        double frametime[2];
+
+        vid_resolution = res;
+        D_ColumnBenchmarkReInit();
+
+        for (int batch = 0 ; batch < 2 ; batch++)
+        {
+            uint64_t start;
+
+            vid_column_batch = batch;
+
+            // Warm up caches and zone memory before timing.
+            R_RenderPlayerView(&players[displayplayer]);
+
+            start = I_GetTimeUS();
+            for (int i = 0 ; i < COLUMNBENCH_FRAMES ; i++)
+            {
+                R_RenderPlayerView(&players[displayplayer]);
+            }
+            frametime[batch] = (I_GetTimeUS() - start) / 1000.0 / COLUMNBENCH_FRAMES;
+        }
+
+        printf("  %dX (%dx%d): immediate %.3f, batched %.3f, gain %.1f%%\n",
+               res, SCREENWIDTH, SCREENHEIGHT, frametime[0], frametime[1],
+               100.0 * (frametime[0] - frametime[1]) / frametime[0]);
+    }
+
+    vid_resolution = old_resolution;
+    vid_column_batch = old_column_batch;
+    D_ColumnBenchmarkReInit();
+}
+
 // -----------------------------------------------------------------------------
 // D_Display
 //  draw current display, possibly wiping it from the previous
@@ -243,6 +311,13 @@ static void D_Display (void)
         oldgamestate = -1;  // force background redraw
     }
 
+    if (columnbench && gamestate == GS_LEVEL && gametic)
+    {
+        columnbench = false;
+        D_ColumnBenchmark();
+        oldgamestate = -1;  // force background redraw
+    }
+
     // save the current screen if about to wipe
     // [JN] Make screen wipe optional, use external config variable.
     if (gamestate != wipegamestate && vid_screenwipe)
@@ -286,6 +361,8 @@ static void D_Display (void)
             if (automapactive || (widget_levelname && widget_enable && dp_screen_size < 15))
             AM_LevelNameDrawer();
 
+            I_PerfStart(PERF_WIDGETS);
+
             // [JN] Do not draw any widgets if not in game level.
             if (widget_enable)
             {
@@ -313,6 +390,8 @@ static void D_Display (void)
             if (xhair_draw && !automapactive)
             ID_DrawCrosshair();
 
+            I_PerfStop(PERF_WIDGETS);
+
             // [JN] Main status bar drawing function.
             if (dp_screen_size < 15 || (automapactive && !automap_overlay))
             {
@@ -323,7 +402,9 @@ static void D_Display (void)
                               ||  setsizeneeded         // Screen size changing
                               || (menuactive && dp_menu_shading)); // Menu shading while non-capped game mode
             
+                I_PerfStart(PERF_STBAR);
                 ST_Drawer(st_forceredraw);
+                I_PerfStop(PERF_STBAR);
             }
 
             // [JN] Chat drawer
@@ -372,6 +453,8 @@ static void D_Display (void)
                           W_CacheLumpName (DEH_String("M_PAUSE"), PU_CACHE));
     }
 
+    I_PerfStart(PERF_WIDGETS);
+
     // [JN] Draw right widgets in any states except finale text screens.
     if (widget_enable)
     {
@@ -393,6 +476,8 @@ static void D_Display (void)
     // [JN] Handle centered player messages.
     ID_DrawMessageCentered();
 
+    I_PerfStop(PERF_WIDGETS);
+
     // menus go directly to the screen
     M_Drawer ();   // menu is drawn even on top of everything
     NetUpdate ();  // send out any new accumulation
@@ -552,11 +637,15 @@ void D_DoomLoop (void)
 
     while (1)
     {
+        const uint64_t framestart = I_GetTimeUS();
+        uint64_t ticend;
+
         // frame syncronous IO operations
         I_StartFrame ();
 
         // will run at least one tic
         TryRunTics ();
+        ticend = I_GetTimeUS();
 
         // Update display, next frame, with current state.
         if (screenvisible)
@@ -576,6 +665,9 @@ void D_DoomLoop (void)
             S_UpdateSounds (players[displayplayer].mo);
             oldgametic = gametic;
         }
+
+        // [JN] -timedemo frame time statistics.
+        G_TimeDemoFrame(framestart, ticend);
     }
 }
 
@@ -1522,6 +1614,9 @@ void D_DoomMain (void)
 
    	I_AtExit(D_Endoom, false);
 
+    // [JN] Batch demo runner, does not return.
+    G_DemoBatch();
+
     //!
     // @category net
     //
@@ -1717,7 +1812,12 @@ void D_DoomMain (void)
     diskicon_enabled = true;
 
     // Save configuration at exit.
-    I_AtExit(M_SaveDefaults, true); // [crispy] always save configuration at exit
+    // [JN] Do not save configuration from -demobatch workers,
+    // since many of them run at once.
+    if (!M_ParmExists("-demobatch_result"))
+    {
+        I_AtExit(M_SaveDefaults, true); // [crispy] always save configuration at exit
+    }
 
     // Find main IWAD file and load it.
     iwadfile = D_FindIWAD(IWAD_MASK_DOOM, &gamemission);
@@ -2280,11 +2380,15 @@ void D_DoomMain (void)
     DEH_printf("M_Init: Init miscellaneous info.\n");
     M_Init ();
 
+    I_InitSIMD ();
+    I_InitPerf ();
+
     DEH_printf("R_Init: Init DOOM refresh daemon - [");
     R_Init ();
 
     DEH_printf("\nP_Init: Init Playloop state.\n");
     P_Init ();
+    P_InitStateHash ();
 
     DEH_printf("S_Init: Setting up sound.\n");
     S_Init (sfxVolume * 8, musicVolume * 8);
@@ -2319,6 +2423,15 @@ void D_DoomMain (void)
         DEH_printf("External statistics registered.\n");
     }
 
+    //!
+    // @category video
+    //
+    // Time rendering of the first level frame at every resolution
+    // multiplier, with immediate and with batched column drawing.
+    //
+
+    columnbench = M_CheckParm("-columnbench") > 0;
+
     //!
     // @arg <x>
     // @category demo
@@ -23,6 +23,7 @@
 #ifndef __D_THINK__
 #define __D_THINK__
 
+#include "doomtype.h"
 
 
 
@@ -64,6 +65,12 @@ typedef struct thinker_s
     struct thinker_s*	next;
     think_t		function;
     
+    // [JN] Links of the thinker's class list, see P_AddThinker.
+    struct thinker_s*	cprev;
+    struct thinker_s*	cnext;
+
+    // [JN] Mobj from the mobj pool, see P_FreeThinker.
+    boolean		pooled;
 } thinker_t;
 
 
@@ -536,56 +536,65 @@ enum
 #define MAXGEAR   (OVERDRIVE+16)
 
 // Map Object definition.
+// [JN] Fields read by every movement and collision check are grouped
+// right after the position, so P_XYMovement and P_TryMove touch as
+// few cache lines as possible. Rarely used fields are at the end.
 typedef struct mobj_s
 {
     // List: thinker links.
     thinker_t		thinker;
 
     // Info for drawing: position.
+    // Must follow the thinker, as in degenmobj_t.
     fixed_t		x;
     fixed_t		y;
     fixed_t		z;
 
-    // More list: links in sector (if needed)
-    struct mobj_s*	snext;
-    struct mobj_s*	sprev;
-
-    //More drawing info: to determine current sprite.
-    angle_t		angle;	// orientation
-    spritenum_t		sprite;	// used to find patch_t and flip value
-    int			frame;	// might be ORed with FF_FULLBRIGHT
+    // Momentums, used to update position.
+    fixed_t		momx;
+    fixed_t		momy;
+    fixed_t		momz;
 
-    // Interaction info, by BLOCKMAP.
-    // Links in blocks (if needed).
-    struct mobj_s*	bnext;
-    struct mobj_s*	bprev;
-    
-    struct subsector_s*	subsector;
+    // For movement checking.
+    fixed_t		radius;
+    fixed_t		height;	
 
     // The closest interval over all contacted Sectors.
     fixed_t		floorz;
     fixed_t		ceilingz;
 
-    // For movement checking.
-    fixed_t		radius;
-    fixed_t		height;	
+    int			flags;
+    int			intflags;  // [JN] killough 9/15/98: internal flags
 
-    // Momentums, used to update position.
-    fixed_t		momx;
-    fixed_t		momy;
-    fixed_t		momz;
+    struct subsector_s*	subsector;
+
+    mobjinfo_t*		info;	// &mobjinfo[mobj->type]
+    mobjtype_t		type;
+    int			health;
+
+    // Additional info record for player avatars only.
+    // Only valid if type == MT_PLAYER
+    struct player_s*	player;
 
     // If == validcount, already checked.
     int			validcount;
 
-    mobjtype_t		type;
-    mobjinfo_t*		info;	// &mobjinfo[mobj->type]
-    
+    // More list: links in sector (if needed)
+    struct mobj_s*	snext;
+    struct mobj_s*	sprev;
+
+    // Interaction info, by BLOCKMAP.
+    // Links in blocks (if needed).
+    struct mobj_s*	bnext;
+    struct mobj_s*	bprev;
+
+    //More drawing info: to determine current sprite.
+    angle_t		angle;	// orientation
+    spritenum_t		sprite;	// used to find patch_t and flip value
+    int			frame;	// might be ORed with FF_FULLBRIGHT
+
     int			tics;	// state tic counter
     state_t*		state;
-    int			flags;
-    int			intflags;  // [JN] killough 9/15/98: internal flags
-    int			health;
 
     // Movement direction, movement generation (zig-zagging).
     int			movedir;	// 0-7
@@ -606,18 +615,14 @@ typedef struct mobj_s
     short		gear;      // killough 11/98: used in torque simulation
     int			geartics;  // [JN] Duration of torque sumulation.
 
-    // Additional info record for player avatars only.
-    // Only valid if type == MT_PLAYER
-    struct player_s*	player;
-
     // Player number last looked for.
     int			lastlook;	
 
-    // For nightmare respawn.
-    mapthing_t		spawnpoint;	
-
     // Thing being chased/attacked for tracers.
     struct mobj_s*	tracer;	
+
+    // For nightmare respawn.
+    mapthing_t		spawnpoint;	
     
     // [AM] If true, ok to interpolate this tic.
     boolean             interp;
@@ -640,6 +645,11 @@ typedef struct mobj_s
     // [JN] Animated brightmaps.
     int         bmap_flick;
     int         bmap_glow;
+
+    // [JN] Game state hash of the mobj, and its index
+    // in the dirty list + 1 (0 if not dirty).
+    uint64_t    statehash;
+    int         hashslot;
 } mobj_t;
 
 // -----------------------------------------------------------------------------
@@ -0,0 +1,813 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Batch demo runner.
+//
+//      -demobatch <listfile> plays back every demo of the list in its own
+//      process, as many at a time as there are CPU cores. Every worker
+//      is this executable, run with the same command line plus -timedemo,
+//      -headless and -nodraw. When its demo ends, the worker writes the
+//      demo tics, time, final game state and state hash to a result file,
+//      read back by the runner for the report.
+//
+//      Every line of the list file is a demo, optionally followed by its
+//      expected state hash. A demo with a different hash at its end is
+//      reported as out of sync, as well as a demo recorded with -demohash
+//      which went out of sync. Lines starting with # are comments. The
+//      report is in the same format, so a report of a known good build
+//      can be used as the list file to check other builds.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define getpid() ((int) GetCurrentProcessId())
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
+#include "SDL.h"
+
+#include "doomstat.h"
+#include "g_demobatch.h"
+#include "g_game.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "id_func.h"
+#include "m_argv.h"
+#include "m_misc.h"
+#include "p_local.h"
+
+
+typedef enum
+{
+    batch_waiting,
+    batch_running,
+    batch_done,     // ended, no expected hash
+    batch_ok,       // ended with the expected hash
+    batch_desync,   // ended with another hash, or went out of sync
+    batch_failed    // quit with an error or crashed
+} batchstatus_t;
+
+static const char *batch_status_names[] = {
+    "waiting", "running", "done", "ok", "DESYNC", "FAILED"
+};
+
+static const char *batch_gamestate_names[] = {
+    "level", "intermission", "finale", "demoscreen"
+};
+
+typedef struct
+{
+    char          *name;
+    boolean        checkhash;
+    uint64_t       expected;
+
+    char          *resultfile;
+    char          *logfile;
+#ifdef _WIN32
+    HANDLE         process;
+#else
+    pid_t          pid;
+#endif
+    uint64_t       starttime;
+    int            exitcode;
+
+    batchstatus_t  status;
+    int            walltime;    // Milliseconds, process start to exit
+    int            tics;
+    int            realtics;
+    int            desynctic;   // From the hashes in the demo, -1 if none
+    char           ended[16];
+    char           map[16];
+    uint64_t       hash;
+    char           players[128];
+} batchdemo_t;
+
+static batchdemo_t *batch_demos;
+static int          batch_numdemos;
+
+// Parameters of the runner, not passed on to workers.
+// Per-run output files would be written by every worker at once, so
+// workers are getting their own "<file>.<n>" paths, n being the index of
+// the demo in the list. Outputs with fixed paths are not passed on.
+static const struct
+{
+    const char *name;
+    int         numargs;
+    boolean     perdemo;
+} batch_params[] = {
+    { "-demobatch",        1, false },
+    { "-demobatch_report", 1, false },
+    { "-jobs",             1, false },
+    { "-playdemo",         1, false },
+    { "-timedemo",         1, false },
+    { "-timedemo_report",  1, false },
+    { "-record",           1, false },
+    { "-framehash",        1, false },
+    { "-perflog",          1, false },
+    { "-columnbench",      0, false },
+    { "-levelstat",        0, false },
+    { "-dumpsubstconfig",  1, false },
+    { "-statehash",        1, true  },
+    { "-zonestats",        1, true  },
+    { "-statdump",         1, true  },
+    { "-netlog",           1, true  },
+};
+
+
+// -----------------------------------------------------------------------------
+// ReadDemoList
+// -----------------------------------------------------------------------------
+
+static void ReadDemoList (const char *filename)
+{
+    FILE *f;
+    char  line[1024];
+    int   maxdemos = 0;
+
+    f = M_fopen(filename, "r");
+
+    if (!f)
+    {
+        I_Error("G_DemoBatch: Failed to open %s", filename);
+    }
+
+    while (fgets(line, sizeof(line), f))
+    {
+        char name[1024], hash[32];
+        batchdemo_t *demo;
+        int n;
+
+        if (line[0] == '#')
+        {
+            continue;
+        }
+
+        n = sscanf(line, "%1023s %31s", name, hash);
+
+        if (n < 1)
+        {
+            continue;
+        }
+
+        if (batch_numdemos == maxdemos)
+        {
+            maxdemos = maxdemos ? maxdemos * 2 : 64;
+            batch_demos = I_Realloc(batch_demos, maxdemos * sizeof(*batch_demos));
+        }
+
+        demo = &batch_demos[batch_numdemos++];
+        memset(demo, 0, sizeof(*demo));
+        demo->name = M_StringDuplicate(name);
+        demo->checkhash = n == 2 && sscanf(hash, "%" SCNx64, &demo->expected) == 1;
+    }
+
+    fclose(f);
+}
+
+// -----------------------------------------------------------------------------
+// FindBatchParam
+// Returns index of a runner parameter in batch_params, -1 for others.
+// -----------------------------------------------------------------------------
+
+static int FindBatchParam (const char *arg)
+{
+    int i;
+
+    for (i = 0 ; i < arrlen(batch_params) ; i++)
+    {
+        if (!strcasecmp(arg, batch_params[i].name))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// -----------------------------------------------------------------------------
+// WorkerArgs
+// Command line of a worker: ours without runner parameters, plus demo.
+// Paths of per-demo outputs are stored after the pointers, in the same
+// allocation, so the whole command line is freed at once.
+// -----------------------------------------------------------------------------
+
+static const char **WorkerArgs (const batchdemo_t *demo)
+{
+    const char **argv;
+    char *paths;
+    size_t pathslen = 0;
+    int i, n = 0;
+
+    for (i = 1 ; i < myargc ; i++)
+    {
+        pathslen += strlen(myargv[i]) + 16;
+    }
+
+    argv = I_Realloc(NULL, (myargc + 16) * sizeof(*argv) + pathslen);
+    paths = (char *) (argv + myargc + 16);
+
+    argv[n++] = myargv[0];
+
+    for (i = 1 ; i < myargc ; i++)
+    {
+        const int param = FindBatchParam(myargv[i]);
+
+        if (param < 0)
+        {
+            argv[n++] = myargv[i];
+            continue;
+        }
+
+        if (batch_params[param].perdemo && i + 1 < myargc)
+        {
+            const size_t len = strlen(myargv[i + 1]) + 16;
+
+            M_snprintf(paths, len, "%s.%d", myargv[i + 1], (int) (demo - batch_demos));
+            argv[n++] = myargv[i];
+            argv[n++] = paths;
+            paths += len;
+        }
+
+        i += batch_params[param].numargs;
+    }
+
+    argv[n++] = "-timedemo";
+    argv[n++] = demo->name;
+    argv[n++] = "-demobatch_result";
+    argv[n++] = demo->resultfile;
+    argv[n++] = "-headless";
+    argv[n++] = "-nodraw";
+    argv[n++] = "-nosound";
+    argv[n++] = "-nogui";
+    argv[n] = NULL;
+
+    return argv;
+}
+
+#ifdef _WIN32
+
+// -----------------------------------------------------------------------------
+// QuoteArg
+// Appends an argument to a Windows command line, quoted.
+// -----------------------------------------------------------------------------
+
+static void QuoteArg (char *cmdline, size_t len, const char *arg)
+{
+    char *p = cmdline + strlen(cmdline);
+    char *const end = cmdline + len - 4;
+
+    if (p != cmdline && p < end)
+    {
+        *p++ = ' ';
+    }
+    *p++ = '"';
+
+    while (*arg && p < end)
+    {
+        int backslashes = 0;
+
+        while (*arg == '\\')
+        {
+            backslashes++;
+            arg++;
+        }
+
+        // Backslashes are only special before a quote.
+        if (*arg == '"' || *arg == '\0')
+        {
+            backslashes *= 2;
+        }
+
+        while (backslashes-- > 0 && p < end)
+        {
+            *p++ = '\\';
+        }
+
+        if (*arg == '"' && p < end)
+        {
+            *p++ = '\\';
+        }
+
+        if (*arg && p < end)
+        {
+            *p++ = *arg++;
+        }
+    }
+
+    *p++ = '"';
+    *p = '\0';
+}
+
+// -----------------------------------------------------------------------------
+// StartWorker
+// -----------------------------------------------------------------------------
+
+static boolean StartWorker (batchdemo_t *demo)
+{
+    const char **argv = WorkerArgs(demo);
+    wchar_t exe_path[MAX_PATH];
+    wchar_t *wcmdline, *wlogfile;
+    SECURITY_ATTRIBUTES security;
+    STARTUPINFOW startup_info;
+    PROCESS_INFORMATION proc_info;
+    HANDLE log;
+    char *cmdline;
+    size_t len = 1;
+    boolean result;
+    int i;
+
+    for (i = 0 ; argv[i] ; i++)
+    {
+        len += 2 * strlen(argv[i]) + 3;
+    }
+
+    cmdline = calloc(len + 4, 1);
+
+    for (i = 0 ; argv[i] ; i++)
+    {
+        QuoteArg(cmdline, len + 4, argv[i]);
+    }
+
+    free(argv);
+
+    // Output of the worker goes to its log file.
+    memset(&security, 0, sizeof(security));
+    security.nLength = sizeof(security);
+    security.bInheritHandle = TRUE;
+
+    wlogfile = M_ConvertUtf8ToWide(demo->logfile);
+    log = CreateFileW(wlogfile, GENERIC_WRITE, FILE_SHARE_READ, &security,
+                      CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    free(wlogfile);
+
+    memset(&proc_info, 0, sizeof(proc_info));
+    memset(&startup_info, 0, sizeof(startup_info));
+    startup_info.cb = sizeof(startup_info);
+
+    if (log != INVALID_HANDLE_VALUE)
+    {
+        startup_info.dwFlags = STARTF_USESTDHANDLES;
+        startup_info.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+        startup_info.hStdOutput = log;
+        startup_info.hStdError = log;
+    }
+
+    GetModuleFileNameW(NULL, exe_path, MAX_PATH);
+    wcmdline = M_ConvertUtf8ToWide(cmdline);
+    free(cmdline);
+
+    result = CreateProcessW(exe_path, wcmdline, NULL, NULL, TRUE,
+                            CREATE_NO_WINDOW, NULL, NULL,
+                            &startup_info, &proc_info);
+
+    free(wcmdline);
+
+    if (log != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(log);
+    }
+
+    if (!result)
+    {
+        return false;
+    }
+
+    CloseHandle(proc_info.hThread);
+    demo->process = proc_info.hProcess;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// WaitWorker
+// Waits for any of the running workers to quit.
+// -----------------------------------------------------------------------------
+
+static batchdemo_t *WaitWorker (void)
+{
+    HANDLE handles[MAXIMUM_WAIT_OBJECTS];
+    batchdemo_t *running[MAXIMUM_WAIT_OBJECTS];
+    batchdemo_t *demo;
+    DWORD result, exitcode;
+    int i, n = 0;
+
+    for (i = 0 ; i < batch_numdemos && n < MAXIMUM_WAIT_OBJECTS ; i++)
+    {
+        if (batch_demos[i].status == batch_running)
+        {
+            handles[n] = batch_demos[i].process;
+            running[n++] = &batch_demos[i];
+        }
+    }
+
+    result = WaitForMultipleObjects(n, handles, FALSE, INFINITE);
+
+    if (result >= WAIT_OBJECT_0 + n)
+    {
+        I_Error("G_DemoBatch: Failed to wait for workers");
+    }
+
+    demo = running[result - WAIT_OBJECT_0];
+
+    GetExitCodeProcess(demo->process, &exitcode);
+    CloseHandle(demo->process);
+    demo->exitcode = (int) exitcode;
+
+    return demo;
+}
+
+#else
+
+// -----------------------------------------------------------------------------
+// StartWorker
+// -----------------------------------------------------------------------------
+
+static boolean StartWorker (batchdemo_t *demo)
+{
+    const char **argv = WorkerArgs(demo);
+
+    demo->pid = fork();
+
+    if (demo->pid == 0)
+    {
+        // This is the worker: its output goes to its log file.
+        const int log = open(demo->logfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (log >= 0)
+        {
+            dup2(log, STDOUT_FILENO);
+            dup2(log, STDERR_FILENO);
+            close(log);
+        }
+
+        execvp(argv[0], (char **) argv);
+
+        _exit(0x80);
+    }
+
+    free(argv);
+
+    return demo->pid > 0;
+}
+
+// -----------------------------------------------------------------------------
+// WaitWorker
+// Waits for any of the running workers to quit.
+// -----------------------------------------------------------------------------
+
+static batchdemo_t *WaitWorker (void)
+{
+    int   status, i;
+    pid_t pid;
+
+    while ((pid = waitpid(-1, &status, 0)) > 0)
+    {
+        for (i = 0 ; i < batch_numdemos ; i++)
+        {
+            batchdemo_t *const demo = &batch_demos[i];
+
+            if (demo->status == batch_running && demo->pid == pid)
+            {
+                demo->exitcode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+                return demo;
+            }
+        }
+    }
+
+    I_Error("G_DemoBatch: Failed to wait for workers");
+    return NULL;
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+// ReadResult
+// Reads result file written by G_WriteDemoBatchResult.
+// -----------------------------------------------------------------------------
+
+static void ReadResult (batchdemo_t *demo)
+{
+    FILE *f = M_fopen(demo->resultfile, "r");
+    int n = 0;
+
+    if (f)
+    {
+        n = fscanf(f, "%d %d %15s %15s %d %" SCNx64 " %127s",
+                   &demo->tics, &demo->realtics, demo->ended, demo->map,
+                   &demo->desynctic, &demo->hash, demo->players);
+        fclose(f);
+        M_remove(demo->resultfile);
+    }
+
+    if (demo->exitcode != 0 || n != 7)
+    {
+        demo->status = batch_failed;
+    }
+    else if (demo->desynctic >= 0)
+    {
+        demo->status = batch_desync;
+    }
+    else if (demo->checkhash)
+    {
+        demo->status = demo->hash == demo->expected ? batch_ok : batch_desync;
+    }
+    else
+    {
+        demo->status = batch_done;
+    }
+
+    // Keep the log of failed workers only.
+    if (demo->status != batch_failed)
+    {
+        M_remove(demo->logfile);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// WriteReport
+// -----------------------------------------------------------------------------
+
+static void WriteReport (FILE *f, int walltime, int jobs)
+{
+    int  count[arrlen(batch_status_names)] = {0};
+    char desync[16];
+    int  i;
+
+    fprintf(f, "# %d demos, %d jobs, %d ms\n", batch_numdemos, jobs, walltime);
+    fprintf(f, "# demo hash status tics wall_ms demo_ms ended map desync_tic players\n");
+
+    for (i = 0 ; i < batch_numdemos ; i++)
+    {
+        const batchdemo_t *const demo = &batch_demos[i];
+
+        count[demo->status]++;
+
+        if (demo->status == batch_failed)
+        {
+            fprintf(f, "%s - %s - %d - - - - - # exit code %d, log %s\n",
+                    demo->name, batch_status_names[demo->status],
+                    demo->walltime, demo->exitcode, demo->logfile);
+            continue;
+        }
+
+        if (demo->desynctic >= 0)
+        {
+            M_snprintf(desync, sizeof(desync), "%d", demo->desynctic);
+        }
+        else
+        {
+            M_StringCopy(desync, "-", sizeof(desync));
+        }
+
+        fprintf(f, "%s %016" PRIx64 " %s %d %d %d %s %s %s %s",
+                demo->name, demo->hash, batch_status_names[demo->status],
+                demo->tics, demo->walltime, demo->realtics * 1000 / TICRATE,
+                demo->ended, demo->map, desync, demo->players);
+
+        if (demo->status == batch_desync && demo->checkhash
+        &&  demo->hash != demo->expected)
+        {
+            fprintf(f, " # expected %016" PRIx64, demo->expected);
+        }
+
+        fprintf(f, "\n");
+    }
+
+    fprintf(f, "# ok %d, done %d, desync %d, failed %d\n",
+            count[batch_ok], count[batch_done],
+            count[batch_desync], count[batch_failed]);
+}
+
+// -----------------------------------------------------------------------------
+// G_DemoBatch
+// Runs -demobatch and quits, if given.
+// -----------------------------------------------------------------------------
+
+void G_DemoBatch (void)
+{
+    uint64_t starttime;
+    char     name[32];
+    FILE    *report;
+    int      jobs, running, next, walltime, i, p;
+    boolean  success;
+
+    //!
+    // @arg <listfile>
+    // @category demo
+    //
+    // Play back every demo of the list file in headless worker processes,
+    // one per CPU core, and report demo tics, time, final game state and
+    // state hash of every demo. A line of the list file is a demo file or
+    // lump name, optionally followed by its expected state hash. Demos
+    // which end with another hash are reported as out of sync, as well as
+    // demos recorded with -demohash which go out of sync.
+    //
+
+    p = M_CheckParmWithArgs("-demobatch", 1);
+
+    if (!p)
+    {
+        return;
+    }
+
+    ReadDemoList(myargv[p + 1]);
+
+    if (!batch_numdemos)
+    {
+        I_Error("G_DemoBatch: No demos in %s", myargv[p + 1]);
+    }
+
+    //!
+    // @arg <n>
+    // @category demo
+    //
+    // Number of -demobatch worker processes, number of CPU cores by default.
+    //
+
+    p = M_CheckParmWithArgs("-jobs", 1);
+    jobs = p ? atoi(myargv[p + 1]) : SDL_GetCPUCount();
+    jobs = BETWEEN(1, batch_numdemos, jobs);
+#ifdef _WIN32
+    jobs = MIN(jobs, MAXIMUM_WAIT_OBJECTS);
+#endif
+
+    I_InitTimer();
+
+    for (i = 0 ; i < batch_numdemos ; i++)
+    {
+        M_snprintf(name, sizeof(name), "demobatch%d_%d.txt", (int) getpid(), i);
+        batch_demos[i].resultfile = M_TempFile(name);
+        M_snprintf(name, sizeof(name), "demobatch%d_%d.log", (int) getpid(), i);
+        batch_demos[i].logfile = M_TempFile(name);
+    }
+
+    printf("G_DemoBatch: %d demos, %d jobs.\n", batch_numdemos, jobs);
+
+    starttime = I_GetTimeUS();
+    running = next = 0;
+
+    while (next < batch_numdemos || running > 0)
+    {
+        batchdemo_t *demo;
+
+        while (running < jobs && next < batch_numdemos)
+        {
+            demo = &batch_demos[next++];
+            demo->starttime = I_GetTimeUS();
+
+            if (StartWorker(demo))
+            {
+                demo->status = batch_running;
+                running++;
+            }
+            else
+            {
+                demo->status = batch_failed;
+                demo->exitcode = -1;
+            }
+        }
+
+        if (running > 0)
+        {
+            demo = WaitWorker();
+            running--;
+
+            demo->walltime = (int) ((I_GetTimeUS() - demo->starttime) / 1000);
+            ReadResult(demo);
+
+            printf("  %s: %s\n", demo->name, batch_status_names[demo->status]);
+        }
+    }
+
+    walltime = (int) ((I_GetTimeUS() - starttime) / 1000);
+
+    WriteReport(stdout, walltime, jobs);
+
+    //!
+    // @arg <file>
+    // @category demo
+    //
+    // Write the -demobatch report to the given file. It can be used as
+    // the list file of another -demobatch run to check for desyncs.
+    //
+
+    p = M_CheckParmWithArgs("-demobatch_report", 1);
+
+    if (p)
+    {
+        report = M_fopen(myargv[p + 1], "w");
+
+        if (!report)
+        {
+            I_Error("G_DemoBatch: Failed to open %s", myargv[p + 1]);
+        }
+
+        WriteReport(report, walltime, jobs);
+        fclose(report);
+    }
+
+    success = true;
+
+    for (i = 0 ; i < batch_numdemos ; i++)
+    {
+        if (batch_demos[i].status == batch_desync
+        ||  batch_demos[i].status == batch_failed)
+        {
+            success = false;
+        }
+    }
+
+    exit(success ? 0 : 1);
+}
+
+// -----------------------------------------------------------------------------
+// G_WriteDemoBatchResult
+// Called by a -demobatch worker when its demo ends, writes the result
+// for G_DemoBatch. Returns false if this is not a worker.
+// -----------------------------------------------------------------------------
+
+boolean G_WriteDemoBatchResult (int realtics)
+{
+    char  playerlist[128] = "";
+    char  player[32];
+    char  map[16];
+    FILE *f;
+    int   i, p;
+
+    //!
+    // @arg <file>
+    // @category obscure
+    //
+    // Used by -demobatch workers: write the demo result to the given
+    // file, and do not save configuration at exit.
+    //
+
+    p = M_CheckParmWithArgs("-demobatch_result", 1);
+
+    if (!p)
+    {
+        return false;
+    }
+
+    // Final position and health of every player.
+    for (i = 0 ; i < MAXPLAYERS ; i++)
+    {
+        const mobj_t *const mo = players[i].mo;
+
+        if (!playeringame[i] || !mo)
+        {
+            continue;
+        }
+
+        M_snprintf(player, sizeof(player), "%s%d:%d/%d/%d/%d",
+                   playerlist[0] ? "," : "", i + 1, mo->x >> FRACBITS,
+                   mo->y >> FRACBITS, mo->z >> FRACBITS, players[i].health);
+        M_StringConcat(playerlist, player, sizeof(playerlist));
+    }
+
+    f = M_fopen(myargv[p + 1], "w");
+
+    if (!f)
+    {
+        I_Error("G_WriteDemoBatchResult: Failed to open %s", myargv[p + 1]);
+    }
+
+    if (gamemode == commercial)
+    {
+        M_snprintf(map, sizeof(map), "MAP%02d", gamemap);
+    }
+    else
+    {
+        M_snprintf(map, sizeof(map), "E%dM%d", gameepisode, gamemap);
+    }
+
+    fprintf(f, "%d %d %s %s %d %016" PRIx64 " %s\n",
+            defdemotics, realtics,
+            gamestate < arrlen(batch_gamestate_names) ?
+                batch_gamestate_names[gamestate] : "other",
+            map, demo_desynctic, P_StateHash(),
+            playerlist[0] ? playerlist : "-");
+    fclose(f);
+
+    return true;
+}
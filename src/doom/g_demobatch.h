@@ -0,0 +1,28 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Batch demo runner.
+//
+
+
+#pragma once
+
+#include "doomtype.h"
+
+
+// Runs -demobatch and quits, if given.
+extern void G_DemoBatch (void);
+
+// Writes the result of a -demobatch worker, false if this is not a worker.
+extern boolean G_WriteDemoBatchResult (int realtics);
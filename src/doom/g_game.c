@@ -38,6 +38,7 @@
 #include "m_misc.h"
 #include "m_menu.h"
 #include "m_random.h"
+#include "i_asyncio.h"
 #include "i_joystick.h"
 #include "i_system.h"
 #include "i_timer.h"
@@ -69,6 +70,8 @@
 // SKY handling - still the wrong place.
 
 #include "g_game.h"
+#include "g_demobatch.h"
+#include "g_keyframe.h"
 
 #include "id_vars.h"
 #include "id_func.h"
@@ -231,8 +234,6 @@ static char     savedescription[32];
  
 static ticcmd_t basecmd; // [crispy]
 
-#define	BODYQUESIZE	32
-
 mobj_t*		bodyque[BODYQUESIZE]; 
 int		bodyqueslot; 
  
@@ -1086,6 +1087,21 @@ boolean G_Responder (event_t* ev)
         singletics = !singletics;
         return true;
     }
+
+    // [JN] Demo rewind and seek.
+    if (ev->type == ev_keydown && demoplayback && ev->data1 != 0)
+    {
+        if (ev->data1 == key_demo_rewind)
+        {
+            G_DemoSeekBy(-KEYFRAME_SEEKSTEP);
+            return true;
+        }
+        if (ev->data1 == key_demo_forward)
+        {
+            G_DemoSeekBy(KEYFRAME_SEEKSTEP);
+            return true;
+        }
+    }
  
     // allow spy mode changes even during the demo
     if (gamestate == GS_LEVEL && ev->type == ev_keydown 
@@ -1389,7 +1405,123 @@ static void G_ReadGameParms (void)
     fastparm = M_CheckParm ("-fast");
     nomonsters = M_CheckParm ("-nomonsters");
 }
- 
+
+// -----------------------------------------------------------------------------
+// [JN] Game state hashes of demos.
+// With -demohash, the game state hash of every tic is stored in the footer
+// of the recorded demo. Playback compares them with its own hashes and
+// reports the first tic which went out of sync.
+// -----------------------------------------------------------------------------
+
+#define DEMO_HASH_LUMP "STATEHSH"
+
+static boolean      demohash_record;
+static uint32_t    *demohashes;      // Hashes of the demo being recorded
+static int          numdemohashes;
+static int          maxdemohashes;
+static const byte  *demohashlump;    // Hashes of the demo being played back
+static int          demohashcount;
+int                 demo_desynctic = -1;
+
+static inline uint32_t G_FoldHash (uint64_t hash)
+{
+    return (uint32_t) (hash ^ (hash >> 32));
+}
+
+// -----------------------------------------------------------------------------
+// G_StateHashTicker
+// Hashes the game state at the end of a tic, and stores or checks
+// the hash if the demo is recorded or played back.
+// -----------------------------------------------------------------------------
+
+static void G_StateHashTicker (void)
+{
+    const int tic = defdemotics - 1;
+    uint32_t hash;
+
+    if (!statehash_active)
+    {
+        return;
+    }
+
+    hash = G_FoldHash(P_TicStateHash());
+
+    if (demorecording && !demoplayback && demohash_record && tic == numdemohashes)
+    {
+        if (numdemohashes == maxdemohashes)
+        {
+            maxdemohashes = maxdemohashes ? maxdemohashes * 2 : 4096;
+            demohashes = I_Realloc(demohashes, maxdemohashes * sizeof(*demohashes));
+        }
+
+        demohashes[numdemohashes++] = hash;
+    }
+
+    if (demoplayback && demohashlump && tic >= 0 && tic < demohashcount
+    &&  demo_desynctic < 0)
+    {
+        const byte *const p = demohashlump + tic * 4;
+        const uint32_t expected = p[0] | (p[1] << 8) | (p[2] << 16)
+                                | ((uint32_t) p[3] << 24);
+
+        if (hash != expected)
+        {
+            demo_desynctic = tic;
+
+            printf("G_StateHashTicker: Demo went out of sync at tic %d (%d:%02d)\n",
+                   tic, tic / TICRATE / 60, tic / TICRATE % 60);
+            CT_SetMessage(&players[consoleplayer], "DEMO OUT OF SYNC", false, NULL);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// G_ReadDemoHashes
+// Finds the state hash lump in the footer of the played back demo.
+// -----------------------------------------------------------------------------
+
+static void G_ReadDemoHashes (const byte *footer, int length)
+{
+    wadinfo_t  header;
+    filelump_t lump;
+    int        numlumps, infotableofs, i;
+
+    demohashlump = NULL;
+    demohashcount = 0;
+    demo_desynctic = -1;
+
+    if (length >= (int) sizeof(header))
+    {
+        memcpy(&header, footer, sizeof(header));
+        numlumps = LONG(header.numlumps);
+        infotableofs = LONG(header.infotableofs);
+
+        if (!strncmp(header.identification, "PWAD", 4)
+        &&  infotableofs >= 0 && infotableofs <= length && numlumps >= 0
+        &&  numlumps <= (length - infotableofs) / (int) sizeof(lump))
+        {
+            for (i = 0 ; i < numlumps ; i++)
+            {
+                int filepos, size;
+
+                memcpy(&lump, footer + infotableofs + i * sizeof(lump), sizeof(lump));
+                filepos = LONG(lump.filepos);
+                size = LONG(lump.size);
+
+                if (!strncmp(lump.name, DEMO_HASH_LUMP, 8)
+                &&  filepos >= 0 && filepos <= length
+                &&  size >= 0 && size <= length - filepos)
+                {
+                    demohashlump = footer + filepos;
+                    demohashcount = size / 4;
+                }
+            }
+        }
+    }
+
+    P_EnableStateHash(demohashlump != NULL);
+}
+
 //
 // G_Ticker
 // Make ticcmd_ts for the players.
@@ -1399,6 +1531,10 @@ void G_Ticker (void)
     int		i;
     int		buf; 
     ticcmd_t*	cmd;
+    boolean	ticked = false;  // [JN] Commands were read
+
+    // [JN] Report savegames written in the background.
+    I_PollFileWrites();
     
     // do player reborns if needed
     for (i=0 ; i<MAXPLAYERS ; i++) 
@@ -1453,6 +1589,9 @@ void G_Ticker (void)
 	    break; 
 	} 
     }
+
+    // [JN] Seek within the demo, take demo keyframes.
+    G_KeyframeTicker();
     
     // [crispy] demo sync of revenant tracers and RNG (from prboom-plus)
     if (paused & 2 || (!demoplayback && menuactive && !netgame))
@@ -1461,6 +1600,8 @@ void G_Ticker (void)
     }
     else
     {     
+    ticked = true;
+
     // get commands, check consistancy,
     // and build new consistancy check
     buf = (gametic/ticdup)%BACKUPTICS; 
@@ -1623,6 +1764,12 @@ void G_Ticker (void)
 	break;
     }        
 
+    // [JN] Game state hash of the tic.
+    if (ticked)
+    {
+        G_StateHashTicker();
+    }
+
     // [JN] Reduce message tics independently from framerate and game states.
     // Tics can't go negative.
     MSG_Ticker();
@@ -1706,6 +1853,7 @@ void G_PlayerFinishLevel (int player)
     p->messageCenteredTics = 0;
     p->targetsheathTics = 0;
     p->mo->flags &= ~MF_SHADOW;		// cancel invisibility 
+    P_DirtyMobj (p->mo);		// [JN] Game state hash.
     p->extralight = 0;			// cancel gun flashes 
     p->fixedcolormap = 0;		// cancel ir gogles 
     p->damagecount = 0;			// no palette changes 
@@ -2447,19 +2595,17 @@ void G_DoLoadGame (void)
 	deathmatch = false;
     }
     gameaction = ga_nothing; 
-	 
-    save_stream = M_fopen(savename, "rb");
 
-    if (save_stream == NULL)
+    // [JN] The savegame may still be on its way to the disk.
+    I_WaitFileWrites();
+	 
+    if (!P_OpenSaveGameRead(savename))
     {
         return;
     }
 
-    savegame_error = false;
-
     if (!P_ReadSaveGameHeader())
     {
-        fclose(save_stream);
         return;
     }
 
@@ -2487,9 +2633,9 @@ void G_DoLoadGame (void)
     P_UnArchiveAutomap ();
     // [plums] Restore old sector specials.
     P_UnArchiveOldSpecials ();
+    // [JN] Hash the loaded level for the game state hash.
+    P_ResetStateHash ();
 
-    fclose(save_stream);
-    
     if (setsizeneeded)
 	R_ExecuteSetViewSize ();
     
@@ -2525,36 +2671,49 @@ G_SaveGame
     sendsave = true;
 }
 
-void G_DoSaveGame (void) 
-{ 
-    char *savegame_file;
-    char *temp_savegame_file;
-    char *recovery_savegame_file;
-
-    recovery_savegame_file = NULL;
-    temp_savegame_file = P_TempSaveGameFile();
-    savegame_file = P_SaveGameFile(savegameslot);
-
-    // Open the savegame file for writing.  We write to a temporary file
-    // and then rename it at the end if it was successfully written.
-    // This prevents an existing savegame from being overwritten by
-    // a corrupted one, or if a savegame buffer overrun occurs.
-    save_stream = M_fopen(temp_savegame_file, "wb");
-
-    if (save_stream == NULL)
+//
+// G_SaveGameWritten
+// [JN] Called once the savegame has been written on the I/O thread,
+// the game is only reported as saved when its data is on disk.
+//
+static void G_SaveGameWritten (const char *savegame_file, boolean success,
+                               const byte *data, size_t length)
+{
+    if (!success)
     {
+        char *recovery_savegame_file;
+
         // Failed to save the game, so we're going to have to abort. But
         // to be nice, save to somewhere else before we call I_Error().
         recovery_savegame_file = M_TempFile("recovery.sav");
-        save_stream = M_fopen(recovery_savegame_file, "wb");
-        if (save_stream == NULL)
+        if (!M_WriteFile(recovery_savegame_file, data, (int) length))
         {
             I_Error("Failed to open either '%s' or '%s' to write savegame.",
-                    temp_savegame_file, recovery_savegame_file);
+                    P_TempSaveGameFile(), recovery_savegame_file);
         }
+
+        // We failed to save to the normal location, but we wrote a
+        // recovery file to the temp directory. Now we can bomb out
+        // with an error.
+        I_Error("Failed to open savegame file '%s' for writing.\n"
+                "But your game has been saved to '%s' for recovery.",
+                P_TempSaveGameFile(), recovery_savegame_file);
     }
 
-    savegame_error = false;
+    CT_SetMessage(&players[consoleplayer], DEH_String(GGSAVED), false, NULL);
+}
+
+void G_DoSaveGame (void) 
+{ 
+    byte *data;
+    size_t length;
+
+    // The savegame is serialized into memory first, and then written
+    // to a temporary file on the I/O thread, which is renamed at the end
+    // if it was successfully written. This prevents an existing savegame
+    // from being overwritten by a corrupted one, or if a savegame buffer
+    // overrun occurs.
+    P_OpenSaveGameWrite();
 
     P_WriteSaveGameHeader(savedescription);
 
@@ -2575,31 +2734,15 @@ void G_DoSaveGame (void)
     // to keep save compatibility with previous versions
     P_ArchiveOldSpecials ();
 
-    // Finish up, close the savegame file.
+    // Finish up, hand the savegame over to the I/O thread.
 
-    fclose(save_stream);
-
-    if (recovery_savegame_file != NULL)
-    {
-        // We failed to save to the normal location, but we wrote a
-        // recovery file to the temp directory. Now we can bomb out
-        // with an error.
-        I_Error("Failed to open savegame file '%s' for writing.\n"
-                "But your game has been saved to '%s' for recovery.",
-                temp_savegame_file, recovery_savegame_file);
-    }
-
-    // Now rename the temporary savegame file to the actual savegame
-    // file, overwriting the old savegame if there was one there.
-
-    M_remove(savegame_file);
-    M_rename(temp_savegame_file, savegame_file);
+    data = P_TakeSaveGameBuffer(&length);
+    I_WriteFileAsync(P_SaveGameFile(savegameslot), P_TempSaveGameFile(),
+                     data, length, G_SaveGameWritten);
 
     gameaction = ga_nothing;
     M_StringCopy(savedescription, "", sizeof(savedescription));
-    M_StringCopy(savename, savegame_file, sizeof(savename));
-
-    CT_SetMessage(&players[consoleplayer], DEH_String(GGSAVED), false, NULL);
+    M_StringCopy(savename, P_SaveGameFile(savegameslot), sizeof(savename));
 
     // draw the pattern into the back screen
     R_FillBackScreen ();
@@ -2725,6 +2868,7 @@ void G_DoSelectiveGame (int choice)
     // Health
     plr->health = level_select[3];
     plr->mo->health = level_select[3];
+    P_DirtyMobj(plr->mo);  // [JN] Game state hash.
 
     // Armor
     plr->armorpoints = level_select[4];
@@ -3006,7 +3150,12 @@ void G_ReadDemoTiccmd (ticcmd_t* cmd)
 
 	// [crispy] discard the newly allocated demo buffer
 	Z_Free(demobuffer);
-	demobuffer = actualbuffer;
+
+	// [JN] Continue recording into a copy of the played part of the
+	// demo lump, as it may be in a read-only memory-mapped WAD file.
+	demobuffer = Z_Malloc(demo_p - actualbuffer, PU_STATIC, 0);
+	memcpy(demobuffer, actualbuffer, demo_p - actualbuffer);
+	demo_p = demobuffer + (demo_p - actualbuffer);
 
 	last_cmd = cmd; // [crispy] remember last cmd to track joins
 
@@ -3192,6 +3341,17 @@ void G_BeginRecording (void)
 
     demo_p = demobuffer;
 
+    //!
+    // @category demo
+    //
+    // Store game state hash of every tic in the footer of the recorded
+    // demo. Its playback then reports the first tic which went out of sync.
+    //
+
+    demohash_record = M_ParmExists("-demohash");
+    numdemohashes = 0;
+    P_EnableStateHash(demohash_record);
+
     //!
     // @category demo
     //
@@ -3305,6 +3465,9 @@ void G_DoPlayDemo (void)
         Z_Free(demobuffer);
     }
 
+    // [JN] Keyframes of the previous demo.
+    G_ClearKeyframes();
+
     lumpnum = W_GetNumForName(defdemoname);
     gameaction = ga_nothing;
     demobuffer = W_CacheLumpNum(lumpnum, PU_STATIC);
@@ -3435,9 +3598,32 @@ void G_DoPlayDemo (void)
 	    demo_ptr += numplayersingame * (longtics ? 5 : 4);
 	    deftotaldemotics++;
 	}
+
+	// [JN] Game state hashes from the demo footer.
+	if ((demo_ptr - demobuffer) < lumplength)
+	{
+	    demo_ptr++;
+	}
+	G_ReadDemoHashes(demo_ptr, lumplength - (int) (demo_ptr - demobuffer));
     }
 } 
 
+// [JN] -timedemo frame time statistics.
+
+typedef struct
+{
+    int frametime;  // Whole frame, microseconds
+    int tictime;    // Game tics within the frame, microseconds
+    int gametic;
+    int episode;
+    int map;
+} timedemo_frame_t;
+
+static timedemo_frame_t *timedemo_frames;
+static int timedemo_numframes;
+static int timedemo_maxframes;
+static int timedemo_warmup;
+
 //
 // G_TimeDemo 
 //
@@ -3457,7 +3643,267 @@ void G_TimeDemo (char* name)
 
     defdemoname = name; 
     gameaction = ga_playdemo; 
-} 
+
+    //!
+    // @arg <n>
+    // @category video
+    //
+    // Don't count first n gametics of -timedemo in frame time statistics.
+    //
+
+    timedemo_warmup = 0;
+    {
+        const int p = M_CheckParmWithArgs("-timedemo_warmup", 1);
+
+        if (p)
+        {
+            timedemo_warmup = MAX(0, atoi(myargv[p + 1]));
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// G_TimeDemoFrame
+// [JN] Stores a frame of the main loop with its time, time of its game
+// tics, and gametic/map at its end. Reported by G_CheckDemoStatus.
+// -----------------------------------------------------------------------------
+
+#define TIMEDEMO_WORST    10  // Worst frames printed to stdout
+#define TIMEDEMO_BUCKETS  8   // Histogram buckets: < 1, 2, 4 ... 64 ms, and more
+
+void G_TimeDemoFrame (uint64_t framestart, uint64_t ticend)
+{
+    timedemo_frame_t *frame;
+
+    if (!timingdemo || gametic - demostarttic < timedemo_warmup)
+    {
+        return;
+    }
+
+    if (timedemo_numframes == timedemo_maxframes)
+    {
+        timedemo_maxframes = timedemo_maxframes ? timedemo_maxframes * 2 : 4096;
+        timedemo_frames = I_Realloc(timedemo_frames,
+                                    timedemo_maxframes * sizeof(*timedemo_frames));
+    }
+
+    frame = &timedemo_frames[timedemo_numframes++];
+    frame->frametime = (int) (I_GetTimeUS() - framestart);
+    frame->tictime = (int) (ticend - framestart);
+    frame->gametic = gametic;
+    frame->episode = gameepisode;
+    frame->map = gamemap;
+}
+
+static int CompareInts (const void *a, const void *b)
+{
+    const int x = *(const int *) a;
+    const int y = *(const int *) b;
+
+    return (x > y) - (x < y);
+}
+
+// Slowest frame first, equal ones in order of appearance.
+static int CompareFrames (const void *a, const void *b)
+{
+    const timedemo_frame_t *x = a;
+    const timedemo_frame_t *y = b;
+
+    if (x->frametime != y->frametime)
+    {
+        return x->frametime < y->frametime ? 1 : -1;
+    }
+
+    return (x->gametic > y->gametic) - (x->gametic < y->gametic);
+}
+
+typedef struct
+{
+    int p50, p90, p99, max;
+    int histogram[TIMEDEMO_BUCKETS];
+} timedemo_stats_t;
+
+static void G_TimeDemoStats (int *times, timedemo_stats_t *stats)
+{
+    const int n = timedemo_numframes;
+    int i;
+
+    memset(stats, 0, sizeof(*stats));
+
+    if (!n)
+    {
+        return;
+    }
+
+    qsort(times, n, sizeof(*times), CompareInts);
+
+    // Nearest-rank percentiles.
+    stats->p50 = times[(n * 50 + 99) / 100 - 1];
+    stats->p90 = times[(n * 90 + 99) / 100 - 1];
+    stats->p99 = times[(n * 99 + 99) / 100 - 1];
+    stats->max = times[n - 1];
+
+    for (i = 0; i < n; i++)
+    {
+        int bucket = 0;
+
+        while (bucket < TIMEDEMO_BUCKETS - 1 && times[i] >= (1000 << bucket))
+        {
+            bucket++;
+        }
+
+        stats->histogram[bucket]++;
+    }
+}
+
+static void G_TimeDemoMapName (const timedemo_frame_t *frame, char *buf, size_t len)
+{
+    if (gamemode == commercial)
+    {
+        M_snprintf(buf, len, "MAP%02d", frame->map);
+    }
+    else
+    {
+        M_snprintf(buf, len, "E%dM%d", frame->episode, frame->map);
+    }
+}
+
+// Writes a JSON string, escaping quotes, backslashes and control characters.
+static void G_TimeDemoWriteString (FILE *f, const char *str)
+{
+    fputc('"', f);
+
+    for ( ; *str ; str++)
+    {
+        const unsigned char c = *str;
+
+        if (c == '"' || c == '\\')
+        {
+            fprintf(f, "\\%c", c);
+        }
+        else if (c < 0x20)
+        {
+            fprintf(f, "\\u%04x", c);
+        }
+        else
+        {
+            fputc(c, f);
+        }
+    }
+
+    fputc('"', f);
+}
+
+static void G_TimeDemoWriteStats (FILE *f, const char *name,
+                                  const timedemo_stats_t *stats)
+{
+    int i;
+
+    fprintf(f, "  \"%s\": {\"p50\": %d, \"p90\": %d, \"p99\": %d, \"max\": %d,"
+               " \"histogram\": [", name, stats->p50, stats->p90, stats->p99, stats->max);
+
+    for (i = 0; i < TIMEDEMO_BUCKETS; i++)
+    {
+        fprintf(f, "%s%d", i ? ", " : "", stats->histogram[i]);
+    }
+
+    fprintf(f, "]},\n");
+}
+
+// -----------------------------------------------------------------------------
+// G_TimeDemoReport
+// Prints frame time statistics and writes them to -timedemo_report file,
+// frame times are in microseconds. Returns false if there is no report
+// file, so G_CheckDemoStatus should show the result as usual.
+// -----------------------------------------------------------------------------
+
+static boolean G_TimeDemoReport (int realtics, float fps, timedemo_stats_t *framestats)
+{
+    const int n = timedemo_numframes;
+    const int numworst = MAX(1, n / 100);
+    timedemo_stats_t ticstats;
+    int *times;
+    int  i, p;
+    char map[16];
+    FILE *f;
+
+    times = I_Realloc(NULL, MAX(1, n) * sizeof(*times));
+
+    for (i = 0; i < n; i++)
+        times[i] = timedemo_frames[i].frametime;
+    G_TimeDemoStats(times, framestats);
+
+    for (i = 0; i < n; i++)
+        times[i] = timedemo_frames[i].tictime;
+    G_TimeDemoStats(times, &ticstats);
+
+    free(times);
+
+    // Worst 1% of frames go first.
+    qsort(timedemo_frames, n, sizeof(*timedemo_frames), CompareFrames);
+
+    printf("Timedemo: %d frames, %d warmup tics skipped\n", n, timedemo_warmup);
+    printf("  frame us: p50 %d, p90 %d, p99 %d, max %d\n",
+           framestats->p50, framestats->p90, framestats->p99, framestats->max);
+    printf("  tic us:   p50 %d, p90 %d, p99 %d, max %d\n",
+           ticstats.p50, ticstats.p90, ticstats.p99, ticstats.max);
+
+    for (i = 0; i < n && i < MIN(numworst, TIMEDEMO_WORST); i++)
+    {
+        G_TimeDemoMapName(&timedemo_frames[i], map, sizeof(map));
+        printf("  worst: %d us at gametic %d, %s\n",
+               timedemo_frames[i].frametime, timedemo_frames[i].gametic, map);
+    }
+
+    //!
+    // @arg <file>
+    // @category video
+    //
+    // Write -timedemo results to the given file as JSON and quit
+    // normally instead of showing them as an error message.
+    //
+
+    p = M_CheckParmWithArgs("-timedemo_report", 1);
+
+    if (!p)
+    {
+        return false;
+    }
+
+    f = M_fopen(myargv[p + 1], "w");
+
+    if (!f)
+    {
+        I_Error("G_TimeDemoReport: Failed to open %s", myargv[p + 1]);
+    }
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"demo\": ");
+    G_TimeDemoWriteString(f, defdemoname);
+    fprintf(f, ",\n");
+    fprintf(f, "  \"gametics\": %d,\n", gametic);
+    fprintf(f, "  \"realtics\": %d,\n", realtics);
+    fprintf(f, "  \"fps\": %f,\n", fps);
+    fprintf(f, "  \"warmup\": %d,\n", timedemo_warmup);
+    fprintf(f, "  \"frames\": %d,\n", n);
+    fprintf(f, "  \"histogram_ms\": [1, 2, 4, 8, 16, 32, 64, null],\n");
+    G_TimeDemoWriteStats(f, "frame_us", framestats);
+    G_TimeDemoWriteStats(f, "tic_us", &ticstats);
+    fprintf(f, "  \"worst\": [\n");
+
+    for (i = 0; i < n && i < numworst; i++)
+    {
+        G_TimeDemoMapName(&timedemo_frames[i], map, sizeof(map));
+        fprintf(f, "    {\"frame_us\": %d, \"tic_us\": %d, \"gametic\": %d, \"map\": \"%s\"}%s\n",
+                timedemo_frames[i].frametime, timedemo_frames[i].tictime,
+                timedemo_frames[i].gametic, map, i < MIN(n, numworst) - 1 ? "," : "");
+    }
+
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+
+    return true;
+}
  
 #define DEMO_FOOTER_SEPARATOR "\n"
 #define NUM_DEMO_FOOTER_LUMPS 4
@@ -3560,11 +4006,13 @@ static void G_AddDemoFooter(void)
     byte *data;
     size_t size;
     long filepos;
+    int i;
 
     MEMFILE *stream = mem_fopen_write();
 
     wadinfo_t header = { "PWAD" };
-    header.numlumps = LONG(NUM_DEMO_FOOTER_LUMPS);
+    // [JN] Plus game state hashes, if any.
+    header.numlumps = LONG(NUM_DEMO_FOOTER_LUMPS + (numdemohashes > 0));
     mem_fwrite(&header, 1, sizeof(header), stream);
 
     mem_fputs(PACKAGE_FULLNAME, stream);  // [JN] Use full port name.
@@ -3572,6 +4020,16 @@ static void G_AddDemoFooter(void)
     size = WriteCmdLineLump(stream);
     mem_fputs(DEMO_FOOTER_SEPARATOR, stream);
 
+    for (i = 0; i < numdemohashes; i++)
+    {
+        const byte hash[4] = {
+            demohashes[i] & 0xff, (demohashes[i] >> 8) & 0xff,
+            (demohashes[i] >> 16) & 0xff, demohashes[i] >> 24
+        };
+
+        mem_fwrite(hash, 1, sizeof(hash), stream);
+    }
+
     header.infotableofs = LONG(mem_ftell(stream));
     mem_fseek(stream, 0, MEM_SEEK_SET);
     mem_fwrite(&header, 1, sizeof(header), stream);
@@ -3581,7 +4039,11 @@ static void G_AddDemoFooter(void)
     filepos = WriteFileInfo("PORTNAME", strlen(PACKAGE_FULLNAME), filepos, stream);
     filepos = WriteFileInfo(NULL, strlen(DEMO_FOOTER_SEPARATOR), filepos, stream);
     filepos = WriteFileInfo("CMDLINE", size, filepos, stream);
-    WriteFileInfo(NULL, strlen(DEMO_FOOTER_SEPARATOR), filepos, stream);
+    filepos = WriteFileInfo(NULL, strlen(DEMO_FOOTER_SEPARATOR), filepos, stream);
+    if (numdemohashes > 0)
+    {
+        WriteFileInfo(DEMO_HASH_LUMP, numdemohashes * 4, filepos, stream);
+    }
 
     mem_get_buf(stream, (void **)&data, &size);
 
@@ -3617,18 +4079,47 @@ boolean G_CheckDemoStatus (void)
         const int endtime = I_GetTime();
         const int realtics = endtime - starttime;
         const float fps = ((float)gametic * TICRATE) / realtics;
+        timedemo_stats_t stats;
 
         // Prevent recursive calls
         timingdemo = false;
         demoplayback = false;
 
+        printf("Timed %i gametics in %i realtics.\n"
+               "Average fps: %f\n", gametic, realtics, fps);
+
+        // [JN] Quit normally if results are written to the file,
+        // or for the -demobatch runner.
+        if (G_WriteDemoBatchResult(realtics)
+        ||  G_TimeDemoReport(realtics, fps, &stats))
+        {
+            I_Quit();
+        }
+
         i_error_safe = true;
         I_Error ("Timed %i gametics in %i realtics.\n"
-                 "Average fps: %f", gametic, realtics, fps);
+                 "Average fps: %f\n"
+                 "Frame time p50/p90/p99/max: %d/%d/%d/%d us",
+                 gametic, realtics, fps,
+                 stats.p50, stats.p90, stats.p99, stats.max);
     } 
 	 
     if (demoplayback) 
     { 
+        G_ClearKeyframes();
+
+        // [JN] Report game state hash check.
+        if (demohashlump)
+        {
+            if (demo_desynctic < 0)
+            {
+                printf("G_CheckDemoStatus: Demo stayed in sync for %d tics.\n",
+                       MIN(defdemotics, demohashcount));
+            }
+            demohashlump = NULL;
+        }
+        P_EnableStateHash(false);
+
         W_ReleaseLumpName(defdemoname);
 	demoplayback = false; 
 	netdemo = false;
@@ -3684,6 +4175,7 @@ boolean G_CheckDemoStatus (void)
 
 	*demo_p++ = DEMOMARKER; 
 	G_AddDemoFooter();
+	numdemohashes = 0;
 	success = M_WriteFile (demoname, demobuffer, demo_p - demobuffer);
 	msg = success ? "Demo %s recorded%c" : "Failed to record Demo %s%c";
 	Z_Free (demobuffer); 
@@ -32,6 +32,15 @@ void G_PrepTiccmd (void); // [crispy]
 
 extern char *demoname;
 extern int   demostarttic; // [crispy] fix revenant internal demo
+extern byte *demobuffer;
+extern byte *demo_p;
+extern boolean timingdemo;
+extern int   demo_desynctic; // [JN] First tic with a different state hash
+
+#define BODYQUESIZE 32
+
+extern mobj_t *bodyque[BODYQUESIZE];
+extern int     bodyqueslot;
 
 extern fixed_t forwardmove[2];
 extern fixed_t sidemove[2];
@@ -66,6 +75,7 @@ extern void G_ScreenShot (void);
 extern void G_SecretExitLevel (void);
 extern void G_Ticker (void);
 extern void G_TimeDemo (char *name);
+extern void G_TimeDemoFrame (uint64_t framestart, uint64_t ticend);
 extern void G_WorldDone (void);
 extern void G_WriteDemoTiccmd (ticcmd_t *cmd); 
 
@@ -0,0 +1,716 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Demo keyframes: rewind and seek during demo playback.
+//
+//      Every demo_keyframe_interval seconds of playback the game state
+//      is serialized into memory by the savegame archivers. Seeking
+//      restores the nearest keyframe before the target tic and runs the
+//      demo forward from there without drawing.
+//
+//      Savegames do not keep everything the play simulation depends on,
+//      so a keyframe also keeps the random number indexes, the order of
+//      the thinker list, the order of the sector and blockmap thing
+//      lists, exact sector heights and the mobj pointers savegames drop
+//      (sound targets, attackers, the body queue and the brain targets).
+//
+//      Keyframes are kept within demo_keyframe_budget megabytes. When the
+//      budget is exceeded, the keyframe whose neighbours are closest
+//      together is dropped, so the remaining ones stay evenly spread.
+//      The first keyframe is never dropped, so rewinding to the start
+//      always works.
+//
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "doomstat.h"
+#include "d_loop.h"
+#include "g_game.h"
+#include "g_keyframe.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "id_func.h"
+#include "id_vars.h"
+#include "m_fixed.h"
+#include "p_local.h"
+#include "r_local.h"
+#include "s_sound.h"
+
+
+// Classes of thinkers in the thinker list.
+enum
+{
+    kf_mobj,    // archived by P_ArchiveThinkers
+    kf_special, // archived by P_ArchiveSpecials
+    kf_removed  // waiting to be freed, not archived
+};
+
+typedef struct
+{
+    int       tic;          // defdemotics
+    int       demopos;      // demo_p - demobuffer
+    int       skill;
+    int       episode;
+    int       map;
+    int       leveltime;
+    int       totalleveltimes;
+    int       demophase;    // gametic - demostarttic
+    int       prndindex;
+    int       rndindex;
+    int       skytexture;
+    int       totalkills;
+    int       totalitems;
+    int       totalsecret;
+    int       bodyqueslot;
+    int       numbraintargets;
+    int       braintargeton;
+    int       brainspiteasy;
+    int       iquehead;
+    int       iquetail;
+
+    byte     *data;         // P_Archive* output
+    size_t    length;
+
+    byte     *order;        // class of every thinker, in list order
+    int       numthinkers;
+
+    // Thinker list positions (as of P_ThinkerToIndex) of mobjs pointed
+    // to by sector sound targets, player attackers, the body queue and
+    // the brain targets, followed by the sector and blockmap thing lists.
+    int      *links;
+    int       numlinks;
+
+    fixed_t  *heights;      // floor and ceiling height of every sector
+
+    mapthing_t itemrespawnque[ITEMQUESIZE];
+    int        itemrespawntime[ITEMQUESIZE];
+
+    size_t    size;         // memory taken by the keyframe
+} keyframe_t;
+
+static keyframe_t **keyframes;
+static int          numkeyframes;
+static int          maxkeyframes;
+static size_t       keyframe_memory;
+
+static boolean      seek_pending;
+static boolean      seeking;
+static int          seek_target;
+static boolean      seek_nodrawers;
+static boolean      seek_singletics;
+static int          seek_paused;
+
+// Links being written by CaptureKeyframe.
+static int         *newlinks;
+static int          numnewlinks;
+static int          maxnewlinks;
+
+
+// -----------------------------------------------------------------------------
+// KeyframesActive
+// -----------------------------------------------------------------------------
+
+static boolean KeyframesActive (void)
+{
+    return demoplayback && !demorecording && !timingdemo
+        && demo_keyframe_interval > 0;
+}
+
+// -----------------------------------------------------------------------------
+// FreeKeyframe
+// -----------------------------------------------------------------------------
+
+static void FreeKeyframe (int i)
+{
+    keyframe_t *kf = keyframes[i];
+
+    keyframe_memory -= kf->size;
+
+    free(kf->data);
+    free(kf->order);
+    free(kf->links);
+    free(kf->heights);
+    free(kf);
+
+    memmove(&keyframes[i], &keyframes[i + 1],
+            (numkeyframes - i - 1) * sizeof(*keyframes));
+    numkeyframes--;
+}
+
+// -----------------------------------------------------------------------------
+// StopSeek
+// -----------------------------------------------------------------------------
+
+static void StopSeek (void)
+{
+    if (seeking)
+    {
+        nodrawers = seek_nodrawers;
+        singletics = seek_singletics;
+
+        if (seek_paused)
+        {
+            paused |= seek_paused;
+            S_PauseSound();
+        }
+
+        seeking = false;
+    }
+
+    seek_pending = false;
+}
+
+// -----------------------------------------------------------------------------
+// G_ClearKeyframes
+// -----------------------------------------------------------------------------
+
+void G_ClearKeyframes (void)
+{
+    StopSeek();
+
+    while (numkeyframes > 0)
+    {
+        FreeKeyframe(numkeyframes - 1);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// EvictKeyframes
+// Keeps the keyframes within the memory budget.
+// The first keyframe stays even if it alone is over the budget.
+// -----------------------------------------------------------------------------
+
+static void EvictKeyframes (void)
+{
+    const size_t budget = (size_t) MAX(demo_keyframe_budget, 0) * 1024 * 1024;
+
+    while (keyframe_memory > budget && numkeyframes > 1)
+    {
+        int drop = numkeyframes - 1;
+        int i, gap;
+
+        // Drop the keyframe which leaves the smallest hole,
+        // never the first one.
+        for (i = 1, gap = INT_MAX ; i < numkeyframes - 1 ; i++)
+        {
+            const int hole = keyframes[i + 1]->tic - keyframes[i - 1]->tic;
+
+            if (hole < gap)
+            {
+                gap = hole;
+                drop = i;
+            }
+        }
+
+        FreeKeyframe(drop);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// AddLink
+// -----------------------------------------------------------------------------
+
+static void AddLink (int value)
+{
+    if (numnewlinks == maxnewlinks)
+    {
+        maxnewlinks = maxnewlinks ? 2 * maxnewlinks : 4096;
+        newlinks = I_Realloc(newlinks, maxnewlinks * sizeof(*newlinks));
+    }
+
+    newlinks[numnewlinks++] = value;
+}
+
+static void AddMobjLink (const mobj_t *mo)
+{
+    AddLink(P_ThinkerToIndex((const thinker_t *) mo));
+}
+
+// -----------------------------------------------------------------------------
+// CaptureKeyframe
+// -----------------------------------------------------------------------------
+
+static void CaptureKeyframe (void)
+{
+    keyframe_t *kf;
+    thinker_t  *th;
+    mobj_t     *mo;
+    int         i, count, slot;
+
+    kf = I_Realloc(NULL, sizeof(*kf));
+    memset(kf, 0, sizeof(*kf));
+
+    kf->tic = defdemotics;
+    kf->demopos = demo_p - demobuffer;
+    kf->skill = gameskill;
+    kf->episode = gameepisode;
+    kf->map = gamemap;
+    kf->leveltime = leveltime;
+    kf->totalleveltimes = totalleveltimes;
+    kf->demophase = gametic - demostarttic;
+    kf->prndindex = prndindex;
+    kf->rndindex = rndindex;
+    kf->skytexture = skytexture;
+    kf->totalkills = totalkills;
+    kf->totalitems = totalitems;
+    kf->totalsecret = totalsecret;
+    kf->bodyqueslot = bodyqueslot;
+    kf->numbraintargets = numbraintargets;
+    kf->braintargeton = braintargeton;
+    kf->brainspiteasy = brainspiteasy;
+    kf->iquehead = iquehead;
+    kf->iquetail = iquetail;
+    memcpy(kf->itemrespawnque, itemrespawnque, sizeof(itemrespawnque));
+    memcpy(kf->itemrespawntime, itemrespawntime, sizeof(itemrespawntime));
+
+    // Index the thinkers once for all the archived mobj pointers.
+    P_IndexThinkers(true);
+
+    P_OpenSaveGameWrite();
+    P_ArchivePlayers();
+    P_ArchiveWorld();
+    P_ArchiveThinkers();
+    P_ArchiveSpecials();
+    P_ArchiveOldSpecials();
+    kf->data = P_TakeSaveGameBuffer(&kf->length);
+    kf->data = I_Realloc(kf->data, MAX(kf->length, 1));
+
+    // Order of the thinker list.
+    for (th = thinkercap.next, count = 0 ; th != &thinkercap ; th = th->next)
+    {
+        count++;
+    }
+
+    kf->order = I_Realloc(NULL, MAX(count, 1));
+    kf->numthinkers = count;
+
+    for (th = thinkercap.next, i = 0 ; th != &thinkercap ; th = th->next, i++)
+    {
+        kf->order[i] = th->function.acp1 == (actionf_p1) P_MobjThinker ? kf_mobj :
+                       th->function.acv == (actionf_v) (-1) ? kf_removed :
+                                                              kf_special;
+    }
+
+    // Mobj pointers not kept by savegames.
+    numnewlinks = 0;
+
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        AddMobjLink(sectors[i].soundtarget);
+    }
+    for (i = 0 ; i < MAXPLAYERS ; i++)
+    {
+        AddMobjLink(players[i].attacker);
+    }
+    for (i = 0 ; i < BODYQUESIZE ; i++)
+    {
+        AddMobjLink(bodyque[i]);
+    }
+    for (i = 0 ; i < numbraintargets ; i++)
+    {
+        AddMobjLink(braintargets[i]);
+    }
+
+    // Order of the sector thing lists...
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        slot = numnewlinks;
+        AddLink(0);
+
+        for (mo = sectors[i].thinglist ; mo ; mo = mo->snext)
+        {
+            AddMobjLink(mo);
+            newlinks[slot]++;
+        }
+    }
+
+    // ... and of the blockmap thing lists.
+    for (i = 0 ; i < bmapwidth * bmapheight ; i++)
+    {
+        if (blocklinks[i])
+        {
+            AddLink(i);
+            slot = numnewlinks;
+            AddLink(0);
+
+            for (mo = blocklinks[i] ; mo ; mo = mo->bnext)
+            {
+                AddMobjLink(mo);
+                newlinks[slot]++;
+            }
+        }
+    }
+    AddLink(-1);
+
+    P_IndexThinkers(false);
+
+    kf->numlinks = numnewlinks;
+    kf->links = I_Realloc(NULL, numnewlinks * sizeof(*kf->links));
+    memcpy(kf->links, newlinks, numnewlinks * sizeof(*kf->links));
+
+    kf->heights = I_Realloc(NULL, MAX(numsectors, 1) * 2
+                                  * sizeof(*kf->heights));
+
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        kf->heights[2 * i] = sectors[i].floorheight;
+        kf->heights[2 * i + 1] = sectors[i].ceilingheight;
+    }
+
+    kf->size = sizeof(*kf) + kf->length + kf->numthinkers
+             + kf->numlinks * sizeof(*kf->links)
+             + numsectors * 2 * sizeof(*kf->heights);
+
+    // Keyframes are taken in increasing tic order, except after rewinding.
+    for (i = numkeyframes ; i > 0 && keyframes[i - 1]->tic > kf->tic ; i--);
+
+    if (numkeyframes == maxkeyframes)
+    {
+        maxkeyframes = maxkeyframes ? 2 * maxkeyframes : 64;
+        keyframes = I_Realloc(keyframes, maxkeyframes * sizeof(*keyframes));
+    }
+
+    memmove(&keyframes[i + 1], &keyframes[i],
+            (numkeyframes - i) * sizeof(*keyframes));
+    keyframes[i] = kf;
+    numkeyframes++;
+    keyframe_memory += kf->size;
+
+    EvictKeyframes();
+}
+
+// -----------------------------------------------------------------------------
+// RestoreKeyframe
+// -----------------------------------------------------------------------------
+
+static void RestoreKeyframe (const keyframe_t *kf)
+{
+    thinker_t **mobjs, **specials, **bypos;
+    thinker_t  *th;
+    mobj_t     *mo;
+    const int  *link;
+    int         nummobjs, numspecials, wantmobjs, wantspecials;
+    int         i, m, s, count;
+
+    // Load the base level, as G_DoLoadGame does.
+    precache = false;
+    G_InitNew(kf->skill, kf->episode, kf->map);
+    precache = true;
+
+    usergame = false;
+    demoplayback = true;
+
+    P_OpenSaveGameBuffer(kf->data, kf->length);
+    P_UnArchivePlayers();
+    P_UnArchiveWorld();
+    P_UnArchiveThinkers();
+    P_UnArchiveSpecials();
+    P_UnArchiveOldSpecials();
+
+    // Restored thinkers come as all the mobjs, then all the specials.
+    for (th = thinkercap.next, count = 0 ; th != &thinkercap ; th = th->next)
+    {
+        count++;
+    }
+
+    mobjs = I_Realloc(NULL, MAX(count, 1) * sizeof(*mobjs));
+    specials = I_Realloc(NULL, MAX(count, 1) * sizeof(*specials));
+    bypos = I_Realloc(NULL, (kf->numthinkers + 1) * sizeof(*bypos));
+    memset(bypos, 0, (kf->numthinkers + 1) * sizeof(*bypos));
+    nummobjs = numspecials = 0;
+
+    for (th = thinkercap.next ; th != &thinkercap ; th = th->next)
+    {
+        if (th->function.acp1 == (actionf_p1) P_MobjThinker)
+        {
+            mobjs[nummobjs++] = th;
+        }
+        else
+        {
+            specials[numspecials++] = th;
+        }
+    }
+
+    for (i = 0, wantmobjs = wantspecials = 0 ; i < kf->numthinkers ; i++)
+    {
+        wantmobjs += kf->order[i] == kf_mobj;
+        wantspecials += kf->order[i] == kf_special;
+    }
+
+    if (nummobjs != wantmobjs)
+    {
+        I_Error("G_RestoreKeyframe: %d mobjs restored, %d expected",
+                nummobjs, wantmobjs);
+    }
+
+    // Put the thinkers back into their original order. Specials can only
+    // be matched if all of them were archived, which is normally the case.
+    for (i = 0, m = s = 0 ; i < kf->numthinkers ; i++)
+    {
+        if (kf->order[i] == kf_mobj)
+        {
+            bypos[i + 1] = mobjs[m++];
+        }
+        else if (kf->order[i] == kf_special && numspecials == wantspecials)
+        {
+            bypos[i + 1] = specials[s++];
+        }
+    }
+
+    if (numspecials == wantspecials)
+    {
+        thinkercap.next = thinkercap.prev = &thinkercap;
+
+        for (i = 1 ; i <= kf->numthinkers ; i++)
+        {
+            if ((th = bypos[i]) != NULL)
+            {
+                thinkercap.prev->next = th;
+                th->next = &thinkercap;
+                th->prev = thinkercap.prev;
+                thinkercap.prev = th;
+            }
+        }
+    }
+
+#define MOBJ_AT(pos) ((pos) > 0 && (pos) <= kf->numthinkers \
+                      && kf->order[(pos) - 1] == kf_mobj ? (mobj_t *) bypos[pos] : NULL)
+
+    // Archived targets and tracers are thinker list positions.
+    for (i = 0 ; i < nummobjs ; i++)
+    {
+        mo = (mobj_t *) mobjs[i];
+        mo->target = MOBJ_AT((int) (uintptr_t) mo->target);
+        mo->tracer = MOBJ_AT((int) (uintptr_t) mo->tracer);
+    }
+
+    link = kf->links;
+
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        sectors[i].soundtarget = MOBJ_AT(*link); link++;
+    }
+    for (i = 0 ; i < MAXPLAYERS ; i++)
+    {
+        players[i].attacker = MOBJ_AT(*link); link++;
+    }
+    for (i = 0 ; i < BODYQUESIZE ; i++)
+    {
+        bodyque[i] = MOBJ_AT(*link); link++;
+    }
+    // The brain target array only grows, so it still has room for these.
+    for (i = 0 ; i < kf->numbraintargets ; i++)
+    {
+        braintargets[i] = MOBJ_AT(*link); link++;
+    }
+
+    // Rebuild the thing lists in their original order,
+    // things are linked at the head of the lists.
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        const int num = *link++;
+        int j;
+
+        sectors[i].thinglist = NULL;
+
+        for (j = num - 1 ; j >= 0 ; j--)
+        {
+            if ((mo = MOBJ_AT(link[j])) != NULL)
+            {
+                mo->sprev = NULL;
+                mo->snext = sectors[i].thinglist;
+                if (sectors[i].thinglist)
+                    sectors[i].thinglist->sprev = mo;
+                sectors[i].thinglist = mo;
+            }
+        }
+
+        link += num;
+    }
+
+    memset(blocklinks, 0, bmapwidth * bmapheight * sizeof(*blocklinks));
+
+    while (*link >= 0)
+    {
+        mobj_t **const cell = &blocklinks[*link++];
+        const int num = *link++;
+        int j;
+
+        for (j = num - 1 ; j >= 0 ; j--)
+        {
+            if ((mo = MOBJ_AT(link[j])) != NULL)
+            {
+                mo->bprev = NULL;
+                mo->bnext = *cell;
+                if (*cell)
+                    (*cell)->bprev = mo;
+                *cell = mo;
+            }
+        }
+
+        link += num;
+    }
+
+#undef MOBJ_AT
+
+    free(mobjs);
+    free(specials);
+    free(bypos);
+
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        sectors[i].floorheight = kf->heights[2 * i];
+        sectors[i].ceilingheight = kf->heights[2 * i + 1];
+    }
+
+    demo_p = demobuffer + kf->demopos;
+    defdemotics = kf->tic;
+    leveltime = kf->leveltime;
+    totalleveltimes = kf->totalleveltimes;
+    demostarttic = gametic - kf->demophase;
+    prndindex = kf->prndindex;
+    rndindex = kf->rndindex;
+    skytexture = kf->skytexture;
+    R_InitSkyMap();
+    totalkills = kf->totalkills;
+    totalitems = kf->totalitems;
+    totalsecret = kf->totalsecret;
+    bodyqueslot = kf->bodyqueslot;
+    numbraintargets = kf->numbraintargets;
+    braintargeton = kf->braintargeton;
+    brainspiteasy = kf->brainspiteasy;
+    iquehead = kf->iquehead;
+    iquetail = kf->iquetail;
+    memcpy(itemrespawnque, kf->itemrespawnque, sizeof(itemrespawnque));
+    memcpy(itemrespawntime, kf->itemrespawntime, sizeof(itemrespawntime));
+
+    P_ResetStateHash();
+
+    // No screen wipe, the level is the same.
+    wipegamestate = GS_LEVEL;
+    R_FillBackScreen();
+}
+
+// -----------------------------------------------------------------------------
+// StartSeek
+// -----------------------------------------------------------------------------
+
+static void StartSeek (void)
+{
+    const keyframe_t *kf = NULL;
+    const int waspaused = paused & 2;
+    int i;
+
+    for (i = numkeyframes - 1 ; i >= 0 ; i--)
+    {
+        if (keyframes[i]->tic <= seek_target)
+        {
+            kf = keyframes[i];
+            break;
+        }
+    }
+
+    // Restore a keyframe when going back, or when it is ahead.
+    if (kf && (seek_target < defdemotics || kf->tic > defdemotics))
+    {
+        RestoreKeyframe(kf);
+    }
+    else if (seek_target < defdemotics)
+    {
+        return;
+    }
+
+    // Run the demo forward to the target tic.
+    if (defdemotics < seek_target && !seeking)
+    {
+        seek_nodrawers = nodrawers;
+        seek_singletics = singletics;
+        seek_paused = waspaused;
+
+        nodrawers = true;
+        singletics = true;
+        paused &= ~2;
+        seeking = true;
+    }
+    else if (waspaused && !(paused & 2))
+    {
+        // G_InitNew has unpaused.
+        paused |= 2;
+        S_PauseSound();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// G_KeyframeTicker
+// -----------------------------------------------------------------------------
+
+void G_KeyframeTicker (void)
+{
+    int interval;
+
+    if (!KeyframesActive())
+    {
+        return;
+    }
+
+    if (seek_pending)
+    {
+        seek_pending = false;
+        StartSeek();
+    }
+
+    if (seeking && defdemotics >= seek_target)
+    {
+        StopSeek();
+    }
+
+    if (gamestate != GS_LEVEL || (paused & 2))
+    {
+        return;
+    }
+
+    interval = demo_keyframe_interval * TICRATE;
+
+    if (defdemotics % interval == 0)
+    {
+        for (int i = numkeyframes - 1 ; i >= 0 ; i--)
+        {
+            if (keyframes[i]->tic == defdemotics)
+            {
+                return;
+            }
+        }
+
+        CaptureKeyframe();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// G_DemoSeek
+// -----------------------------------------------------------------------------
+
+void G_DemoSeek (int tic)
+{
+    if (KeyframesActive())
+    {
+        seek_target = BETWEEN(0, deftotaldemotics, tic);
+        seek_pending = true;
+    }
+}
+
+void G_DemoSeekBy (int tics)
+{
+    G_DemoSeek((seeking || seek_pending ? seek_target : defdemotics) + tics);
+}
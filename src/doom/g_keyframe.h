@@ -0,0 +1,36 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Demo keyframes: rewind and seek during demo playback.
+//
+
+
+#pragma once
+
+#include "doomtype.h"
+
+
+// Seek step of the rewind and forward keys.
+#define KEYFRAME_SEEKSTEP (10*TICRATE)
+
+// Frees all keyframes, stops seeking.
+extern void G_ClearKeyframes (void);
+
+// Called by G_Ticker between its game actions and reading the demo
+// commands: seeks, and takes keyframes while playing back.
+extern void G_KeyframeTicker (void);
+
+// Seeks to the given demo tic, or by the given number of tics.
+extern void G_DemoSeek (int tic);
+extern void G_DemoSeekBy (int tics);
@@ -26,6 +26,9 @@
 #include "m_misc.h"
 #include "p_local.h"
 
+#include "i_perf.h"
+#include "i_timer.h"
+#include "z_zone.h"
 #include "id_vars.h"
 #include "id_func.h"
 
@@ -438,9 +441,9 @@ void ID_LeftWidgets (void)
             M_snprintf(opn, 16, "%d", IDRender.numopenings);
             M_WriteText(32 + left_align, 142, opn, ID_WidgetColor(widget_render_val));
 
-            // Planes
+            // Planes / flat switches
             M_WriteText(left_align, 151, "PLN:", ID_WidgetColor(widget_render_str));
-            M_snprintf(vis, 32, "%d", IDRender.numplanes);
+            M_snprintf(vis, 32, "%d/%d", IDRender.numplanes, IDRender.numflatswitches);
             M_WriteText(32 + left_align, 151, vis, ID_WidgetColor(widget_render_val));
         }
     }
@@ -481,9 +484,9 @@ void ID_LeftWidgets (void)
             M_snprintf(opn, 16, "%d", IDRender.numopenings);
             M_WriteText(32 + left_align, 72 + yy1, opn, ID_WidgetColor(widget_render_val));
 
-            // Planes
+            // Planes / flat switches
             M_WriteText(left_align, 81 + yy1, "PLN:", ID_WidgetColor(widget_render_str));
-            M_snprintf(vis, 32, "%d", IDRender.numplanes);
+            M_snprintf(vis, 32, "%d/%d", IDRender.numplanes, IDRender.numflatswitches);
             M_WriteText(32 + left_align, 81 + yy1, vis, ID_WidgetColor(widget_render_val));
         }
 
@@ -664,6 +667,72 @@ void ID_LeftWidgets (void)
     }
 }
 
+// -----------------------------------------------------------------------------
+// ID_ZoneWidget
+//  [JN] Zone memory usage, sizes are in KiB. Updated once a second.
+// -----------------------------------------------------------------------------
+
+static void ID_ZoneWidget (int yy)
+{
+    static zonestats_t stats;
+    static unsigned int lastmallocs, lastfrees;
+    static int lasttime, mallocrate, freerate;
+    const int time = I_GetTimeMS();
+    const char *names[5 + PU_NUM_TAGS + 2];
+    char values[5 + PU_NUM_TAGS + 2][16];
+    int  i, n = 0;
+
+    if (!lasttime || time - lasttime >= 1000)
+    {
+        Z_GetStats(&stats);
+
+        if (lasttime)
+        {
+            mallocrate = (int) (stats.mallocs - lastmallocs) * 1000 / (time - lasttime);
+            freerate = (int) (stats.frees - lastfrees) * 1000 / (time - lasttime);
+        }
+
+        lastmallocs = stats.mallocs;
+        lastfrees = stats.frees;
+        lasttime = time;
+    }
+
+    names[n] = "ZONE";
+    M_snprintf(values[n++], 16, "%dK", stats.zonesize >> 10);
+    names[n] = "GROW";
+    M_snprintf(values[n++], 16, "%d", stats.growths);
+    names[n] = "FREE";
+    M_snprintf(values[n++], 16, "%dK", stats.freebytes >> 10);
+    names[n] = "LRG";
+    M_snprintf(values[n++], 16, "%dK", stats.largestfree >> 10);
+    names[n] = "FRG";
+    M_snprintf(values[n++], 16, "%d%%", stats.freebytes ?
+               100 - (int) ((int64_t) stats.largestfree * 100 / stats.freebytes) : 0);
+
+    for (i = 0 ; i < PU_NUM_TAGS ; i++)
+    {
+        if (zone_tagnames[i])
+        {
+            names[n] = zone_tagnames[i];
+            M_snprintf(values[n++], 16, "%dK/%d", stats.bytes[i] >> 10, stats.blocks[i]);
+        }
+    }
+
+    names[n] = "ALC/S";
+    M_snprintf(values[n++], 16, "%d", mallocrate);
+    names[n] = "FRE/S";
+    M_snprintf(values[n++], 16, "%d", freerate);
+
+    for (i = 0 ; i < n ; i++)
+    {
+        const int x = ORIGWIDTH + WIDESCREENDELTA - 7 - M_StringWidth(values[i]);
+
+        M_WriteText(x, yy, values[i], ID_WidgetColor(widget_render_val));
+        M_WriteText(x - 4 - M_StringWidth(names[i]), yy, names[i], ID_WidgetColor(widget_render_str));
+        yy += 9;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // ID_RightWidgets.
 //  [JN] Draw actual frames per second value.
@@ -704,6 +773,38 @@ void ID_RightWidgets (void)
     {
         M_WriteText(ORIGWIDTH + WIDESCREENDELTA - 7
                               - M_StringWidth(ID_Local_Time), yy, ID_Local_Time, cr[CR_GRAY]);
+
+        yy += 9;
+    }
+
+    // [JN] Zone memory usage.
+    if (widget_render == 3)
+    {
+        ID_ZoneWidget(yy + 4);
+    }
+
+    // [JN] Frame phase timings, in microseconds.
+    if (widget_render == 2)
+    {
+        char str[32];
+        int  i;
+
+        yy += 4;
+        M_WriteText(ORIGWIDTH + WIDESCREENDELTA - 7 - M_StringWidth("MIN/AVG/P99"), yy, "MIN/AVG/P99", ID_WidgetColor(widget_render_str));
+
+        for (i = 0 ; i < NUMPERFPHASES ; i++)
+        {
+            perfstat_t stat;
+            int x;
+
+            yy += 9;
+            I_PerfGetStats(i, &stat);
+            M_snprintf(str, sizeof(str), "%d/%d/%d", stat.min, stat.avg, stat.p99);
+            x = ORIGWIDTH + WIDESCREENDELTA - 7 - M_StringWidth(str);
+
+            M_WriteText(x, yy, str, ID_WidgetColor(widget_render_val));
+            M_WriteText(x - 4 - M_StringWidth(perf_names[i]), yy, perf_names[i], ID_WidgetColor(widget_render_str));
+        }
     }
 }
 
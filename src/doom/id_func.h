@@ -33,6 +33,7 @@ typedef struct ID_Data_s
     int numsprites;     // [JN] Number of sprites.
     int numsegs;        // [JN] Number of wall segments.
     int numplanes;      // [JN] Number of visplanes.
+    int numflatswitches; // [JN] Number of flats resolved by R_DrawPlanes.
     int numopenings;    // [JN] Number of openings.
 } ID_Render_t;
 
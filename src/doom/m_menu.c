@@ -29,6 +29,7 @@
 #include "d_main.h"
 #include "deh_main.h"
 #include "gusconf.h"
+#include "i_asyncio.h"
 #include "i_input.h"
 #include "i_swap.h"
 #include "i_system.h"
@@ -3215,7 +3216,9 @@ static void M_Draw_ID_Widgets (void)
                  M_Item_Glow(8, widget_coords ? GLOW_GREEN : GLOW_DARKRED));
 
     // Rendering counters
-    sprintf(str, widget_render ? "ON" : "OFF");
+    sprintf(str, widget_render == 1 ? "ON"      :
+                 widget_render == 2 ? "TIMINGS" :
+                 widget_render == 3 ? "ZONE"    : "OFF");
     M_WriteText (M_ItemRightAlign(str), 99, str,
                  M_Item_Glow(9, widget_render ? GLOW_GREEN : GLOW_DARKRED));
 
@@ -3275,7 +3278,7 @@ static void M_ID_Widget_Coords (int choice)
 
 static void M_ID_Widget_Render (int choice)
 {
-    widget_render ^= 1;
+    widget_render = M_INT_Slider(widget_render, 0, 3, choice, false);
 }
 
 static void M_ID_Widget_Health (int choice)
@@ -4884,6 +4887,9 @@ static void M_ReadSaveStrings(void)
     int     i;
     char    name[256];
 
+    // [JN] Let a savegame written in the background reach the disk.
+    I_WaitFileWrites();
+
     for (i = 0;i < load_end;i++)
     {
         int retval;
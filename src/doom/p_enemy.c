@@ -163,7 +163,7 @@ void P_ForgetPlayer (player_t *player)
         thinker_t *th;
 
         // [crispy] let mobjs forget their target and tracer
-        for (th = thinkercap.next; th != &thinkercap; th = th->next)
+        for (th = thinklistcap[th_mobj].cnext; th != &thinklistcap[th_mobj]; th = th->cnext)
         {
             if (th->function.acp1 == (actionf_p1)P_MobjThinker)
             {
@@ -595,7 +595,7 @@ void A_KeenDie (mobj_t* mo)
     
     // scan the remaining thinkers
     // to see if all Keens are dead
-    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+    for (th = thinklistcap[th_mobj].cnext ; th != &thinklistcap[th_mobj] ; th = th->cnext)
     {
 	if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 	    continue;
@@ -1184,6 +1184,7 @@ boolean PIT_VileCheck (mobj_t*	thing)
 		
     corpsehit = thing;
     corpsehit->momx = corpsehit->momy = 0;
+    P_DirtyMobj (corpsehit);  // [JN] Game state hash, even if it does not fit.
     corpsehit->height <<= 2;
     check = P_CheckPosition (corpsehit, corpsehit->x, corpsehit->y);
     corpsehit->height >>= 2;
@@ -1374,6 +1375,7 @@ void A_VileAttack (mobj_t* actor)
     S_StartSound (actor, sfx_barexp);
     P_DamageMobj (actor->target, actor, actor, 20);
     actor->target->momz = 1000*FRACUNIT/actor->target->info->mass;
+    P_DirtyMobj (actor->target);  // [JN] Game state hash, even if it is dead.
 	
     an = actor->angle >> ANGLETOFINESHIFT;
 
@@ -1385,6 +1387,7 @@ void A_VileAttack (mobj_t* actor)
     // move the fire between the vile and the player
     fire->x = actor->target->x - FixedMul (24*FRACUNIT, finecosine[an]);
     fire->y = actor->target->y - FixedMul (24*FRACUNIT, finesine[an]);	
+    P_DirtyMobj (fire);  // [JN] Game state hash.
     P_RadiusAttack (fire, actor, 70 );
 }
 
@@ -1523,13 +1526,13 @@ A_PainShootSkull
     // count total number of skull currently on the level
     count = 0;
 
-    currentthinker = thinkercap.next;
-    while (currentthinker != &thinkercap)
+    currentthinker = thinklistcap[th_mobj].cnext;
+    while (currentthinker != &thinklistcap[th_mobj])
     {
 	if (   (currentthinker->function.acp1 == (actionf_p1)P_MobjThinker)
 	    && ((mobj_t *)currentthinker)->type == MT_SKULL)
 	    count++;
-	currentthinker = currentthinker->next;
+	currentthinker = currentthinker->cnext;
     }
 
     // if there are allready 20 skulls on the level,
@@ -1758,7 +1761,7 @@ void A_BossDeath (mobj_t* mo)
     
     // scan the remaining thinkers to see
     // if all bosses are dead
-    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+    for (th = thinklistcap[th_mobj].cnext ; th != &thinklistcap[th_mobj] ; th = th->cnext)
     {
 	if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 	    continue;
@@ -1850,6 +1853,7 @@ void A_BabyMetal (mobj_t* mo)
 mobj_t**		braintargets = NULL;
 int		numbraintargets = 0; // [crispy] initialize
 int		braintargeton = 0;
+int		brainspiteasy = 0; // [JN] made global for demo keyframes
 static int	maxbraintargets; // [crispy] remove braintargets limit
 
 void A_BrainAwake (mobj_t* mo)
@@ -1861,9 +1865,9 @@ void A_BrainAwake (mobj_t* mo)
     numbraintargets = 0;
     braintargeton = 0;
 
-    for (thinker = thinkercap.next ;
-	 thinker != &thinkercap ;
-	 thinker = thinker->next)
+    for (thinker = thinklistcap[th_mobj].cnext ;
+	 thinker != &thinklistcap[th_mobj] ;
+	 thinker = thinker->cnext)
     {
 	if (thinker->function.acp1 != (actionf_p1)P_MobjThinker)
 	    continue;	// not a mobj
@@ -1967,11 +1971,9 @@ void A_BrainSpit (mobj_t*	mo)
 {
     mobj_t*	targ;
     mobj_t*	newmobj;
-    
-    static int	easy = 0;
 	
-    easy ^= 1;
-    if (gameskill <= sk_easy && (!easy))
+    brainspiteasy ^= 1;
+    if (gameskill <= sk_easy && (!brainspiteasy))
 	return;
 		
     // [crispy] avoid division by zero by recalculating the number of spawn spots
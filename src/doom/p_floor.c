@@ -45,6 +45,12 @@ T_MovePlane
     boolean	flag;
     fixed_t	lastpos;
 	
+    // [JN] Sight checks depend on sector heights.
+    P_ClearSightCache();
+
+    // [JN] Game state hash.
+    P_DirtySector(sector);
+
     // [AM] Store old sector heights for interpolation.
     if (sector->oldgametic != gametic)
     {
@@ -362,6 +368,7 @@ EV_DoFloor
 		24 * FRACUNIT;
 	    sec->floorpic = line->frontsector->floorpic;
 	    sec->special = line->frontsector->special;
+	    P_DirtySector (sec);  // [JN] Game state hash.
 	    break;
 
 	  case raiseToTexture:
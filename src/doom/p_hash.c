@@ -0,0 +1,458 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Game state hash, used to tell if two runs of a demo are in sync.
+//
+//      The hash covers what the play simulation depends on: mobj
+//      positions, momenta, angles, states and their tics, flags, health,
+//      move directions and reaction times, sector heights, lights and
+//      specials, player status and the random number indexes. Savegames
+//      can not be hashed instead, since they contain pointers.
+//
+//      Every mobj and sector keeps its own hash, and the state hash adds
+//      them up, so it does not depend on their order. Code that changes
+//      a mobj or a sector marks it dirty, and only dirty ones are hashed
+//      again at the end of the tic, instead of the whole level.
+//
+//      A mobj or sector has to be marked in the tic it changes in, before
+//      or after the change. Most changes are covered by P_SetMobjState
+//      (and so every action function on its actor), P_SetThingPosition,
+//      P_DamageMobj, PIT_ChangeSector and P_PlayerThink, by P_MobjThinker
+//      when a mobj moves, and by T_MovePlane for sectors. Changes made
+//      anywhere else, such as to other mobjs than the actor, to sector
+//      specials by line specials, or by cheats while paused, are marked
+//      where they are made.
+//
+//      State tics count down every tic, so instead of them the hash has
+//      the level time the state ends at, which only changes along with
+//      the state.
+//
+//      Hashes differ from those of builds which hashed the whole level
+//      every time, so -demobatch reports made by them have to be made
+//      again.
+//
+//      Nothing enforces this but -statehashcheck, which compares the hash
+//      with a hash of the whole level every tic. Run it on a few demos
+//      after changing code which writes to mobjs or sectors.
+//
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include "doomstat.h"
+#include "i_system.h"
+#include "m_argv.h"
+#include "m_misc.h"
+#include "p_local.h"
+
+
+#define HASH_INIT   0xcbf29ce484222325ull
+#define HASH_PRIME  0x100000001b3ull
+
+boolean statehash_active;
+
+static boolean statehash_wanted;    // -statehash or -statehashcheck
+static boolean statehash_check;
+static FILE   *statehash_file;
+
+static mobj_t   **dirtymobjs;
+static int        numdirtymobjs;
+static int        maxdirtymobjs;
+static sector_t **dirtysectors;
+static int        numdirtysectors;
+static int        maxdirtysectors;
+
+// Sums of the mobj and sector hashes.
+static uint64_t   mobjsum;
+static uint64_t   sectorsum;
+
+
+// -----------------------------------------------------------------------------
+// HashInt
+// 64-bit FNV-1a of a 32-bit value.
+// -----------------------------------------------------------------------------
+
+static inline uint64_t HashInt (uint64_t hash, int value)
+{
+    const unsigned int v = (unsigned int) value;
+
+    hash = (hash ^ (v & 0xff)) * HASH_PRIME;
+    hash = (hash ^ ((v >> 8) & 0xff)) * HASH_PRIME;
+    hash = (hash ^ ((v >> 16) & 0xff)) * HASH_PRIME;
+    hash = (hash ^ (v >> 24)) * HASH_PRIME;
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+// HashMobj, HashSector, HashPlayer
+// -----------------------------------------------------------------------------
+
+static uint64_t HashMobj (const mobj_t *mo)
+{
+    uint64_t hash = HASH_INIT;
+
+    hash = HashInt(hash, mo->type);
+    hash = HashInt(hash, mo->x);
+    hash = HashInt(hash, mo->y);
+    hash = HashInt(hash, mo->z);
+    hash = HashInt(hash, mo->momx);
+    hash = HashInt(hash, mo->momy);
+    hash = HashInt(hash, mo->momz);
+    hash = HashInt(hash, mo->angle);
+    hash = HashInt(hash, mo->health);
+    hash = HashInt(hash, mo->flags);
+    hash = HashInt(hash, (int) (mo->state - states));
+    hash = HashInt(hash, mo->tics == -1 ? -1 : leveltime + mo->tics);
+    hash = HashInt(hash, mo->movedir);
+    hash = HashInt(hash, mo->reactiontime);
+
+    return hash;
+}
+
+static uint64_t HashSector (const sector_t *sector)
+{
+    uint64_t hash = HASH_INIT;
+
+    hash = HashInt(hash, (int) (sector - sectors));
+    hash = HashInt(hash, sector->floorheight);
+    hash = HashInt(hash, sector->ceilingheight);
+    hash = HashInt(hash, sector->lightlevel);
+    hash = HashInt(hash, sector->special);
+
+    return hash;
+}
+
+static uint64_t HashPlayer (uint64_t hash, const player_t *player)
+{
+    int i;
+
+    hash = HashInt(hash, player->playerstate);
+    hash = HashInt(hash, player->health);
+    hash = HashInt(hash, player->armorpoints);
+    hash = HashInt(hash, player->armortype);
+    hash = HashInt(hash, player->readyweapon);
+    hash = HashInt(hash, player->pendingweapon);
+    hash = HashInt(hash, player->killcount);
+    hash = HashInt(hash, player->itemcount);
+    hash = HashInt(hash, player->secretcount);
+
+    for (i = 0 ; i < NUMPOWERS ; i++)
+    {
+        hash = HashInt(hash, player->powers[i]);
+    }
+    for (i = 0 ; i < NUMAMMO ; i++)
+    {
+        hash = HashInt(hash, player->ammo[i]);
+    }
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+// CombineHash
+// State hash of the given mobj and sector sums.
+// -----------------------------------------------------------------------------
+
+static uint64_t CombineHash (uint64_t mobjs, uint64_t sects)
+{
+    uint64_t hash = HASH_INIT;
+    int      i;
+
+    hash = HashInt(hash, (int) mobjs);
+    hash = HashInt(hash, (int) (mobjs >> 32));
+    hash = HashInt(hash, (int) sects);
+    hash = HashInt(hash, (int) (sects >> 32));
+    hash = HashInt(hash, leveltime);
+    hash = HashInt(hash, prndindex);
+    hash = HashInt(hash, rndindex);
+
+    for (i = 0 ; i < MAXPLAYERS ; i++)
+    {
+        if (playeringame[i])
+        {
+            hash = HashPlayer(hash, &players[i]);
+        }
+    }
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+// P_StateHash
+// Walks the whole level, meant to be called once in a while.
+// -----------------------------------------------------------------------------
+
+uint64_t P_StateHash (void)
+{
+    uint64_t   mobjs = 0, sects = 0;
+    thinker_t *th;
+    int        i;
+
+    for (th = thinklistcap[th_mobj].cnext ; th != &thinklistcap[th_mobj] ; th = th->cnext)
+    {
+        if (th->function.acv != (actionf_v) (-1))
+        {
+            mobjs += HashMobj((const mobj_t *) th);
+        }
+    }
+
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        sects += HashSector(&sectors[i]);
+    }
+
+    return CombineHash(mobjs, sects);
+}
+
+// -----------------------------------------------------------------------------
+// P_ClearStateHash
+// Forgets dirty mobjs and sectors, called when the level is unloaded.
+// -----------------------------------------------------------------------------
+
+void P_ClearStateHash (void)
+{
+    numdirtymobjs = numdirtysectors = 0;
+    mobjsum = sectorsum = 0;
+}
+
+// -----------------------------------------------------------------------------
+// P_ResetStateHash
+// Hashes every mobj and sector of the level, called when it is loaded.
+// -----------------------------------------------------------------------------
+
+void P_ResetStateHash (void)
+{
+    thinker_t *th;
+    int        i;
+
+    if (!statehash_active)
+    {
+        return;
+    }
+
+    P_ClearStateHash();
+
+    for (th = thinklistcap[th_mobj].cnext ; th != &thinklistcap[th_mobj] ; th = th->cnext)
+    {
+        mobj_t *const mo = (mobj_t *) th;
+
+        mo->hashslot = 0;
+        mo->statehash = 0;
+
+        if (th->function.acv != (actionf_v) (-1))
+        {
+            mo->statehash = HashMobj(mo);
+            mobjsum += mo->statehash;
+        }
+    }
+
+    for (i = 0 ; i < numsectors ; i++)
+    {
+        sectors[i].hashslot = 0;
+        sectors[i].statehash = HashSector(&sectors[i]);
+        sectorsum += sectors[i].statehash;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// P_AddDirtyMobj, P_AddDirtySector
+// Called by P_DirtyMobj and P_DirtySector for clean ones.
+// -----------------------------------------------------------------------------
+
+void P_AddDirtyMobj (mobj_t *mo)
+{
+    if (numdirtymobjs == maxdirtymobjs)
+    {
+        maxdirtymobjs = maxdirtymobjs ? 2 * maxdirtymobjs : 1024;
+        dirtymobjs = I_Realloc(dirtymobjs, maxdirtymobjs * sizeof(*dirtymobjs));
+    }
+
+    dirtymobjs[numdirtymobjs++] = mo;
+    mo->hashslot = numdirtymobjs;
+}
+
+void P_AddDirtySector (sector_t *sector)
+{
+    if (numdirtysectors == maxdirtysectors)
+    {
+        maxdirtysectors = maxdirtysectors ? 2 * maxdirtysectors : 256;
+        dirtysectors = I_Realloc(dirtysectors, maxdirtysectors * sizeof(*dirtysectors));
+    }
+
+    dirtysectors[numdirtysectors++] = sector;
+    sector->hashslot = numdirtysectors;
+}
+
+// -----------------------------------------------------------------------------
+// P_RemoveMobjHash
+// Takes a removed mobj out of the state hash.
+// -----------------------------------------------------------------------------
+
+void P_RemoveMobjHash (mobj_t *mo)
+{
+    if (!statehash_active)
+    {
+        return;
+    }
+
+    mobjsum -= mo->statehash;
+    mo->statehash = 0;
+
+    if (mo->hashslot)
+    {
+        mobj_t *const last = dirtymobjs[--numdirtymobjs];
+
+        if (last->hashslot == numdirtymobjs + 1)
+        {
+            last->hashslot = mo->hashslot;
+        }
+
+        dirtymobjs[mo->hashslot - 1] = last;
+        mo->hashslot = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// P_TicStateHash
+// Hashes dirty mobjs and sectors again, returns the state hash.
+// Called once at the end of every tic.
+// -----------------------------------------------------------------------------
+
+uint64_t P_TicStateHash (void)
+{
+    uint64_t hash;
+    int      i;
+
+    for (i = 0 ; i < numdirtymobjs ; i++)
+    {
+        mobj_t *const mo = dirtymobjs[i];
+
+        // Removed mobjs are out of the hash already.
+        if (mo->hashslot != i + 1
+        ||  mo->thinker.function.acv == (actionf_v) (-1))
+        {
+            continue;
+        }
+
+        mobjsum -= mo->statehash;
+        mo->statehash = HashMobj(mo);
+        mobjsum += mo->statehash;
+        mo->hashslot = 0;
+    }
+
+    for (i = 0 ; i < numdirtysectors ; i++)
+    {
+        sector_t *const sector = dirtysectors[i];
+
+        sectorsum -= sector->statehash;
+        sector->statehash = HashSector(sector);
+        sectorsum += sector->statehash;
+        sector->hashslot = 0;
+    }
+
+    numdirtymobjs = numdirtysectors = 0;
+
+    hash = CombineHash(mobjsum, sectorsum);
+
+    if (statehash_check)
+    {
+        const uint64_t full = P_StateHash();
+
+        if (hash != full)
+        {
+            I_Error("P_TicStateHash: Hash %016" PRIx64 " at gametic %d, "
+                    "%016" PRIx64 " expected", hash, gametic, full);
+        }
+    }
+
+    if (statehash_file)
+    {
+        fprintf(statehash_file, "%d %016" PRIx64 "\n", gametic, hash);
+    }
+
+    return hash;
+}
+
+// -----------------------------------------------------------------------------
+// P_EnableStateHash
+// Turns the state hash on or off, it stays on if asked for
+// from the command line.
+// -----------------------------------------------------------------------------
+
+void P_EnableStateHash (boolean enable)
+{
+    const boolean wasactive = statehash_active;
+
+    statehash_active = enable || statehash_wanted;
+
+    if (statehash_active && !wasactive && gamestate == GS_LEVEL)
+    {
+        P_ResetStateHash();
+    }
+}
+
+// -----------------------------------------------------------------------------
+// P_InitStateHash
+// -----------------------------------------------------------------------------
+
+static void CloseStateHashFile (void)
+{
+    fclose(statehash_file);
+    statehash_file = NULL;
+}
+
+void P_InitStateHash (void)
+{
+    int p;
+
+    //!
+    // @arg <file>
+    // @category demo
+    //
+    // Write gametic and game state hash of every tic to the given file.
+    // Logs of two runs of a demo, or of two players of a network game,
+    // can be compared to find where they went out of sync.
+    //
+
+    p = M_CheckParmWithArgs("-statehash", 1);
+
+    if (p)
+    {
+        statehash_file = M_fopen(myargv[p + 1], "w");
+
+        if (!statehash_file)
+        {
+            I_Error("P_InitStateHash: Failed to open %s", myargv[p + 1]);
+        }
+
+        I_AtExit(CloseStateHashFile, true);
+        statehash_wanted = true;
+    }
+
+    //!
+    // @category obscure
+    //
+    // Check the game state hash against a hash of the whole level
+    // every tic, and quit with an error if they differ.
+    //
+
+    if (M_ParmExists("-statehashcheck"))
+    {
+        statehash_check = true;
+        statehash_wanted = true;
+    }
+
+    statehash_active = statehash_wanted;
+}
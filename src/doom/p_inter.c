@@ -314,6 +314,7 @@ P_GivePower
     {
 	player->powers[power] = INVISTICS;
 	player->mo->flags |= MF_SHADOW;
+	P_DirtyMobj (player->mo);  // [JN] Game state hash, cheats give it paused.
 	return true;
     }
     
@@ -884,6 +885,9 @@ P_DamageMobj
     if (target->health <= 0)
 	return;
 
+    // [JN] Game state hash.
+    P_DirtyMobj (target);
+
     if ( target->flags & MF_SKULLFLY )
     {
 	target->momx = target->momy = target->momz = 0;
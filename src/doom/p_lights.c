@@ -45,6 +45,7 @@ void T_FireFlicker (fireflicker_t* flick)
     else
 	flick->sector->lightlevel = flick->maxlight - amount;
 
+    P_DirtySector (flick->sector);  // [JN] Game state hash.
     flick->count = 4;
 }
 
@@ -99,6 +100,8 @@ void T_LightFlash (lightflash_t* flash)
 	flash->count = (P_Random()&flash->maxtime)+1;
     }
 
+    P_DirtySector (flash->sector);  // [JN] Game state hash.
+
 }
 
 
@@ -156,6 +159,8 @@ void T_StrobeFlash (strobe_t*		flash)
 	flash->count =flash->darktime;
     }
 
+    P_DirtySector (flash->sector);  // [JN] Game state hash.
+
 }
 
 
@@ -189,6 +194,7 @@ P_SpawnStrobeFlash
 
     // nothing special about it during gameplay
     sector->special = 0;	
+    P_DirtySector (sector);  // [JN] Game state hash, may be triggered.
 
     if (!inSync)
 	flash->count = (P_Random()&7)+1;
@@ -230,24 +236,23 @@ void EV_TurnTagLightsOff(line_t* line)
     sector_t*		tsec;
     line_t*		templine;
 	
-    sector = sectors;
-    
-    for (j = 0;j < numsectors; j++, sector++)
+    j = -1;
+
+    while ((j = P_FindSectorFromTag(line->tag, j)) >= 0)
     {
-	if (sector->tag == line->tag)
+	sector = &sectors[j];
+	min = sector->lightlevel;
+	for (i = 0;i < sector->linecount; i++)
 	{
-	    min = sector->lightlevel;
-	    for (i = 0;i < sector->linecount; i++)
-	    {
-		templine = sector->lines[i];
-		tsec = getNextSector(templine,sector);
-		if (!tsec)
-		    continue;
-		if (tsec->lightlevel < min)
-		    min = tsec->lightlevel;
-	    }
-	    sector->lightlevel = min;
+	    templine = sector->lines[i];
+	    tsec = getNextSector(templine,sector);
+	    if (!tsec)
+		continue;
+	    if (tsec->lightlevel < min)
+		min = tsec->lightlevel;
 	}
+	sector->lightlevel = min;
+	P_DirtySector (sector);  // [JN] Game state hash.
     }
 }
 
@@ -266,31 +271,31 @@ EV_LightTurnOn
     sector_t*	temp;
     line_t*	templine;
 	
-    sector = sectors;
-	
-    for (i=0;i<numsectors;i++, sector++)
+    i = -1;
+
+    while ((i = P_FindSectorFromTag(line->tag, i)) >= 0)
     {
-	if (sector->tag == line->tag)
+	sector = &sectors[i];
+
+	// bright = 0 means to search
+	// for highest light level
+	// surrounding sector
+	if (!bright)
 	{
-	    // bright = 0 means to search
-	    // for highest light level
-	    // surrounding sector
-	    if (!bright)
+	    for (j = 0;j < sector->linecount; j++)
 	    {
-		for (j = 0;j < sector->linecount; j++)
-		{
-		    templine = sector->lines[j];
-		    temp = getNextSector(templine,sector);
+		templine = sector->lines[j];
+		temp = getNextSector(templine,sector);
 
-		    if (!temp)
-			continue;
+		if (!temp)
+		    continue;
 
-		    if (temp->lightlevel > bright)
-			bright = temp->lightlevel;
-		}
+		if (temp->lightlevel > bright)
+		    bright = temp->lightlevel;
 	    }
-	    sector-> lightlevel = bright;
 	}
+	sector-> lightlevel = bright;
+	P_DirtySector (sector);  // [JN] Game state hash.
     }
 }
 
@@ -301,6 +306,8 @@ EV_LightTurnOn
 
 void T_Glow(glow_t*	g)
 {
+    P_DirtySector (g->sector);  // [JN] Game state hash.
+
     switch(g->direction)
     {
       case -1:
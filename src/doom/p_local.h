@@ -223,6 +223,11 @@ extern void P_NoiseAlert (mobj_t *target, mobj_t *emmiter);
 
 extern boolean P_CheckMeleeRange (mobj_t *actor);
 
+extern mobj_t **braintargets;
+extern int      numbraintargets;
+extern int      braintargeton;
+extern int      brainspiteasy;
+
 // -----------------------------------------------------------------------------
 // P_FLOOR
 // -----------------------------------------------------------------------------
@@ -296,6 +301,39 @@ extern void T_MoveFloor (floormove_t *floor);
 extern result_e T_MovePlane (sector_t *sector, fixed_t speed, fixed_t dest,
                              boolean crush, int floorOrCeiling, int direction);
 
+// -----------------------------------------------------------------------------
+// P_HASH
+// -----------------------------------------------------------------------------
+
+extern boolean statehash_active;
+
+extern uint64_t P_StateHash (void);
+extern uint64_t P_TicStateHash (void);
+extern void     P_ClearStateHash (void);
+extern void     P_ResetStateHash (void);
+extern void     P_EnableStateHash (boolean enable);
+extern void     P_InitStateHash (void);
+extern void     P_AddDirtyMobj (mobj_t *mo);
+extern void     P_AddDirtySector (sector_t *sector);
+extern void     P_RemoveMobjHash (mobj_t *mo);
+
+// [JN] Marks a changed mobj or sector to be hashed again at the end of tic.
+static inline void P_DirtyMobj (mobj_t *mo)
+{
+    if (statehash_active && !mo->hashslot)
+    {
+        P_AddDirtyMobj(mo);
+    }
+}
+
+static inline void P_DirtySector (sector_t *sector)
+{
+    if (statehash_active && !sector->hashslot)
+    {
+        P_AddDirtySector(sector);
+    }
+}
+
 // -----------------------------------------------------------------------------
 // P_INTER
 // -----------------------------------------------------------------------------
@@ -389,6 +427,8 @@ extern void T_StrobeFlash (strobe_t *flash);
 extern boolean P_ChangeSector (sector_t *sector, boolean crunch);
 extern boolean P_CheckPosition (mobj_t *thing, fixed_t x, fixed_t y);
 extern boolean P_CheckSight (mobj_t *t1, mobj_t *t2);
+extern void    P_InitSightCache (void);
+extern void    P_ClearSightCache (void);
 extern boolean P_TeleportMove (mobj_t *thing, fixed_t x, fixed_t y);
 extern boolean P_TryMove (mobj_t *thing, fixed_t x, fixed_t y);
 extern boolean PIT_ChangeSector (mobj_t *thing);
@@ -482,6 +522,9 @@ extern divline_t trace;
 #define ITEMQUESIZE 128
 
 extern boolean P_SetMobjState (mobj_t *mobj, statenum_t state);
+extern void    P_InitMobjPool (void);
+extern mobj_t *P_AllocMobj (void);
+extern void    P_FreeMobj (mobj_t *mobj);
 extern mobj_t *Crispy_PlayerSO (int p); // [crispy] weapon sound sources
 extern mobj_t *P_SpawnMissile (mobj_t *source, mobj_t *dest, mobjtype_t type);
 extern mobj_t *P_SpawnMobj (fixed_t x, fixed_t y, fixed_t z, mobjtype_t type);
@@ -625,10 +668,14 @@ extern void     P_UnArchiveWorld (void);
 extern void     P_WriteSaveGameEOF(void);
 extern void     P_WriteSaveGameHeader(char *description);
 
-extern FILE    *save_stream;
+extern boolean  P_OpenSaveGameRead (const char *filename);
+extern void     P_OpenSaveGameBuffer (const byte *data, size_t length);
+extern void     P_OpenSaveGameWrite (void);
+extern byte    *P_TakeSaveGameBuffer (size_t *length);
 extern boolean  savegame_error;
 
 extern const uint32_t P_ThinkerToIndex (const thinker_t *thinker);
+extern boolean  P_IndexThinkers (boolean enable);
 
 // -----------------------------------------------------------------------------
 // P_SETUP
@@ -677,6 +724,8 @@ extern fixed_t P_FindLowestFloorSurrounding (sector_t* sec);
 extern fixed_t P_FindNextHighestFloor (sector_t *sec, int currentheight);
 extern int     P_FindMinSurroundingLight (sector_t *sector, int max);
 extern int     P_FindSectorFromLineTag (line_t *line, int start);
+extern int     P_FindSectorFromTag (int tag, int start);
+extern void    P_InitTagLists (void);
 extern void    P_CrossSpecialLine (int linenum, int side, mobj_t *thing);
 extern void    P_InitPicAnims (void);
 extern void    P_PlayerInSpecialSector (player_t *player);
@@ -751,13 +800,28 @@ extern int EV_Teleport (line_t *line, int side, mobj_t *thing);
 // -----------------------------------------------------------------------------
 
 extern void P_InitThinkers (void);
+extern void P_InitBrightmapAnims (void);
 extern void P_AddThinker (thinker_t *thinker);
 extern void P_RemoveThinker (thinker_t *thinker);
+extern void P_FreeThinker (thinker_t *thinker);
 extern void P_Ticker (void);
 
 // both the head and tail of the thinker list
 extern thinker_t thinkercap;
 
+// [JN] Thinkers are also kept in a list of their class, linked by
+// cnext/cprev, in the same order as in the list of all thinkers.
+// Mobjs stay in th_mobj until they are freed, so the function of
+// a thinker still needs to be checked to skip removed ones.
+typedef enum
+{
+    th_mobj,    // mobjs
+    th_misc,    // movers, lights and others
+    NUMTHINKLISTS
+} thinklist_t;
+
+extern thinker_t thinklistcap[NUMTHINKLISTS];
+
 // -----------------------------------------------------------------------------
 // P_USER
 // -----------------------------------------------------------------------------
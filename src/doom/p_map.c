@@ -676,6 +676,8 @@ void P_ApplyTorque (mobj_t *mo)
     int yh = ((tmbbox[BOXTOP] = mo->y + mo->radius) - bmaporgy) >> MAPBLOCKSHIFT;
     int bx,by,flags = mo->intflags;  // Remember the current state, for gear-change
 
+    P_DirtyMobj(mo);  // [JN] Game state hash.
+
     tmthing = mo;
     validcount++;  // prevents checking same line twice
 
@@ -1592,6 +1594,9 @@ boolean		nofit;
 boolean PIT_ChangeSector (mobj_t*	thing)
 {
     mobj_t*	mo;
+
+    // [JN] Game state hash.
+    P_DirtyMobj (thing);
 	
     if (P_ThingHeightClip (thing))
     {
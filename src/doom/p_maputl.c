@@ -395,6 +395,8 @@ P_SetThingPosition (mobj_t* thing)
     int			blocky;
     mobj_t**		link;
 
+    // [JN] Game state hash.
+    P_DirtyMobj (thing);
     
     // link into subsector
     ss = R_PointInSubsector (thing->x,thing->y);
@@ -664,6 +666,10 @@ static void check_intercept(void)
 	}
 }
 
+// [JN] Incremented by every P_PathTraverse, so P_TraverseIntercepts
+// can tell if a traverser started another trace.
+static unsigned int intercepts_gen;
+
 divline_t 	trace;
 boolean 	earlyout;
 //int		ptflags;
@@ -842,22 +848,20 @@ static boolean PIT_AddThingIntercepts (mobj_t* thing)
 
 
 //
-// P_TraverseIntercepts
-// Returns true if the traverser function returns true
-// for all lines.
-// 
-boolean
-P_TraverseIntercepts
+// P_TraverseInterceptsLinear
+// The original traversal: finds the closest intercept
+// on every step, the first one wins among equal ones.
+//
+static boolean
+P_TraverseInterceptsLinear
 ( traverser_t	func,
-  fixed_t	maxfrac )
+  fixed_t	maxfrac,
+  int		count )
 {
-    int			count;
     fixed_t		dist;
     intercept_t*	scan;
     intercept_t*	in;
 	
-    count = intercept_p - intercepts;
-    
     in = 0;			// shut up compiler warning
 	
     while (count--)
@@ -897,6 +901,103 @@ P_TraverseIntercepts
 }
 
 
+//
+// P_SortIntercepts
+// [JN] Sorts intercepts by distance, equal ones keep their order,
+// which is the same order P_TraverseInterceptsLinear visits them.
+//
+static intercept_t**	sortedintercepts;
+
+static int CompareIntercepts (const void *a, const void *b)
+{
+    const intercept_t *const ia = *(intercept_t *const *) a;
+    const intercept_t *const ib = *(intercept_t *const *) b;
+
+    if (ia->frac != ib->frac)
+	return ia->frac < ib->frac ? -1 : 1;
+
+    return ia < ib ? -1 : ia > ib;
+}
+
+static void P_SortIntercepts (int count)
+{
+    static int	numsorted;
+    int		i;
+
+    if (count > numsorted)
+    {
+	numsorted = count > 2 * numsorted ? count : 2 * numsorted;
+	sortedintercepts = I_Realloc(sortedintercepts,
+	                             sizeof(*sortedintercepts) * numsorted);
+    }
+
+    for (i = 0 ; i < count ; i++)
+	sortedintercepts[i] = &intercepts[i];
+
+    // Traces usually collect only a few intercepts.
+    if (count <= 16)
+    {
+	int j;
+
+	for (i = 1 ; i < count ; i++)
+	{
+	    intercept_t *const in = sortedintercepts[i];
+
+	    for (j = i ; j > 0 && sortedintercepts[j-1]->frac > in->frac ; j--)
+		sortedintercepts[j] = sortedintercepts[j-1];
+
+	    sortedintercepts[j] = in;
+	}
+    }
+    else
+    {
+	qsort(sortedintercepts, count, sizeof(*sortedintercepts),
+	      CompareIntercepts);
+    }
+}
+
+
+//
+// P_TraverseIntercepts
+// Returns true if the traverser function returns true
+// for all lines.
+// [JN] Intercepts are sorted once instead of searching for the
+// closest one on every step. If a traverser starts another trace,
+// e.g. a death state with a hitscan attack, the intercepts have
+// been replaced, so the rest is traversed the original way.
+// 
+boolean
+P_TraverseIntercepts
+( traverser_t	func,
+  fixed_t	maxfrac )
+{
+    const unsigned int	gen = intercepts_gen;
+    const int		count = intercept_p - intercepts;
+    intercept_t*	in;
+    int			i;
+
+    P_SortIntercepts(count);
+
+    for (i = 0 ; i < count ; i++)
+    {
+	in = sortedintercepts[i];
+
+	if (in->frac > maxfrac)
+	    return true;	// checked everything in range
+
+	if ( !func (in) )
+	    return false;	// don't bother going farther
+
+	in->frac = INT_MAX;
+
+	if (intercepts_gen != gen)
+	    return P_TraverseInterceptsLinear(func, maxfrac, count - i - 1);
+    }
+
+    return true;		// everything was traversed
+}
+
+
 // Intercepts Overrun emulation, from PrBoom-plus.
 // Thanks to Andrey Budko (entryway) for researching this and his 
 // implementation of Intercepts Overrun emulation in PrBoom-plus
@@ -1058,6 +1159,7 @@ P_PathTraverse
 		
     validcount++;
     intercept_p = intercepts;
+    intercepts_gen++;
 	
     if ( ((x1-bmaporgx)&(MAPBLOCKSIZE-1)) == 0)
 	x1 += FRACUNIT;	// don't side exactly on a line
@@ -117,6 +117,8 @@ P_SetMobjState
     state_t*	st;
     int	cycle_counter = 0;
 
+    P_DirtyMobj(mobj); // [JN] Game state hash.
+
     do
     {
 	if (state == S_NULL)
@@ -609,6 +611,7 @@ void P_MobjThinker (mobj_t* mobj)
 	|| mobj->momy
 	|| (mobj->flags&MF_SKULLFLY) )
     {
+	P_DirtyMobj (mobj); // [JN] Game state hash.
 	P_XYMovement (mobj);
 
 	// FIXME: decent NOP/NULL/Nil function pointer please.
@@ -649,6 +652,7 @@ void P_MobjThinker (mobj_t* mobj)
     if ( (mobj->z != mobj->floorz)
 	 || mobj->momz )
     {
+	P_DirtyMobj (mobj); // [JN] Game state hash.
 	P_ZMovement (mobj);
 	
 	// FIXME: decent NOP/NULL/Nil function pointer please.
@@ -729,6 +733,66 @@ static const int P_FindDoomedNum (unsigned type)
     return i;
 }
 
+// -----------------------------------------------------------------------------
+// [JN] Mobj pool.
+// Mobjs are allocated from PU_LEVEL pages of MOBJPAGE mobjs, and freed
+// ones are reused first, so the mobjs of a level are packed together
+// instead of being scattered through the zone. The pages are freed with
+// the level by Z_FreeTags, P_InitMobjPool then forgets them.
+// -----------------------------------------------------------------------------
+
+#define MOBJPAGE 128
+
+static mobj_t *mobjpage;      // Current page
+static int     mobjpageused;  // Mobjs taken from the current page
+static mobj_t *mobjfree;      // Freed mobjs, linked by thinker.next
+
+void P_InitMobjPool (void)
+{
+    mobjpage = NULL;
+    mobjpageused = MOBJPAGE;
+    mobjfree = NULL;
+}
+
+// -----------------------------------------------------------------------------
+// P_AllocMobj
+// Returns a cleared mobj, must be added with P_AddThinker.
+// -----------------------------------------------------------------------------
+
+mobj_t *P_AllocMobj (void)
+{
+    mobj_t *mobj;
+
+    if (mobjfree)
+    {
+        mobj = mobjfree;
+        mobjfree = (mobj_t *) mobj->thinker.next;
+    }
+    else
+    {
+        if (mobjpageused == MOBJPAGE)
+        {
+            mobjpage = Z_Malloc(MOBJPAGE * sizeof(*mobjpage), PU_LEVEL, NULL);
+            mobjpageused = 0;
+        }
+        mobj = &mobjpage[mobjpageused++];
+    }
+
+    memset(mobj, 0, sizeof(*mobj));
+    return mobj;
+}
+
+// -----------------------------------------------------------------------------
+// P_FreeMobj
+// Returns a mobj to the pool, it must not be linked anymore.
+// -----------------------------------------------------------------------------
+
+void P_FreeMobj (mobj_t *mobj)
+{
+    mobj->thinker.next = (thinker_t *) mobjfree;
+    mobjfree = mobj;
+}
+
 //
 // P_SpawnMobj
 //
@@ -744,8 +808,7 @@ P_SpawnMobjSafe
     state_t*	st;
     mobjinfo_t*	info;
 	
-    mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
-    memset (mobj, 0, sizeof (*mobj));
+    mobj = P_AllocMobj ();
     info = &mobjinfo[type];
 	
     mobj->type = type;
@@ -858,6 +921,9 @@ void P_RemoveMobj (mobj_t* mobj)
 	
     // unlink from sector and block lists
     P_UnsetThingPosition (mobj);
+
+    // [JN] Take out of the game state hash.
+    P_RemoveMobjHash (mobj);
     
     // stop any playing sound
     S_StopSound (mobj);
@@ -176,6 +176,7 @@ EV_DoPlat
 	    plat->status = up;
 	    // NO MORE DAMAGE, IF APPLICABLE
 	    sec->special = 0;		
+	    P_DirtySector (sec);  // [JN] Game state hash.
 
 	    S_StartSound(&sec->soundorg,sfx_stnmov);
 	    break;
@@ -36,8 +36,13 @@
 #include "id_vars.h"
 
 
-FILE *save_stream;
-int savegamelength;
+// The savegame is serialized into a memory buffer, which is written to
+// disk in one go when complete and read from disk in one go on load.
+
+static byte   *save_buffer;
+static size_t  save_size;    // allocated size of save_buffer
+static size_t  save_length;  // bytes of data in save_buffer
+static size_t  save_pos;     // current read/write position
 boolean savegame_error;
 
 // Get the filename of a temporary file to write the savegame to.  After
@@ -77,13 +82,99 @@ char *P_SaveGameFile(int slot)
     return filename;
 }
 
+// Buffer management
+
+static void saveg_grow(size_t count)
+{
+    if (save_pos + count > save_size)
+    {
+        size_t newsize = save_size ? save_size : 64 * 1024;
+
+        while (save_pos + count > newsize)
+        {
+            newsize *= 2;
+        }
+
+        save_buffer = I_Realloc(save_buffer, newsize);
+        save_size = newsize;
+    }
+}
+
+// Reads the whole savegame file into the buffer.
+// Returns false if the file can not be read.
+
+boolean P_OpenSaveGameRead(const char *filename)
+{
+    FILE *handle;
+    long length;
+
+    handle = M_fopen(filename, "rb");
+
+    if (handle == NULL)
+    {
+        return false;
+    }
+
+    length = M_FileLength(handle);
+    save_pos = 0;
+    save_length = 0;
+
+    if (length > 0)
+    {
+        saveg_grow(length);
+        save_length = fread(save_buffer, 1, length, handle);
+    }
+
+    fclose(handle);
+
+    savegame_error = false;
+
+    return true;
+}
+
+// Makes a savegame held in memory the one to read from.
+
+void P_OpenSaveGameBuffer(const byte *data, size_t length)
+{
+    save_pos = 0;
+    saveg_grow(length);
+    memcpy(save_buffer, data, length);
+    save_length = length;
+
+    savegame_error = false;
+}
+
+// Starts serializing a new savegame into the buffer.
+
+void P_OpenSaveGameWrite(void)
+{
+    save_pos = 0;
+    save_length = 0;
+    savegame_error = false;
+}
+
+// Hands the serialized savegame over to the caller, who has to free() it.
+// The next savegame is serialized into a new buffer.
+
+byte *P_TakeSaveGameBuffer(size_t *length)
+{
+    byte *result = save_buffer;
+
+    *length = save_length;
+
+    save_buffer = NULL;
+    save_size = 0;
+    save_length = 0;
+    save_pos = 0;
+
+    return result;
+}
+
 // Endian-safe integer read/write functions
 
 static byte saveg_read8(void)
 {
-    byte result = -1;
-
-    if (fread(&result, 1, 1, save_stream) < 1)
+    if (save_pos >= save_length)
     {
         if (!savegame_error)
         {
@@ -95,28 +186,32 @@ static byte saveg_read8(void)
 
             savegame_error = true;
         }
+
+        return 0xff;
     }
 
-    return result;
+    return save_buffer[save_pos++];
 }
 
 static void saveg_write8(byte value)
 {
-    if (fwrite(&value, 1, 1, save_stream) < 1)
-    {
-        if (!savegame_error)
-        {
-            fprintf(stderr, "saveg_write8: Error while writing save game\n");
-
-            savegame_error = true;
-        }
-    }
+    saveg_grow(1);
+    save_buffer[save_pos++] = value;
+    save_length = save_pos;
 }
 
 static short saveg_read16(void)
 {
     int result;
 
+    if (save_pos + 2 <= save_length)
+    {
+        const byte *p = save_buffer + save_pos;
+
+        save_pos += 2;
+        return (short) (p[0] | (p[1] << 8));
+    }
+
     result = saveg_read8();
     result |= saveg_read8() << 8;
 
@@ -125,14 +220,29 @@ static short saveg_read16(void)
 
 static void saveg_write16(short value)
 {
-    saveg_write8(value & 0xff);
-    saveg_write8((value >> 8) & 0xff);
+    byte *p;
+
+    saveg_grow(2);
+    p = save_buffer + save_pos;
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+    save_pos += 2;
+    save_length = save_pos;
 }
 
 static int saveg_read32(void)
 {
     int result;
 
+    if (save_pos + 4 <= save_length)
+    {
+        const byte *p = save_buffer + save_pos;
+
+        save_pos += 4;
+        return (int) ((uint32_t) p[0] | ((uint32_t) p[1] << 8)
+                   | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+    }
+
     result = saveg_read8();
     result |= saveg_read8() << 8;
     result |= saveg_read8() << 16;
@@ -143,16 +253,30 @@ static int saveg_read32(void)
 
 static void saveg_write32(int value)
 {
-    saveg_write8(value & 0xff);
-    saveg_write8((value >> 8) & 0xff);
-    saveg_write8((value >> 16) & 0xff);
-    saveg_write8((value >> 24) & 0xff);
+    byte *p;
+
+    saveg_grow(4);
+    p = save_buffer + save_pos;
+    p[0] = value & 0xff;
+    p[1] = (value >> 8) & 0xff;
+    p[2] = (value >> 16) & 0xff;
+    p[3] = (value >> 24) & 0xff;
+    save_pos += 4;
+    save_length = save_pos;
 }
 
 int64_t saveg_read64(void)
 {
     int64_t result;
 
+    if (save_pos + 8 <= save_length)
+    {
+        const uint32_t lo = (uint32_t) saveg_read32();
+        const uint32_t hi = (uint32_t) saveg_read32();
+
+        return (int64_t) (((uint64_t) hi << 32) | lo);
+    }
+
     result = saveg_read8();
     result |= saveg_read8() << 8;
     result |= saveg_read8() << 16;
@@ -167,28 +291,17 @@ int64_t saveg_read64(void)
 
 void saveg_write64(int64_t value)
 {
-    saveg_write8(value & 0xff);
-    saveg_write8((value >> 8) & 0xff);
-    saveg_write8((value >> 16) & 0xff);
-    saveg_write8((value >> 24) & 0xff);
-    saveg_write8((value >> 32) & 0xff);
-    saveg_write8((value >> 40) & 0xff);
-    saveg_write8((value >> 48) & 0xff);
-    saveg_write8((value >> 56) & 0xff);
+    saveg_write32((int) (value & 0xffffffff));
+    saveg_write32((int) ((value >> 32) & 0xffffffff));
 }
 
 // Pad to 4-byte boundaries
 
 static void saveg_read_pad(void)
 {
-    unsigned long pos;
-    int padding;
+    const int padding = (4 - (save_pos & 3)) & 3;
     int i;
 
-    pos = ftell(save_stream);
-
-    padding = (4 - (pos & 3)) & 3;
-
     for (i=0; i<padding; ++i)
     {
         saveg_read8();
@@ -197,14 +310,9 @@ static void saveg_read_pad(void)
 
 static void saveg_write_pad(void)
 {
-    unsigned long pos;
-    int padding;
+    const int padding = (4 - (save_pos & 3)) & 3;
     int i;
 
-    pos = ftell(save_stream);
-
-    padding = (4 - (pos & 3)) & 3;
-
     for (i=0; i<padding; ++i)
     {
         saveg_write8(0);
@@ -1684,6 +1792,9 @@ void P_UnArchiveWorld (void)
 	    sec->ceilingpic = ceilingpic;
 	}
     }
+
+    // [JN] Tags were read again.
+    P_InitTagLists ();
     
     // do lines
     for (i=0, li = lines ; i<numlines ; i++,li++)
@@ -1726,6 +1837,8 @@ typedef enum
 void P_ArchiveThinkers (void)
 {
     thinker_t*		th;
+    // [JN] Index the thinkers, unless the caller already did.
+    const boolean	indexed = P_IndexThinkers(true);
 
     // save off the current thinkers
     for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
@@ -1744,6 +1857,11 @@ void P_ArchiveThinkers (void)
 
     // add a terminating marker
     saveg_write8(tc_end);
+
+    if (!indexed)
+    {
+        P_IndexThinkers(false);
+    }
 }
 
 
@@ -1767,7 +1885,7 @@ void P_UnArchiveThinkers (void)
 	if (currentthinker->function.acp1 == (actionf_p1)P_MobjThinker)
 	    P_RemoveMobj ((mobj_t *)currentthinker);
 	else
-	    Z_Free (currentthinker);
+	    P_FreeThinker (currentthinker);
 
 	currentthinker = next;
     }
@@ -1784,7 +1902,7 @@ void P_UnArchiveThinkers (void)
 			
 	  case tc_mobj:
 	    saveg_read_pad();
-	    mobj = Z_Malloc (sizeof(*mobj), PU_LEVEL, NULL);
+	    mobj = P_AllocMobj ();
             saveg_read_mobj_t(mobj);
 
 	    P_SetThingPosition (mobj);
@@ -2111,86 +2229,166 @@ void P_UnArchiveTotalTimes (void)
 }
 
 // -----------------------------------------------------------------------------
-// [crispy] enumerate all thinker pointers
+// [JN] Index of mobj thinkers, sorted by address. While it is built,
+// P_ThinkerToIndex is a binary search instead of a walk through the whole
+// thinker list, which otherwise makes archiving of targets and tracers
+// quadratic in the number of mobjs.
 // -----------------------------------------------------------------------------
 
-static int restoretargets_fail = 0;
+typedef struct
+{
+    const thinker_t *thinker;
+    uint32_t         index;
+} thinkerindex_t;
 
-const uint32_t P_ThinkerToIndex (const thinker_t *thinker)
+static thinkerindex_t *thinkerindex;
+static int             numthinkerindex;
+static int             maxthinkerindex;
+static boolean         thinkerindex_valid;
+
+static int CompareThinkerIndex (const void *a, const void *b)
+{
+    const thinker_t *const ta = ((const thinkerindex_t *) a)->thinker;
+    const thinker_t *const tb = ((const thinkerindex_t *) b)->thinker;
+
+    return ta < tb ? -1 : ta > tb;
+}
+
+boolean P_IndexThinkers (boolean enable)
 {
+    const boolean was_valid = thinkerindex_valid;
     thinker_t *th;
     uint32_t   i;
 
-    if (!thinker)
+    thinkerindex_valid = false;
+    numthinkerindex = 0;
+
+    if (!enable)
     {
-        return 0;
+        return was_valid;
     }
 
     for (th = thinkercap.next, i = 1 ; th != &thinkercap ; th = th->next, i++)
     {
         if (th->function.acp1 == (actionf_p1) P_MobjThinker)
         {
-            if (th == thinker)
+            if (numthinkerindex == maxthinkerindex)
             {
-                return i;
+                maxthinkerindex = maxthinkerindex ? 2 * maxthinkerindex : 1024;
+                thinkerindex = I_Realloc(thinkerindex,
+                                         maxthinkerindex * sizeof(*thinkerindex));
             }
+
+            thinkerindex[numthinkerindex].thinker = th;
+            thinkerindex[numthinkerindex].index = i;
+            numthinkerindex++;
         }
     }
 
-    return 0;
+    qsort(thinkerindex, numthinkerindex, sizeof(*thinkerindex),
+          CompareThinkerIndex);
+    thinkerindex_valid = true;
+
+    return was_valid;
 }
 
 // -----------------------------------------------------------------------------
-// [crispy] replace indizes with corresponding pointers
+// [crispy] enumerate all thinker pointers
 // -----------------------------------------------------------------------------
 
-static thinker_t *P_IndexToThinker (uint32_t index)
+static int restoretargets_fail = 0;
+
+const uint32_t P_ThinkerToIndex (const thinker_t *thinker)
 {
     thinker_t *th;
     uint32_t   i;
 
-    if (!index)
+    if (!thinker)
     {
-        return NULL;
+        return 0;
+    }
+
+    if (thinkerindex_valid)
+    {
+        thinkerindex_t key, *found;
+
+        key.thinker = thinker;
+        found = bsearch(&key, thinkerindex, numthinkerindex,
+                        sizeof(*thinkerindex), CompareThinkerIndex);
+
+        return found ? found->index : 0;
     }
 
     for (th = thinkercap.next, i = 1 ; th != &thinkercap ; th = th->next, i++)
     {
         if (th->function.acp1 == (actionf_p1) P_MobjThinker)
         {
-            if (i == index)
+            if (th == thinker)
             {
-                return th;
+                return i;
             }
         }
     }
 
-    restoretargets_fail++;
-
-    return NULL;
+    return 0;
 }
 
 // -----------------------------------------------------------------------------
 // [crispy] after all the thinkers have been restored, replace all indices in
 // the mobj->target and mobj->tracers fields by the corresponding current pointers again
+// [JN] Thinkers are numbered once up front, instead of walking the list
+// for every index.
 // -----------------------------------------------------------------------------
 
+static thinker_t *P_IndexToThinker (thinker_t **bynumber, uint32_t count,
+                                    uint32_t index)
+{
+    if (!index)
+    {
+        return NULL;
+    }
+
+    if (index < count && bynumber[index])
+    {
+        return bynumber[index];
+    }
+
+    restoretargets_fail++;
+
+    return NULL;
+}
+
 void P_RestoreTargets (void)
 {
-    mobj_t    *mo;
-    thinker_t *th;
-    uint32_t   i;
+    mobj_t     *mo;
+    thinker_t  *th;
+    thinker_t **bynumber;
+    uint32_t    i, count;
+
+    for (th = thinkercap.next, count = 1 ; th != &thinkercap ; th = th->next)
+    {
+        count++;
+    }
+
+    bynumber = malloc(count * sizeof(*bynumber));
 
     for (th = thinkercap.next, i = 1 ; th != &thinkercap ; th = th->next, i++)
+    {
+        bynumber[i] = th->function.acp1 == (actionf_p1) P_MobjThinker ? th : NULL;
+    }
+
+    for (th = thinkercap.next ; th != &thinkercap ; th = th->next)
     {
         if (th->function.acp1 == (actionf_p1) P_MobjThinker)
         {
             mo = (mobj_t*) th;
-            mo->target = (mobj_t*) P_IndexToThinker((uintptr_t) mo->target);
-            mo->tracer = (mobj_t*) P_IndexToThinker((uintptr_t) mo->tracer);
+            mo->target = (mobj_t*) P_IndexToThinker(bynumber, count, (uintptr_t) mo->target);
+            mo->tracer = (mobj_t*) P_IndexToThinker(bynumber, count, (uintptr_t) mo->tracer);
         }
     }
 
+    free(bynumber);
+
     if (restoretargets_fail)
     {
         printf ("P_RestoreTargets: Failed to restore %d target thinkers.\n",
@@ -1444,6 +1444,8 @@ P_SetupLevel
     S_Start ();			
 
     Z_FreeTags (PU_LEVEL, PU_PURGELEVEL-1);
+    P_InitMobjPool ();
+    P_ClearSightCache ();
 
     // UNUSED W_Profile ();
     P_InitThinkers ();
@@ -1462,6 +1464,11 @@ P_SetupLevel
     }
 
     lumpnum = W_GetNumForName (lumpname);
+    // [JN] Let the map lumps be read from memory-mapped WAD in background.
+    W_PrefetchLumps(lumpnum, ML_BLOCKMAP + 1);
+
+    // [JN] Log memory left after the previous level, if -zonestats is given.
+    Z_LogStats(lumpname);
 	
     // [JN] Checking for multiple map lump names for allowing map fixes to work.
     // Adaptaken from DOOM Retro, thanks Brad Harding!
@@ -1521,6 +1528,7 @@ P_SetupLevel
     }
 
     P_GroupLines ();
+    P_InitTagLists ();
     P_LoadReject (lumpnum+ML_REJECT);
 
     // [crispy] remove slime trails
@@ -1562,6 +1570,9 @@ P_SetupLevel
     // [JN] Set level name.
     P_LevelNameInit();
 
+    // [JN] Hash the new level for the game state hash.
+    P_ResetStateHash();
+
     // [JN] Force to disable spectator mode.
     crl_spectating = 0;
 
@@ -1581,6 +1592,8 @@ void P_Init (void)
 {
     P_InitSwitchList ();
     P_InitPicAnims ();
+    P_InitBrightmapAnims ();
+    P_InitSightCache ();
     R_InitSprites (sprnames);
 }
 
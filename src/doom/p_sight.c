@@ -22,6 +22,7 @@
 #include "doomstat.h"
 
 #include "i_system.h"
+#include "m_argv.h"
 #include "p_local.h"
 
 
@@ -39,6 +40,87 @@ fixed_t		t2y;
 int		sightcounts[2];
 
 
+// -----------------------------------------------------------------------------
+// [JN] Line of sight cache.
+// Monsters check sight to the same target many times per tic, e.g.
+// A_Chase and P_CheckMissileRange of one actor, or P_RadiusAttack on
+// every explosion. Results of the BSP traversal are remembered until
+// the next tic or until any sector height changes, see T_MovePlane.
+// The result depends on exact positions, not just on subsectors, so
+// the key is the eye point of the looker and the target's box.
+// -----------------------------------------------------------------------------
+
+#define SIGHTCACHE 512
+
+typedef struct
+{
+    fixed_t  x1, y1, z1;   // Eye of the looker
+    fixed_t  x2, y2;       // Target
+    fixed_t  bottom, top;
+    unsigned gen;
+    boolean  result;
+} sightcache_t;
+
+static sightcache_t sightcache[SIGHTCACHE];
+static unsigned     sightgen = 1;
+static boolean      nosightcache;
+static boolean      sightcachecheck;
+
+// Demo sync test of the cache, with a list of demos:
+//
+//   -demobatch <list> -nosightcache -demobatch_report <ref>
+//   -demobatch <ref> -sightcachecheck
+//
+// The first run stores state hashes of the demos ended without the
+// cache, the second one reports every demo ending with another hash
+// as DESYNC, and every demo with a wrong cache hit as FAILED.
+
+void P_InitSightCache (void)
+{
+    //!
+    // @category obscure
+    //
+    // Disable caching of line of sight checks, for comparing
+    // -framehash results of demos with and without the cache.
+    //
+
+    nosightcache = M_ParmExists("-nosightcache");
+
+    //!
+    // @category obscure
+    //
+    // Check every cached line of sight against the BSP traversal,
+    // quit with an error on the first one giving another result.
+    //
+
+    sightcachecheck = M_ParmExists("-sightcachecheck");
+}
+
+void P_ClearSightCache (void)
+{
+    if (++sightgen == 0)
+    {
+        memset(sightcache, 0, sizeof(sightcache));
+        sightgen = 1;
+    }
+}
+
+static sightcache_t *P_SightCacheSlot (fixed_t x1, fixed_t y1, fixed_t z1,
+                                       fixed_t x2, fixed_t y2,
+                                       fixed_t bottom, fixed_t top)
+{
+    unsigned hash = (unsigned) x1 * 0x9e3779b1u;
+
+    hash = (hash ^ (unsigned) y1) * 0x85ebca6bu;
+    hash = (hash ^ (unsigned) z1) * 0xc2b2ae35u;
+    hash = (hash ^ (unsigned) x2) * 0x9e3779b1u;
+    hash = (hash ^ (unsigned) y2) * 0x85ebca6bu;
+    hash = (hash ^ (unsigned) bottom ^ ((unsigned) top << 7)) * 0xc2b2ae35u;
+
+    return &sightcache[(hash >> 16) % SIGHTCACHE];
+}
+
+
 // PTR_SightTraverse() for Doom 1.2 sight calculations
 // taken from prboom-plus/src/p_sight.c:69-102
 boolean PTR_SightTraverse(intercept_t *in)
@@ -379,6 +461,48 @@ P_CheckSight
                               PT_EARLYOUT | PT_ADDLINES, PTR_SightTraverse);
     }
 
+    // [JN] A cache hit leaves topslope, bottomslope and line validcounts
+    // as they are, these are always reset before the next use.
+    if (!nosightcache)
+    {
+        const fixed_t top = t2->z + t2->height;
+        sightcache_t *const c = P_SightCacheSlot(t1->x, t1->y, sightzstart,
+                                                 t2->x, t2->y, t2->z, top);
+
+        strace.x = t1->x;
+        strace.y = t1->y;
+        t2x = t2->x;
+        t2y = t2->y;
+        strace.dx = t2->x - t1->x;
+        strace.dy = t2->y - t1->y;
+
+        if (c->gen == sightgen
+        &&  c->x1 == t1->x && c->y1 == t1->y && c->z1 == sightzstart
+        &&  c->x2 == t2->x && c->y2 == t2->y
+        &&  c->bottom == t2->z && c->top == top)
+        {
+            if (sightcachecheck && P_CrossBSPNode(numnodes - 1) != c->result)
+            {
+                I_Error("P_CheckSight: cached line of sight is out of sync "
+                        "at tic %d", gametic);
+            }
+
+            return c->result;
+        }
+
+        c->x1 = t1->x;
+        c->y1 = t1->y;
+        c->z1 = sightzstart;
+        c->x2 = t2->x;
+        c->y2 = t2->y;
+        c->bottom = t2->z;
+        c->top = top;
+        c->gen = sightgen;
+        c->result = P_CrossBSPNode(numnodes - 1);
+
+        return c->result;
+    }
+
     strace.x = t1->x;
     strace.y = t1->y;
     t2x = t2->x;
@@ -175,7 +175,6 @@ line_t *linespeciallist[MAXLINEANIMS];
 void P_InitPicAnims (void)
 {
     int		i;
-    boolean init_swirl = false;
 
     // [crispy] add support for ANIMATED lumps
     animdef_t *animdefs;
@@ -231,12 +230,8 @@ void P_InitPicAnims (void)
 	lastanim->speed = from_lump ? LONG(animdefs[i].speed) : animdefs[i].speed;
 
 	// [crispy] add support for SMMU swirling flats
-	if (lastanim->speed > 65535 || lastanim->numpics == 1)
-	{
-		init_swirl = true;
-	}
-	else
-	if (lastanim->numpics < 2)
+	// [JN] Distorted flats are made on demand by R_DistortedFlat.
+	if (lastanim->speed <= 65535 && lastanim->numpics < 1)
 	{
 	    // [crispy] make non-fatal, skip invalid animation sequences
 	    fprintf (stderr, "P_InitPicAnims: bad cycle from %s to %s\n",
@@ -251,11 +246,6 @@ void P_InitPicAnims (void)
     {
 	W_ReleaseLumpName("ANIMATED");
     }
-
-    if (init_swirl)
-    {
-	R_InitDistortedFlats();
-    }
 }
 
 
@@ -522,6 +512,61 @@ fixed_t	P_FindHighestCeilingSurrounding(sector_t* sec)
 
 
 
+//
+// P_InitTagLists
+// [JN] killough 1/30/98: hash sectors by tag, so finding the sectors
+// of a tag does not scan all of them. Chains are built backwards,
+// so sectors are found in ascending order, like the linear search did.
+//
+void P_InitTagLists (void)
+{
+    int i;
+
+    for (i = numsectors ; --i >= 0 ; )
+	sectors[i].firsttag = -1;
+
+    for (i = numsectors ; --i >= 0 ; )
+    {
+	const int j = (unsigned) sectors[i].tag % (unsigned) numsectors;
+
+	sectors[i].nexttag = sectors[j].firsttag;
+	sectors[j].firsttag = i;
+    }
+}
+
+
+//
+// RETURN NEXT SECTOR # THAT TAG REFERS TO
+// [JN] Like the linear search, returns the first sector after start,
+// which does not need to have this tag: EV_BuildStairs passes the
+// last stair step it raised.
+//
+int
+P_FindSectorFromTag
+( int		tag,
+  int		start )
+{
+    int		i;
+
+    if (start >= 0 && sectors[start].tag == tag)
+    {
+	i = sectors[start].nexttag;
+    }
+    else
+    {
+	i = sectors[(unsigned) tag % (unsigned) numsectors].firsttag;
+
+	while (i >= 0 && i <= start)
+	    i = sectors[i].nexttag;
+    }
+
+    while (i >= 0 && sectors[i].tag != tag)
+	i = sectors[i].nexttag;
+
+    return i;
+}
+
+
 //
 // RETURN NEXT SECTOR # THAT LINE TAG REFERS TO
 //
@@ -530,8 +575,6 @@ P_FindSectorFromLineTag
 ( line_t*	line,
   int		start )
 {
-    int	i;
-	
     // [crispy] emit a warning for linedefs without tags
     if (!line->tag)
     {
@@ -539,11 +582,7 @@ P_FindSectorFromLineTag
         fprintf(stderr, "P_FindSectorFromLineTag: Linedef %ld without tag\n", linedef);
     }
 
-    for (i=start+1;i<numsectors;i++)
-	if (sectors[i].tag == line->tag)
-	    return i;
-    
-    return -1;
+    return P_FindSectorFromTag(line->tag, start);
 }
 
 
@@ -1141,6 +1180,9 @@ void P_PlayerInSpecialSector (player_t* player)
     if (player->mo->z != sector->floorheight)
 	return;	
 
+    // [JN] Game state hash: secrets clear sector special.
+    P_DirtySector (sector);
+
     // Has hitten ground.
     switch (sector->special)
     {
@@ -1692,14 +1734,11 @@ void P_SpawnSpecials (void)
 	  case 271:
 	  case 272:
 	    {
-		int secnum;
+		int secnum = -1;
 
-		for (secnum = 0; secnum < numsectors; secnum++)
+		while ((secnum = P_FindSectorFromTag(lines[i].tag, secnum)) >= 0)
 		{
-		    if (sectors[secnum].tag == lines[i].tag)
-		    {
-			sectors[secnum].sky = i | PL_SKYFLAT;
-		    }
+		    sectors[secnum].sky = i | PL_SKYFLAT;
 		}
 	    }
 	    break;
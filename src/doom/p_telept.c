@@ -54,13 +54,14 @@ EV_Teleport
 
     
     tag = line->tag;
-    for (i = 0; i < numsectors; i++)
+    i = -1;
+    while ((i = P_FindSectorFromTag(tag, i)) >= 0)
     {
 	if (sectors[ i ].tag == tag )
 	{
-	    for (thinker = thinkercap.next;
-		 thinker != &thinkercap;
-		 thinker = thinker->next)
+	    for (thinker = thinklistcap[th_mobj].cnext;
+		 thinker != &thinklistcap[th_mobj];
+		 thinker = thinker->cnext)
 	    {
 		// not a mobj
 		if (thinker->function.acp1 != (actionf_p1)P_MobjThinker)
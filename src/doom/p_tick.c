@@ -48,13 +48,69 @@ int	leveltime;
 // Both the head and tail of the thinker list.
 thinker_t	thinkercap;
 
+// [JN] Both the head and tail of the thinker class lists.
+thinker_t	thinklistcap[NUMTHINKLISTS];
+
 
 //
 // P_InitThinkers
 //
 void P_InitThinkers (void)
 {
+    int i;
+
     thinkercap.prev = thinkercap.next  = &thinkercap;
+
+    for (i = 0; i < NUMTHINKLISTS; i++)
+    {
+        thinklistcap[i].cprev = thinklistcap[i].cnext = &thinklistcap[i];
+    }
+
+    // [JN] Mobjs of the previous level are gone.
+    P_ClearStateHash();
+}
+
+
+//
+// [JN] Brightmap animation flags of states, for P_RunThinkers.
+//
+
+#define BMAP_FLICK  1   // random brightmap flickering
+#define BMAP_GLOW   2   // smooth brightmap glowing
+
+static byte bmapanim[NUMSTATES];
+
+void P_InitBrightmapAnims (void)
+{
+    int i;
+
+    for (i = 0; i < NUMSTATES; i++)
+    {
+        switch (states[i].sprite)
+        {
+            case SPR_CAND:  // Candestick
+            case SPR_CBRA:  // Candelabra
+            case SPR_TBLU:  // Tall Blue Torch
+            case SPR_TGRN:  // Tall Green Torch
+            case SPR_TRED:  // Tall Red Torch
+            case SPR_SMBT:  // Short Blue Torch
+            case SPR_SMGT:  // Short Green Torch
+            case SPR_SMRT:  // Short Red Torch
+            case SPR_POL3:  // Pile of Skulls and Candles
+                bmapanim[i] = BMAP_FLICK;
+                break;
+            case SPR_FCAN:  // Flaming Barrel
+                bmapanim[i] = BMAP_FLICK | BMAP_GLOW;
+                break;
+            case SPR_CEYE:  // Evil Eye
+            case SPR_FSKU:  // Floating Skull Rock
+                bmapanim[i] = BMAP_GLOW;
+                break;
+            default:
+                bmapanim[i] = 0;
+                break;
+        }
+    }
 }
 
 
@@ -63,13 +119,26 @@ void P_InitThinkers (void)
 //
 // P_AddThinker
 // Adds a new thinker at the end of the list.
+// [JN] And at the end of its class list: mobjs get their
+// function before being added, other thinkers after it.
+// Mobjs are allocated by P_AllocMobj, other thinkers by Z_Malloc.
 //
 void P_AddThinker (thinker_t* thinker)
 {
+    const boolean mobj = thinker->function.acp1 == (actionf_p1) P_MobjThinker;
+    thinker_t *const cap = &thinklistcap[mobj ? th_mobj : th_misc];
+
+    thinker->pooled = mobj;
+
     thinkercap.prev->next = thinker;
     thinker->next = &thinkercap;
     thinker->prev = thinkercap.prev;
     thinkercap.prev = thinker;
+
+    cap->cprev->cnext = thinker;
+    thinker->cnext = cap;
+    thinker->cprev = cap->cprev;
+    cap->cprev = thinker;
 }
 
 
@@ -87,6 +156,25 @@ void P_RemoveThinker (thinker_t* thinker)
 
 
 
+//
+// P_FreeThinker
+// [JN] Frees a thinker which is no longer linked,
+// mobjs are returned to the mobj pool.
+//
+void P_FreeThinker (thinker_t* thinker)
+{
+    if (thinker->pooled)
+    {
+        P_FreeMobj((mobj_t *) thinker);
+    }
+    else
+    {
+        Z_Free(thinker);
+    }
+}
+
+
+
 //
 // P_RunThinkers
 //
@@ -118,24 +206,15 @@ void P_RunThinkers (void)
 	    {
 	        if (bmap_count_common == 1)
 	        {
+	            const int flags = bmapanim[mo->state - states];
+
 	            // [JN] Random brightmap flickering effect.
-	            if (mo->sprite == SPR_CAND  // Candestick
-	            ||  mo->sprite == SPR_CBRA  // Candelabra
-	            ||  mo->sprite == SPR_FCAN  // Flaming Barrel
-	            ||  mo->sprite == SPR_TBLU  // Tall Blue Torch
-	            ||  mo->sprite == SPR_TGRN  // Tall Green Torch
-	            ||  mo->sprite == SPR_TRED  // Tall Red Torch
-	            ||  mo->sprite == SPR_SMBT  // Short Blue Torch
-	            ||  mo->sprite == SPR_SMGT  // Short Green Torch
-	            ||  mo->sprite == SPR_SMRT  // Short Red Torch
-	            ||  mo->sprite == SPR_POL3) // Pile of Skulls and Candles
+	            if (flags & BMAP_FLICK)
 	            {
 	                mo->bmap_flick = ID_RealRandom() % 16;
 	            }
 	            // [JN] Smooth brightmap glowing effect.
-	            if (mo->sprite == SPR_FCAN  // Flaming Barrel
-	            ||  mo->sprite == SPR_CEYE  // Evil Eye
-	            ||  mo->sprite == SPR_FSKU) // Floating Skull Rock
+	            if (flags & BMAP_GLOW)
 	            {
 	                mo->bmap_glow = ID_RealRandom() % 6;
 	            }
@@ -154,7 +233,9 @@ void P_RunThinkers (void)
             nextthinker = currentthinker->next;
 	    currentthinker->next->prev = currentthinker->prev;
 	    currentthinker->prev->next = currentthinker->next;
-	    Z_Free(currentthinker);
+	    currentthinker->cnext->cprev = currentthinker->cprev;
+	    currentthinker->cprev->cnext = currentthinker->cnext;
+	    P_FreeThinker(currentthinker);
 	}
 	else
 	{
@@ -208,6 +289,9 @@ void P_Ticker (void)
     }
     
 		
+    // [JN] Mobjs have moved since the last tic.
+    P_ClearSightCache ();
+
     for (i=0 ; i<MAXPLAYERS ; i++)
 	if (playeringame[i])
 	    P_PlayerThink (&players[i]);
@@ -368,6 +368,9 @@ void P_PlayerThink (player_t* player)
 {
     ticcmd_t*		cmd;
     weapontype_t	newweapon;
+
+    // [JN] Game state hash: players change every tic.
+    P_DirtyMobj (player->mo);
 	
     // [AM] Assume we can interpolate at the beginning
     //      of the tic.
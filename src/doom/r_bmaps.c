@@ -30,7 +30,7 @@
 // [crispy] brightmap data
 // -----------------------------------------------------------------------------
 
-static const byte nobrightmap[256] = {0};
+const byte nobrightmap[256] = {0};
 
 static const byte fullbright[256] = {
     1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
@@ -391,7 +391,7 @@ static const byte light_sources[256] =
     1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
 };
 
-const byte *dc_brightmap = nobrightmap;
+THREADLOCAL const byte *dc_brightmap = nobrightmap;
 
 // -----------------------------------------------------------------------------
 // [crispy] brightmaps for textures
@@ -28,11 +28,11 @@
 #include "id_vars.h"
 
 
-seg_t     *curline;
-side_t    *sidedef;
-line_t    *linedef;
-sector_t  *frontsector;
-sector_t  *backsector;
+THREADLOCAL seg_t     *curline;
+THREADLOCAL side_t    *sidedef;
+THREADLOCAL line_t    *linedef;
+THREADLOCAL sector_t  *frontsector;
+THREADLOCAL sector_t  *backsector;
 
 // [JN] killough: New code which removes 2s linedef limit
 drawseg_t *drawsegs;
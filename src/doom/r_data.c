@@ -22,6 +22,7 @@
 #include "deh_main.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "z_zone.h"
 #include "w_wad.h"
 #include "m_misc.h"
@@ -321,13 +322,24 @@ static void R_GenerateComposite (int texnum)
 	
     texture = textures[texnum];
 
+    // [JN] Render threads may ask for the same texture at once. Build it
+    // under the cache lock and hand out the pointers only once it's done,
+    // so nobody gets to read a half-built composite.
+    I_LockCache();
+
+    if (texturecomposite[texnum] && texturecomposite2[texnum])
+    {
+        I_UnlockCache();
+        return;
+    }
+
     block = Z_Malloc (texturecompositesize[texnum],
 		      PU_STATIC, 
-		      &texturecomposite[texnum]);	
+		      NULL);	
     // [crispy] memory block for opaque textures
     block2 = Z_Malloc (texture->width * texture->height,
 		      PU_STATIC,
-		      &texturecomposite2[texnum]);
+		      NULL);
 
     collump = texturecolumnlump[texnum];
     colofs = texturecolumnofs[texnum];
@@ -440,10 +452,15 @@ static void R_GenerateComposite (int texnum)
     free(source); // free temporary column
     free(marks); // free transparency marks
 
+    Z_ChangeUser (block, (void **) &texturecomposite[texnum]);
+    Z_ChangeUser (block2, (void **) &texturecomposite2[texnum]);
+
     // Now that the texture has been built in column cache,
     //  it is purgable from zone memory.
     Z_ChangeTag (block, PU_CACHE);
     Z_ChangeTag (block2, PU_CACHE);
+
+    I_UnlockCache();
 }
 
 
@@ -626,6 +643,32 @@ void R_GenerateLookup (int texnum)
 
 
 
+//
+// [JN] R_CacheComposite
+// Render threads may purge or build composites at any time, so they
+// are looked up and pinned for the frame under the cache lock.
+//
+static byte *R_CacheComposite (byte **composites, int tex)
+{
+    byte *composite;
+
+    I_LockCache();
+
+    if (!composites[tex])
+    {
+	// [JN] Queued columns may use purgable composites.
+	R_FlushColumns ();
+	R_GenerateComposite (tex);
+    }
+
+    composite = composites[tex];
+    Z_PinBlock(composite);
+
+    I_UnlockCache();
+
+    return composite;
+}
+
 //
 // R_GetColumn
 //
@@ -639,10 +682,7 @@ R_GetColumn
     col &= texturewidthmask[tex];
     ofs = texturecolumnofs2[tex][col];
 
-    if (!texturecomposite2[tex])
-	R_GenerateComposite (tex);
-
-    return texturecomposite2[tex] + ofs;
+    return R_CacheComposite(texturecomposite2, tex) + ofs;
 }
 
 // [crispy] wrapping column getter function for composited translucent mid-textures on 2S walls
@@ -659,10 +699,7 @@ R_GetColumnMod
     col %= texturewidth[tex];
     ofs = texturecolumnofs[tex][col];
 
-    if (!texturecomposite[tex])
-	R_GenerateComposite (tex);
-
-    return texturecomposite[tex] + ofs;
+    return R_CacheComposite(texturecomposite, tex) + ofs;
 }
 
 // [FG] wrapping column getter function for non-power-of-two wide sky textures
@@ -679,10 +716,7 @@ R_GetColumnMod2
     col %= texturewidth[tex];
     ofs = texturecolumnofs2[tex][col];
 
-    if (!texturecomposite2[tex])
-	R_GenerateComposite(tex);
-
-    return texturecomposite2[tex] + ofs;
+    return R_CacheComposite(texturecomposite2, tex) + ofs;
 }
 
 
@@ -1586,7 +1620,7 @@ void R_PrecacheLevel (void)
     {
         thinker_t *th;
 
-        for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+        for (th = thinklistcap[th_mobj].cnext ; th != &thinklistcap[th_mobj] ; th = th->cnext)
         {
             if (th->function.acp1 == (actionf_p1)P_MobjThinker)
             {
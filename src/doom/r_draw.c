@@ -22,10 +22,13 @@
 
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "doomdef.h"
 #include "deh_main.h"
+#include "i_simd.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "z_zone.h"
 #include "w_wad.h"
 #include "r_local.h"
@@ -75,17 +78,17 @@ static pixel_t *background_buffer = NULL;
 // Source is the top of the column to scale.
 //
 
-lighttable_t *dc_colormap[2]; // [crispy] brightmaps
-int dc_x;
-int dc_yl;
-int dc_yh;
-int dc_texheight; // [crispy] Tutti-Frutti fix
-fixed_t dc_iscale;
-fixed_t dc_texturemid;
+THREADLOCAL lighttable_t *dc_colormap[2]; // [crispy] brightmaps
+THREADLOCAL int dc_x;
+THREADLOCAL int dc_yl;
+THREADLOCAL int dc_yh;
+THREADLOCAL int dc_texheight; // [crispy] Tutti-Frutti fix
+THREADLOCAL fixed_t dc_iscale;
+THREADLOCAL fixed_t dc_texturemid;
 
 // first pixel in a column (possibly virtual) 
-byte *dc_source;
-byte *dc_translation;
+THREADLOCAL byte *dc_source;
+THREADLOCAL byte *dc_translation;
 byte *translationtables;
 
 
@@ -155,15 +158,9 @@ void R_DrawColumn(void)
     {
         // [PN] For power-of-two textures, we can use bitmask &heightmask.
         // heightmask is dc_texheight-1, ensuring wrap with &heightmask
-        for (int i = 0; i <= count; i++)
-        {
-            const unsigned s = sourcebase[(frac >> FRACBITS) & heightmask];
-            const unsigned index = brightmap[s] ? colormap1[s] : colormap0[s];
-
-            *dest = index;
-            dest += screenwidth;
-            frac += fracstep;
-        }
+        // [JN] Drawn by SIMD kernel, see i_simd.c.
+        I_DrawColumnPixels(dest, screenwidth, count + 1, frac, fracstep,
+                           sourcebase, heightmask, brightmap, colormap0, colormap1);
     }
 }
 
@@ -238,6 +235,542 @@ void R_DrawColumnLow(void)
     }
 }
 
+// -----------------------------------------------------------------------------
+// R_DrawColumnPlain
+// [JN] Brightmap-free version of R_DrawColumn. Used for columns without
+// brightmap, or with both colormaps being the same (fixed colormap or
+// brightmaps disabled), so only dc_colormap[0] is looked up.
+// -----------------------------------------------------------------------------
+
+void R_DrawColumnPlain (void)
+{
+    const int count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    pixel_t *dest = ylookup[dc_yl] + columnofs[flipviewwidth[dc_x]];
+
+    const fixed_t fracstep = dc_iscale;
+    fixed_t frac = dc_texturemid + (dc_yl - centery) * fracstep;
+
+    const byte *const sourcebase = dc_source;
+    const pixel_t *const colormap = dc_colormap[0];
+    const int screenwidth = SCREENWIDTH;
+
+    int heightmask = dc_texheight - 1;
+
+    if (dc_texheight & heightmask)
+    {
+        heightmask = (dc_texheight << FRACBITS);
+        frac = ((frac % heightmask) + heightmask) % heightmask;
+
+        for (int i = 0; i <= count; i++)
+        {
+            *dest = colormap[sourcebase[frac >> FRACBITS]];
+            dest += screenwidth;
+            frac = (frac + fracstep) % heightmask;
+        }
+    }
+    else
+    {
+        I_DrawColumnPixelsPlain(dest, screenwidth, count + 1, frac, fracstep,
+                                sourcebase, heightmask, colormap);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_DrawColumnPlainLow
+// [JN] Brightmap-free version of R_DrawColumnLow.
+// -----------------------------------------------------------------------------
+
+void R_DrawColumnPlainLow (void)
+{
+    const int count = dc_yh - dc_yl;
+
+    if (count < 0)
+        return;
+
+    const int x = dc_x << 1;
+
+    pixel_t *dest = ylookup[dc_yl] + columnofs[flipviewwidth[x]];
+    pixel_t *dest2 = ylookup[dc_yl] + columnofs[flipviewwidth[x + 1]];
+
+    const fixed_t fracstep = dc_iscale;
+    fixed_t frac = dc_texturemid + (dc_yl - centery) * fracstep;
+
+    const byte *const sourcebase = dc_source;
+    const pixel_t *const colormap = dc_colormap[0];
+    const int screenwidth = SCREENWIDTH;
+
+    int heightmask = dc_texheight - 1;
+
+    if (dc_texheight & heightmask)
+    {
+        heightmask = (dc_texheight << FRACBITS);
+        frac = ((frac % heightmask) + heightmask) % heightmask;
+
+        for (int i = 0; i <= count; i++)
+        {
+            *dest = *dest2 = colormap[sourcebase[frac >> FRACBITS]];
+            dest += screenwidth;
+            dest2 += screenwidth;
+            frac = (frac + fracstep) % heightmask;
+        }
+    }
+    else
+    {
+        for (int i = 0; i <= count; i++)
+        {
+            *dest = *dest2 = colormap[sourcebase[(frac >> FRACBITS) & heightmask]];
+            dest += screenwidth;
+            dest2 += screenwidth;
+            frac += fracstep;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Deferred column drawing.
+//
+// [JN] Walls, masked mid textures, sprites and skies are not drawing their
+// columns right away, but queue them with R_QueueColumn instead. Queue is
+// executed by R_FlushColumns: columns drawn by R_DrawColumn or
+// R_DrawColumnPlain are combined into groups of up to COLGROUP neighbour
+// columns, which are drawn row by row, so each row of a group is written
+// into one or two cache lines instead of stepping down by SCREENWIDTH
+// for every single pixel.
+// Any other drawer is called as usual in queued order, so fuzz position
+// and translucency results are not affected.
+//
+// Columns of a single queue never overlap each other (one seg, one sprite,
+// one masked range, one sky plane or recorded walls of one strip), so
+// drawing order does not matter for the result, which stays identical
+// to the immediate drawing.
+//
+// Queue must be flushed before the sources of queued columns may get
+// purged from the zone memory, i.e. before generating a composite texture.
+// -----------------------------------------------------------------------------
+
+#define MAXCOLCMDS  512
+#define COLGROUP    8
+
+typedef struct
+{
+    void (*func) (void);
+    lighttable_t *colormap[2];
+    const byte   *brightmap;
+    byte         *source;
+    byte         *translation;
+    fixed_t       iscale;
+    fixed_t       texturemid;
+    int           texheight;
+    int           x;
+    int           yl;
+    int           yh;
+} colcmd_t;
+
+// Per column state of R_DrawColumnGroup.
+typedef struct
+{
+    pixel_t       *dest;
+    fixed_t        frac;
+    fixed_t        fracstep;
+    int            heightmask;
+    boolean        npot;
+    boolean        plain;
+    const byte    *source;
+    const byte    *brightmap;
+    const pixel_t *colormap0;
+    const pixel_t *colormap1;
+} colstate_t;
+
+static THREADLOCAL colcmd_t colcmds[MAXCOLCMDS];
+static THREADLOCAL int      numcolcmds;
+
+// -----------------------------------------------------------------------------
+// R_QueueColumnState, R_RestoreColumnState
+//  Copy dc_* values and colfunc from and back to the command.
+// -----------------------------------------------------------------------------
+
+static void R_QueueColumnState (colcmd_t *cmd)
+{
+    cmd->func = colfunc;
+    cmd->colormap[0] = dc_colormap[0];
+    cmd->colormap[1] = dc_colormap[1];
+    cmd->brightmap = dc_brightmap;
+    cmd->source = dc_source;
+    cmd->translation = dc_translation;
+    cmd->iscale = dc_iscale;
+    cmd->texturemid = dc_texturemid;
+    cmd->texheight = dc_texheight;
+    cmd->x = dc_x;
+    cmd->yl = dc_yl;
+    cmd->yh = dc_yh;
+}
+
+static void R_RestoreColumnState (const colcmd_t *cmd)
+{
+    dc_colormap[0] = cmd->colormap[0];
+    dc_colormap[1] = cmd->colormap[1];
+    dc_brightmap = cmd->brightmap;
+    dc_source = cmd->source;
+    dc_translation = cmd->translation;
+    dc_iscale = cmd->iscale;
+    dc_texturemid = cmd->texturemid;
+    dc_texheight = cmd->texheight;
+    dc_x = cmd->x;
+    dc_yl = cmd->yl;
+    dc_yh = cmd->yh;
+}
+
+// -----------------------------------------------------------------------------
+// Wall column recording.
+//
+// [JN] With more than one render thread, BSP tree is walked only once per
+// frame on the main thread. Wall columns can't be drawn at that point, as
+// every strip is drawn by its own thread, so R_QueueColumn records them
+// into the list of the strip they belong to instead. Every strip replays
+// its own list with R_ReplayColumns later on.
+//
+// Wall columns never overlap each other, so replaying them strip by strip
+// gives the same result as drawing them during the BSP walk.
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    colcmd_t *cmds;
+    int       count;
+    int       size;
+} colstrip_t;
+
+static colstrip_t colstrips[MAXTHREADS];
+static byte       colstripnum[MAXWIDTH];  // Strip of every view column.
+static boolean    recordcolumns;
+
+// -----------------------------------------------------------------------------
+// R_StartRecordColumns
+//  Empties column lists of "numstrips" strips and starts recording.
+// -----------------------------------------------------------------------------
+
+void R_StartRecordColumns (int numstrips)
+{
+    for (int i = 0 ; i < numstrips ; i++)
+    {
+        colstrips[i].count = 0;
+
+        for (int x = R_StripStart(i, numstrips) ; x < R_StripStart(i + 1, numstrips) ; x++)
+        {
+            colstripnum[x] = i;
+        }
+    }
+
+    recordcolumns = true;
+}
+
+// -----------------------------------------------------------------------------
+// R_StopRecordColumns
+// -----------------------------------------------------------------------------
+
+void R_StopRecordColumns (void)
+{
+    recordcolumns = false;
+}
+
+// -----------------------------------------------------------------------------
+// R_RecordColumn
+//  Stores current dc_* values and colfunc in the list of its strip.
+// -----------------------------------------------------------------------------
+
+static void R_RecordColumn (void)
+{
+    colstrip_t *const strip = &colstrips[colstripnum[dc_x]];
+
+    if (dc_yl > dc_yh)
+    {
+        return;
+    }
+
+    if (strip->count == strip->size)
+    {
+        strip->size = strip->size ? strip->size * 2 : MAXCOLCMDS;
+        strip->cmds = I_Realloc(strip->cmds, strip->size * sizeof(*strip->cmds));
+    }
+
+    R_QueueColumnState(&strip->cmds[strip->count++]);
+}
+
+// -----------------------------------------------------------------------------
+// R_ReplayColumns
+//  Draws recorded wall columns of the strip.
+// -----------------------------------------------------------------------------
+
+void R_ReplayColumns (int strip)
+{
+    const colstrip_t *const cs = &colstrips[strip];
+
+    for (int i = 0 ; i < cs->count ; i++)
+    {
+        R_RestoreColumnState(&cs->cmds[i]);
+        R_QueueColumn();
+    }
+
+    R_FlushColumns();
+    colfunc = basecolfunc;
+}
+
+// -----------------------------------------------------------------------------
+// R_QueueColumn
+//  Stores current dc_* values and colfunc for deferred drawing.
+// -----------------------------------------------------------------------------
+
+void R_QueueColumn (void)
+{
+    if (recordcolumns)
+    {
+        R_RecordColumn();
+        return;
+    }
+
+    if (!vid_column_batch)
+    {
+        colfunc();
+        return;
+    }
+
+    if (dc_yl > dc_yh)
+    {
+        return;
+    }
+
+    if (numcolcmds == MAXCOLCMDS)
+    {
+        R_FlushColumns();
+    }
+
+    R_QueueColumnState(&colcmds[numcolcmds++]);
+}
+
+// -----------------------------------------------------------------------------
+// R_InitColumnState
+//  Same setup as in R_DrawColumn.
+// -----------------------------------------------------------------------------
+
+static void R_InitColumnState (colstate_t *c, const colcmd_t *cmd)
+{
+    const int texheight = cmd->texheight;
+
+    c->dest = ylookup[cmd->yl] + columnofs[flipviewwidth[cmd->x]];
+    c->fracstep = cmd->iscale;
+    c->frac = cmd->texturemid + (cmd->yl - centery) * c->fracstep;
+    c->source = cmd->source;
+    c->brightmap = cmd->brightmap;
+    c->colormap0 = cmd->colormap[0];
+    c->colormap1 = cmd->colormap[1];
+    c->heightmask = texheight - 1;
+    c->npot = (texheight & c->heightmask) != 0;
+    c->plain = (cmd->func == R_DrawColumnPlain);
+
+    if (c->npot)
+    {
+        c->heightmask = texheight << FRACBITS;
+        c->frac = ((c->frac % c->heightmask) + c->heightmask) % c->heightmask;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_DrawColumnPixels
+//  Draws "count" pixels of the column and advances it.
+// -----------------------------------------------------------------------------
+
+static inline void R_DrawColumnPixels (colstate_t *c, int count)
+{
+    pixel_t *dest = c->dest;
+    fixed_t frac = c->frac;
+    const fixed_t fracstep = c->fracstep;
+    const int heightmask = c->heightmask;
+    const byte *const sourcebase = c->source;
+    const byte *const brightmap = c->brightmap;
+    const pixel_t *const colormap0 = c->colormap0;
+    const pixel_t *const colormap1 = c->colormap1;
+    const int screenwidth = SCREENWIDTH;
+
+    if (c->plain)
+    {
+        if (c->npot)
+        {
+            for ( ; count > 0 ; count--)
+            {
+                *dest = colormap0[sourcebase[frac >> FRACBITS]];
+                dest += screenwidth;
+                frac = (frac + fracstep) % heightmask;
+            }
+        }
+        else
+        {
+            I_DrawColumnPixelsPlain(dest, screenwidth, count, frac, fracstep,
+                                    sourcebase, heightmask, colormap0);
+            dest += screenwidth * count;
+            frac += (fixed_t)((unsigned int) fracstep * count);
+        }
+    }
+    else if (c->npot)
+    {
+        for ( ; count > 0 ; count--)
+        {
+            const unsigned s = sourcebase[frac >> FRACBITS];
+
+            *dest = brightmap[s] ? colormap1[s] : colormap0[s];
+            dest += screenwidth;
+            frac = (frac + fracstep) % heightmask;
+        }
+    }
+    else if (count >= 4)
+    {
+        I_DrawColumnPixels(dest, screenwidth, count, frac, fracstep,
+                           sourcebase, heightmask, brightmap, colormap0, colormap1);
+        dest += screenwidth * count;
+        frac += (fixed_t)((unsigned int) fracstep * count);
+    }
+    else
+    {
+        for ( ; count > 0 ; count--)
+        {
+            const unsigned s = sourcebase[(frac >> FRACBITS) & heightmask];
+
+            *dest = brightmap[s] ? colormap1[s] : colormap0[s];
+            dest += screenwidth;
+            frac += fracstep;
+        }
+    }
+
+    c->dest = dest;
+    c->frac = frac;
+}
+
+// -----------------------------------------------------------------------------
+// R_DrawColumnGroup
+//  Draws up to COLGROUP columns of R_DrawColumn. Rows covered by all of
+//  the columns are drawn row by row, the rest column by column.
+// -----------------------------------------------------------------------------
+
+static void R_DrawColumnGroup (const colcmd_t **group, int count)
+{
+    colstate_t state[COLGROUP];
+    int top = group[0]->yl;
+    int bottom = group[0]->yh;
+    int i, y;
+
+    for (i = 1 ; i < count ; i++)
+    {
+        top = MAX(top, group[i]->yl);
+        bottom = MIN(bottom, group[i]->yh);
+    }
+
+    for (i = 0 ; i < count ; i++)
+    {
+        R_InitColumnState(&state[i], group[i]);
+
+        if (top > bottom)
+        {
+            // No common rows, nothing to interleave.
+            R_DrawColumnPixels(&state[i], group[i]->yh - group[i]->yl + 1);
+        }
+        else
+        {
+            R_DrawColumnPixels(&state[i], top - group[i]->yl);
+        }
+    }
+
+    if (top > bottom)
+    {
+        return;
+    }
+
+    for (y = top ; y <= bottom ; y++)
+    {
+        for (i = 0 ; i < count ; i++)
+        {
+            R_DrawColumnPixels(&state[i], 1);
+        }
+    }
+
+    for (i = 0 ; i < count ; i++)
+    {
+        R_DrawColumnPixels(&state[i], group[i]->yh - bottom);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_FlushColumns
+//  Draws all queued columns and empties the queue.
+// -----------------------------------------------------------------------------
+
+void R_FlushColumns (void)
+{
+    static THREADLOCAL boolean done[MAXCOLCMDS];
+    const colcmd_t *group[COLGROUP];
+    const int count = numcolcmds;
+    colcmd_t saved;
+    int i, j;
+
+    if (!count)
+    {
+        return;
+    }
+
+    // Empty the queue first, drawers will not add anything to it.
+    numcolcmds = 0;
+    memset(done, 0, count * sizeof(*done));
+
+    // Queue may be flushed in the middle of a caller's loop,
+    // so keep its dc_* values untouched.
+    R_QueueColumnState(&saved);
+
+    for (i = 0 ; i < count ; i++)
+    {
+        const colcmd_t *const cmd = &colcmds[i];
+
+        if (done[i])
+        {
+            continue;
+        }
+
+        if (cmd->func == R_DrawColumn || cmd->func == R_DrawColumnPlain)
+        {
+            int n = 1;
+
+            // Gather following neighbour columns of the same drawer.
+            // Walls are queueing top and bottom tiers of every column
+            // one after another, so look a bit further than COLGROUP.
+            group[0] = cmd;
+
+            for (j = i + 1 ; j < count && j < i + COLGROUP * 2 && n < COLGROUP ; j++)
+            {
+                if (colcmds[j].func != R_DrawColumn
+                &&  colcmds[j].func != R_DrawColumnPlain)
+                {
+                    break;
+                }
+                if (!done[j] && colcmds[j].x == group[n-1]->x + 1)
+                {
+                    group[n++] = &colcmds[j];
+                    done[j] = true;
+                }
+            }
+
+            R_DrawColumnGroup(group, n);
+        }
+        else
+        {
+            R_RestoreColumnState(cmd);
+            cmd->func();
+        }
+    }
+
+    R_RestoreColumnState(&saved);
+}
+
 
 //
 // Spectre/Invisibility.
@@ -270,9 +803,63 @@ void R_SetFuzzPosTic (void)
 	}
 	fuzzpos_tic = fuzzpos;
 }
-void R_SetFuzzPosDraw (void)
+
+// [JN] Whether the view is drawn by several strips at once.
+static boolean fuzzstrips;
+
+void R_SetFuzzPosDraw (boolean strips)
 {
 	fuzzpos = fuzzpos_tic;
+	fuzzstrips = strips;
+}
+
+// -----------------------------------------------------------------------------
+// R_FuzzColumnPos
+// [JN] Starting fuzz position of column x. A single thread continues from
+// the previously drawn column, as usual. Strips are drawing their columns
+// at the same time, so then every column starts from its own seed instead.
+// Such fuzz doesn't depend on drawing order and is the same with any number
+// of strips, but it is not the same as the single-threaded one.
+// -----------------------------------------------------------------------------
+
+static inline int R_FuzzColumnPos (int x)
+{
+    if (!fuzzstrips)
+    {
+        return fuzzpos;
+    }
+
+    return (fuzzpos + (((unsigned int) x * 2654435761u) >> 26)) % FUZZTABLE;
+}
+
+// -----------------------------------------------------------------------------
+// R_FuzzRestartPos
+// [JN] Improved fuzz restarts the table at a random position. Strips are
+// deriving it from the pixel coordinates instead of ID_Random, for the
+// same reason as above.
+// -----------------------------------------------------------------------------
+
+static inline int R_FuzzRestartPos (int x, int y)
+{
+    if (!fuzzstrips)
+    {
+        return ID_Random() % 49;
+    }
+
+    return (fuzzpos + (((unsigned int) ((x << 12) ^ y) * 2654435761u) >> 16)) % 49;
+}
+
+// -----------------------------------------------------------------------------
+// R_FuzzEndColumn
+// [JN] A single thread continues the next column from where this one ended.
+// -----------------------------------------------------------------------------
+
+static inline void R_FuzzEndColumn (int pos)
+{
+    if (!fuzzstrips)
+    {
+        fuzzpos = pos;
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -307,28 +894,30 @@ void R_DrawFuzzColumn(void)
 
     // [PN] Local pointers to speed up access
     const int *const fuzzoffsetbase = fuzzoffset;
-    int local_fuzzpos = fuzzpos;
+    int local_fuzzpos = R_FuzzColumnPos(dc_x);
     const int fuzzalpha = fuzz_alpha;
     const int screenwidth = SCREENWIDTH;
 
     // [PN] Use a for loop for clarity and potential optimizations
+    // [JN] Offsets are collected first, pixels are drawn by SIMD kernel.
     {
         const int iterations = count + 1; // [PN] since do/while decrements count after use
+        int fuzz_offsets[MAXHEIGHT];
+
         for (int i = 0; i < iterations; i++)
         {
-            const int fuzz_offset = screenwidth * fuzzoffsetbase[local_fuzzpos];
-
-            *dest = I_BlendDark(dest[fuzz_offset], fuzzalpha);
+            fuzz_offsets[i] = screenwidth * fuzzoffsetbase[local_fuzzpos];
 
             // [PN] Update fuzzpos
             local_fuzzpos = (local_fuzzpos + 1) % FUZZTABLE;
             if (local_fuzzpos == 0 && vis_improved_fuzz == 1)
             {
-                local_fuzzpos = (realleveltime > oldleveltime) ? ID_Random() % 49 : 0;
+                local_fuzzpos = (realleveltime > oldleveltime) ? R_FuzzRestartPos(dc_x, dc_yl + i) : 0;
             }
-
-            dest += screenwidth;
         }
+
+        I_DrawFuzzPixels(dest, screenwidth, iterations, fuzz_offsets, fuzzalpha);
+        dest += screenwidth * iterations;
     }
 
     // [PN] handle cutoff line
@@ -340,7 +929,7 @@ void R_DrawFuzzColumn(void)
     }
 
     // [PN] restore fuzzpos
-    fuzzpos = local_fuzzpos;
+    R_FuzzEndColumn(local_fuzzpos);
 }
 
 // -----------------------------------------------------------------------------
@@ -376,7 +965,7 @@ void R_DrawFuzzColumnLow(void)
 
     // [PN] Local pointers to speed up access
     const int *const fuzzoffsetbase = fuzzoffset;
-    int local_fuzzpos = fuzzpos;
+    int local_fuzzpos = R_FuzzColumnPos(dc_x);
     const int fuzzalpha = fuzz_alpha;
     const int screenwidth = SCREENWIDTH;
 
@@ -393,7 +982,7 @@ void R_DrawFuzzColumnLow(void)
             local_fuzzpos = (local_fuzzpos + 1) % FUZZTABLE;
             if (local_fuzzpos == 0 && vis_improved_fuzz)
             {
-                local_fuzzpos = (realleveltime > oldleveltime) ? ID_Random() % 49 : 0;
+                local_fuzzpos = (realleveltime > oldleveltime) ? R_FuzzRestartPos(dc_x, dc_yl + i) : 0;
             }
 
             dest += screenwidth;
@@ -410,7 +999,7 @@ void R_DrawFuzzColumnLow(void)
     }
 
     // [PN] Restore fuzzpos
-    fuzzpos = local_fuzzpos;
+    R_FuzzEndColumn(local_fuzzpos);
 }
 
 
@@ -517,7 +1106,7 @@ void R_DrawFuzzBWColumn(void)
 
     // [PN] Local pointers to speed up access
     const int *const fuzzoffsetbase = fuzzoffset;
-    int local_fuzzpos = fuzzpos;
+    int local_fuzzpos = R_FuzzColumnPos(dc_x);
     const int fuzzalpha = fuzz_alpha;
     const int screenwidth = SCREENWIDTH;
 
@@ -539,7 +1128,7 @@ void R_DrawFuzzBWColumn(void)
     }
 
     // [PN] Restore fuzzpos
-    fuzzpos = local_fuzzpos;
+    R_FuzzEndColumn(local_fuzzpos);
 }
 
 
@@ -571,7 +1160,7 @@ void R_DrawFuzzBWColumnLow(void)
 
     // [PN] Local pointers to speed up access
     const int *const fuzzoffsetbase = fuzzoffset;
-    int local_fuzzpos = fuzzpos;
+    int local_fuzzpos = R_FuzzColumnPos(dc_x);
     const int fuzzalpha = fuzz_alpha;
     const int screenwidth = SCREENWIDTH;
 
@@ -598,7 +1187,7 @@ void R_DrawFuzzBWColumnLow(void)
     }
 
     // [PN] Restore fuzzpos
-    fuzzpos = local_fuzzpos;
+    R_FuzzEndColumn(local_fuzzpos);
 }
 
 
@@ -801,16 +1390,10 @@ void R_DrawTLColumn (void)
     const pixel_t *const colormap1 = dc_colormap[1];
     const int screenwidth = SCREENWIDTH;
 
-    for (int i = 0; i <= count; i++)
-    {
-        const unsigned s = sourcebase[frac >> FRACBITS];
-        const pixel_t destrgb = (brightmap[s] ? colormap1[s] : colormap0[s]);
-
-        *dest = I_BlendOver(*dest, destrgb, TRANMAP_ALPHA);
-
-        dest += screenwidth;
-        frac += fracstep;
-    }
+    // [JN] Drawn by SIMD kernel, see i_simd.c.
+    I_DrawTLColumnPixels(dest, screenwidth, count + 1, frac, fracstep,
+                         sourcebase, -1, brightmap, colormap0, colormap1,
+                         TRANMAP_ALPHA);
 }
 
 
@@ -884,17 +1467,9 @@ void R_DrawTLAddColumn(void)
     const pixel_t *const colormap1 = dc_colormap[1];
     const int screenwidth = SCREENWIDTH;
 
-    const int iterations = count + 1;
-    for (int i = 0; i < iterations; i++)
-    {
-        const unsigned s = sourcebase[frac >> FRACBITS];
-        const pixel_t destrgb = (brightmap[s] ? colormap1[s] : colormap0[s]);
-
-        *dest = I_BlendAdd(*dest, destrgb);
-
-        dest += screenwidth;
-        frac += fracstep;
-    }
+    // [JN] Drawn by SIMD kernel, see i_simd.c.
+    I_DrawTLAddColumnPixels(dest, screenwidth, count + 1, frac, fracstep,
+                            sourcebase, -1, brightmap, colormap0, colormap1);
 }
 
 // -----------------------------------------------------------------------------
@@ -990,20 +1565,20 @@ void R_InitTranslationTables (void)
 //  and the inner loop has to step in texture space u and v.
 //
 
-int ds_y; 
-int ds_x1; 
-int ds_x2;
+THREADLOCAL int ds_y; 
+THREADLOCAL int ds_x1; 
+THREADLOCAL int ds_x2;
 
-lighttable_t *ds_colormap[2];
-const byte   *ds_brightmap;
+THREADLOCAL lighttable_t *ds_colormap[2];
+THREADLOCAL const byte   *ds_brightmap;
 
-fixed_t ds_xfrac; 
-fixed_t ds_yfrac; 
-fixed_t ds_xstep; 
-fixed_t ds_ystep;
+THREADLOCAL fixed_t ds_xfrac; 
+THREADLOCAL fixed_t ds_yfrac; 
+THREADLOCAL fixed_t ds_xstep; 
+THREADLOCAL fixed_t ds_ystep;
 
 // start of a 64*64 tile image 
-byte *ds_source;
+THREADLOCAL byte *ds_source;
 
 
 // -----------------------------------------------------------------------------
@@ -1034,39 +1609,9 @@ void R_DrawSpan(void)
         // [PN] Precompute the destination pointer for normal levels
         pixel_t *dest = ylookup[ds_y] + columnofs[ds_x1];
 
-        // [PN] Process in chunks of four pixels
-        for (; count >= 4; count -= 4)
-        {
-            for (int j = 0; j < 4; j++)
-            {
-                const unsigned int ytemp = (ds_yfrac >> 10) & 0x0fc0;
-                const unsigned int xtemp = (ds_xfrac >> 16) & 0x3f;
-                const int spot = xtemp | ytemp;
-
-                const byte source = sourcebase[spot];
-                dest[j] = (brightmap[source] ? colormap1[source] : colormap0[source]);
-
-                ds_xfrac += xstep;
-                ds_yfrac += ystep;
-            }
-
-            dest += 4;
-        }
-
-        // [PN] Render remaining pixels if any
-        for (; count > 0; count--)
-        {
-            const unsigned int ytemp = (ds_yfrac >> 10) & 0x0fc0;
-            const unsigned int xtemp = (ds_xfrac >> 16) & 0x3f;
-            const int spot = xtemp | ytemp;
-
-            const byte source = sourcebase[spot];
-            *dest = (brightmap[source] ? colormap1[source] : colormap0[source]);
-
-            dest++;
-            ds_xfrac += xstep;
-            ds_yfrac += ystep;
-        }
+        // [JN] Drawn by SIMD kernel, see i_simd.c.
+        I_DrawSpanPixels(dest, count, &ds_xfrac, &ds_yfrac, xstep, ystep,
+                         sourcebase, brightmap, colormap0, colormap1);
     }
     else
     {
@@ -1178,6 +1723,91 @@ void R_DrawSpanLow(void)
     }
 }
 
+// -----------------------------------------------------------------------------
+// R_DrawSpanPlain
+// [JN] Brightmap-free version of R_DrawSpan. Used for flats without
+// brightmap and with fixed colormap, so only ds_colormap[0] is looked up.
+// -----------------------------------------------------------------------------
+
+void R_DrawSpanPlain (void)
+{
+    const int count = ds_x2 - ds_x1 + 1;
+    const byte *const sourcebase = ds_source;
+    const pixel_t *const colormap = ds_colormap[0];
+    const fixed_t xstep = ds_xstep;
+    const fixed_t ystep = ds_ystep;
+
+    if (!gp_flip_levels)
+    {
+        I_DrawSpanPixelsPlain(ylookup[ds_y] + columnofs[ds_x1], count,
+                              &ds_xfrac, &ds_yfrac, xstep, ystep,
+                              sourcebase, colormap);
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const unsigned int ytemp = (ds_yfrac >> 10) & 0x0fc0;
+            const unsigned int xtemp = (ds_xfrac >> 16) & 0x3f;
+            pixel_t *dest = ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]];
+
+            *dest = colormap[sourcebase[xtemp | ytemp]];
+
+            ds_xfrac += xstep;
+            ds_yfrac += ystep;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_DrawSpanPlainLow
+// [JN] Brightmap-free version of R_DrawSpanLow.
+// -----------------------------------------------------------------------------
+
+void R_DrawSpanPlainLow (void)
+{
+    const int count = ds_x2 - ds_x1 + 1;
+    const byte *const sourcebase = ds_source;
+    const pixel_t *const colormap = ds_colormap[0];
+    const fixed_t xstep = ds_xstep;
+    const fixed_t ystep = ds_ystep;
+
+    ds_x1 <<= 1;
+    ds_x2 <<= 1;
+
+    if (!gp_flip_levels)
+    {
+        pixel_t *dest = ylookup[ds_y] + columnofs[ds_x1];
+
+        for (int i = 0; i < count; i++)
+        {
+            const unsigned int ytemp = (ds_yfrac >> 10) & 0x0fc0;
+            const unsigned int xtemp = (ds_xfrac >> 16) & 0x3f;
+
+            dest[0] = dest[1] = colormap[sourcebase[xtemp | ytemp]];
+            dest += 2;
+
+            ds_xfrac += xstep;
+            ds_yfrac += ystep;
+        }
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+        {
+            const unsigned int ytemp = (ds_yfrac >> 10) & 0x0fc0;
+            const unsigned int xtemp = (ds_xfrac >> 16) & 0x3f;
+            const pixel_t pixel = colormap[sourcebase[xtemp | ytemp]];
+
+            *(ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]]) = pixel;
+            *(ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]]) = pixel;
+
+            ds_xfrac += xstep;
+            ds_yfrac += ystep;
+        }
+    }
+}
+
 // -----------------------------------------------------------------------------
 // R_InitBuffer 
 // Initializes the buffer for a given view width and height.
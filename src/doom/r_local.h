@@ -86,6 +86,11 @@ typedef	struct
     short   special;
     short   tag;
 
+    // [JN] killough 1/30/98: chain of sectors with the same
+    // tag hash, see P_InitTagLists.
+    int     firsttag;
+    int     nexttag;
+
     // 0 = untraversed, 1,2 = sndlines -1
     int     soundtraversed;
 
@@ -137,6 +142,11 @@ typedef	struct
 
     // [crispy] revealed secrets
     short	oldspecial;
+
+    // [JN] Game state hash of the sector, and its index
+    // in the dirty list + 1 (0 if not dirty).
+    uint64_t	statehash;
+    int		hashslot;
 } sector_t;
 
 //
@@ -525,6 +535,7 @@ extern visplane_t *ceilingplane;
 
 extern void R_InitBrightmaps (void);
 
+extern const byte   nobrightmap[256];
 extern const byte  *R_BrightmapForTexName (const char *texname);
 extern const byte  *R_BrightmapForSprite (const int type);
 extern const byte  *R_BrightmapForFlatNum (const int num);
@@ -542,11 +553,11 @@ extern void R_ClearClipSegs (void);
 extern void R_ClearDrawSegs (void);
 extern void R_RenderBSPNode (int bspnum);
 
-extern seg_t    *curline;
-extern side_t   *sidedef;
-extern line_t   *linedef;
-extern sector_t *frontsector;
-extern sector_t *backsector;
+extern THREADLOCAL seg_t    *curline;
+extern THREADLOCAL side_t   *sidedef;
+extern THREADLOCAL line_t   *linedef;
+extern THREADLOCAL sector_t *frontsector;
+extern THREADLOCAL sector_t *backsector;
 
 extern byte solidcol[MAXWIDTH];
 
@@ -583,6 +594,8 @@ extern int    numflats;
 
 extern void R_DrawColumn (void);
 extern void R_DrawColumnLow (void);
+extern void R_DrawColumnPlain (void);
+extern void R_DrawColumnPlainLow (void);
 extern void R_DrawFuzzColumn (void);
 extern void R_DrawFuzzColumnLow (void);
 extern void R_DrawFuzzTLColumn (void);
@@ -591,6 +604,8 @@ extern void R_DrawFuzzBWColumn (void);
 extern void R_DrawFuzzBWColumnLow (void);
 extern void R_DrawSpan (void);
 extern void R_DrawSpanLow (void);
+extern void R_DrawSpanPlain (void);
+extern void R_DrawSpanPlainLow (void);
 extern void R_DrawTLColumn (void);
 extern void R_DrawTLColumnLow (void);
 extern void R_DrawTLAddColumn (void);
@@ -599,39 +614,44 @@ extern void R_DrawTranslatedColumn (void);
 extern void R_DrawTranslatedColumnLow (void);
 extern void R_DrawTransTLFuzzColumn (void);
 extern void R_DrawTransTLFuzzColumnLow (void);
+extern void R_QueueColumn (void);
+extern void R_FlushColumns (void);
+extern void R_StartRecordColumns (int numstrips);
+extern void R_StopRecordColumns (void);
+extern void R_ReplayColumns (int strip);
 
 extern void R_DrawViewBorder (void);
 extern void R_FillBackScreen (void);
 extern void R_InitBuffer (int width, int height);
 extern void R_InitTranslationTables (void);
-extern void R_SetFuzzPosDraw (void);
+extern void R_SetFuzzPosDraw (boolean strips);
 extern void R_SetFuzzPosTic (void);
 
-extern byte *dc_source;
-extern byte *ds_source;		
+extern THREADLOCAL byte *dc_source;
+extern THREADLOCAL byte *ds_source;		
 extern byte *translationtables;
-extern byte *dc_translation;
+extern THREADLOCAL byte *dc_translation;
 
-extern int dc_x;
-extern int dc_yl;
-extern int dc_yh;
-extern int ds_y;
-extern int ds_x1;
-extern int ds_x2;
+extern THREADLOCAL int dc_x;
+extern THREADLOCAL int dc_yl;
+extern THREADLOCAL int dc_yh;
+extern THREADLOCAL int ds_y;
+extern THREADLOCAL int ds_x1;
+extern THREADLOCAL int ds_x2;
 
-extern fixed_t dc_iscale;
-extern fixed_t dc_texturemid;
-extern int     dc_texheight;
-extern fixed_t ds_xfrac;
-extern fixed_t ds_yfrac;
-extern fixed_t ds_xstep;
-extern fixed_t ds_ystep;
+extern THREADLOCAL fixed_t dc_iscale;
+extern THREADLOCAL fixed_t dc_texturemid;
+extern THREADLOCAL int     dc_texheight;
+extern THREADLOCAL fixed_t ds_xfrac;
+extern THREADLOCAL fixed_t ds_yfrac;
+extern THREADLOCAL fixed_t ds_xstep;
+extern THREADLOCAL fixed_t ds_ystep;
 
-extern lighttable_t *dc_colormap[2];
-extern lighttable_t *ds_colormap[2];
+extern THREADLOCAL lighttable_t *dc_colormap[2];
+extern THREADLOCAL lighttable_t *ds_colormap[2];
 
-extern const byte *dc_brightmap;
-extern const byte *ds_brightmap;
+extern THREADLOCAL const byte *dc_brightmap;
+extern THREADLOCAL const byte *ds_brightmap;
 
 // -----------------------------------------------------------------------------
 // R_MAIN
@@ -688,8 +708,9 @@ inline static angle_t LerpAngle(angle_t oangle, angle_t nangle)
 
 // Function pointers to switch refresh/drawing functions.
 // Used to select shadow mode etc.
-extern void (*colfunc) (void);
+extern THREADLOCAL void (*colfunc) (void);
 extern void (*basecolfunc) (void);
+extern void (*plaincolfunc) (void);
 extern void (*fuzzcolfunc) (void);
 extern void (*fuzztlcolfunc) (void);
 extern void (*fuzzbwcolfunc) (void);
@@ -698,6 +719,16 @@ extern void (*tlcolfunc) (void);
 extern void (*tladdcolfunc) (void);
 extern void (*transtlfuzzcolfunc) (void);
 extern void (*spanfunc) (void);
+extern void (*plainspanfunc) (void);
+
+// [JN] Columns of the view drawn by the current thread.
+extern THREADLOCAL int stripstart, stripstop;
+
+// [JN] First column of the strip, when the view is split into "numstrips".
+inline static int R_StripStart (int strip, int numstrips)
+{
+    return viewwidth * strip / numstrips;
+}
 
 // POV related.
 extern fixed_t centerxfrac;
@@ -762,6 +793,7 @@ extern int detailshift;
 #define PL_SKYFLAT (0x80000000)
 
 extern void R_ClearPlanes (void);
+extern void R_SortPlanes (void);
 extern void R_DrawPlanes (void);
 extern void R_InitPlanes (void);
 
@@ -790,7 +822,7 @@ extern visplane_t *R_DupPlane (const visplane_t *pl, int start, int stop);
 extern void R_RenderMaskedSegRange (drawseg_t *ds, int x1, int x2);
 extern void R_StoreWallRange (int start, int stop);
 
-extern lighttable_t **walllights;
+extern THREADLOCAL lighttable_t **walllights;
 
 // -----------------------------------------------------------------------------
 // R_SKY
@@ -812,7 +844,6 @@ extern int skytexturemid;
 // R_SWIRL
 // -----------------------------------------------------------------------------
 
-extern void  R_InitDistortedFlats (void);
 extern byte *R_DistortedFlat (int flatnum);
 
 // -----------------------------------------------------------------------------
@@ -822,7 +853,8 @@ extern byte *R_DistortedFlat (int flatnum);
 extern void R_AddPSprites (void);
 extern void R_AddSprites (sector_t *sec);
 extern void R_ClearSprites (void);
-extern void R_ClipVisSprite (vissprite_t *vis, int xl, int xh);
+extern boolean R_ClipVisSprite (vissprite_t *vis, int xl, int xh);
+extern void R_SortMasked (void);
 extern void R_DrawMasked (void);
 extern void R_DrawMaskedColumn (column_t *column);
 extern void R_DrawSprites (void);
@@ -833,11 +865,11 @@ extern int negonearray[MAXWIDTH];        // [JN] 32-bit integer math
 extern int screenheightarray[MAXWIDTH];  // [JN] 32-bit integer math
 
 // vars for R_DrawMaskedColumn
-extern int *mfloorclip;    // [JN] 32-bit integer math
-extern int *mceilingclip;  // [JN] 32-bit integer math
+extern THREADLOCAL int *mfloorclip;    // [JN] 32-bit integer math
+extern THREADLOCAL int *mceilingclip;  // [JN] 32-bit integer math
 
-extern fixed_t spryscale;
-extern int64_t sprtopscreen;
+extern THREADLOCAL fixed_t spryscale;
+extern THREADLOCAL int64_t sprtopscreen;
 
 extern fixed_t pspritescale;
 extern fixed_t pspriteiscale;
@@ -31,6 +31,9 @@
 #include "v_video.h"
 #include "w_wad.h"
 #include "st_bar.h"
+#include "i_perf.h"
+#include "i_thread.h"
+#include "z_zone.h"
 
 #include "id_vars.h"
 #include "id_func.h"
@@ -123,8 +126,9 @@ int BMAPMAXDIMINDEX;
 int BMAPANIMSHIFT;
 
 
-void (*colfunc) (void);
+THREADLOCAL void (*colfunc) (void);
 void (*basecolfunc) (void);
+void (*plaincolfunc) (void);  // [JN] No brightmap
 void (*fuzzcolfunc) (void);
 void (*fuzztlcolfunc) (void);
 void (*fuzzbwcolfunc) (void);
@@ -133,7 +137,11 @@ void (*tlcolfunc) (void);
 void (*tladdcolfunc) (void);
 void (*transtlfuzzcolfunc) (void);
 void (*spanfunc) (void);
+void (*plainspanfunc) (void);  // [JN] No brightmap
 
+// [JN] Columns of the view drawn by the current thread.
+THREADLOCAL int stripstart, stripstop;
+static int numstrips = 1;
 
 
 //
@@ -800,6 +808,7 @@ void R_ExecuteSetViewSize (void)
     if (!detailshift)
     {
 	colfunc = basecolfunc = R_DrawColumn;
+	plaincolfunc = R_DrawColumnPlain;
 	fuzzcolfunc = R_DrawFuzzColumn;
 	fuzztlcolfunc = R_DrawFuzzTLColumn;
 	fuzzbwcolfunc = R_DrawFuzzBWColumn;
@@ -808,10 +817,12 @@ void R_ExecuteSetViewSize (void)
 	tladdcolfunc = R_DrawTLAddColumn;
 	transtlfuzzcolfunc = R_DrawTransTLFuzzColumn;
 	spanfunc = R_DrawSpan;
+	plainspanfunc = R_DrawSpanPlain;
     }
     else
     {
 	colfunc = basecolfunc = R_DrawColumnLow;
+	plaincolfunc = R_DrawColumnPlainLow;
 	fuzzcolfunc = R_DrawFuzzColumnLow;
 	fuzztlcolfunc = R_DrawFuzzTLColumnLow;
 	fuzzbwcolfunc = R_DrawFuzzBWColumnLow;
@@ -820,6 +831,7 @@ void R_ExecuteSetViewSize (void)
 	tladdcolfunc = R_DrawTLAddColumnLow;
 	transtlfuzzcolfunc = R_DrawTransTLFuzzColumnLow;
 	spanfunc = R_DrawSpanLow;
+	plainspanfunc = R_DrawSpanPlainLow;
     }
 
     R_InitBuffer (scaledviewwidth, viewheight);
@@ -1079,8 +1091,6 @@ void R_SetupFrame (player_t* player)
 	fixedcolormap =
 	    colormaps
 	    + player->fixedcolormap*(NUMCOLORMAPS / 32)*256; // [crispy] smooth diminishing lighting
-	
-	walllights = scalelightfixed;
 
 	for (i=0 ; i<MAXLIGHTSCALE ; i++)
 	    scalelightfixed[i] = fixedcolormap;
@@ -1091,6 +1101,52 @@ void R_SetupFrame (player_t* player)
     validcount++;
 }
 
+// -----------------------------------------------------------------------------
+// R_SetupStrip
+// [JN] Sets up render state of the current thread for columns x1...x2.
+// -----------------------------------------------------------------------------
+
+static void R_SetupStrip (int x1, int x2)
+{
+    stripstart = x1;
+    stripstop = x2;
+
+    colfunc = basecolfunc;
+
+    if (fixedcolormap)
+    {
+        walllights = scalelightfixed;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_RenderStrip
+// [JN] Draws one vertical strip of the view. BSP tree is walked only once
+// per frame on the main thread, strips are drawing recorded wall columns,
+// then parts of planes and masked things which are within their bounds.
+// -----------------------------------------------------------------------------
+
+static void R_RenderStrip (int strip)
+{
+    R_SetupStrip(R_StripStart(strip, numstrips),
+                 R_StripStart(strip + 1, numstrips) - 1);
+
+    // [JN] Phase timings are taken from the first strip,
+    // recorded wall columns are counted as a part of planes.
+    if (!strip)
+        I_PerfStart(PERF_PLANES);
+    R_ReplayColumns (strip);
+    R_DrawPlanes ();
+    if (!strip)
+    {
+        I_PerfStop(PERF_PLANES);
+        I_PerfStart(PERF_MASKED);
+    }
+    R_DrawMasked ();
+    if (!strip)
+        I_PerfStop(PERF_MASKED);
+}
+
 //
 // R_RenderView
 //
@@ -1101,6 +1157,7 @@ void R_RenderPlayerView (player_t *player)
 
     // Start frame
     R_SetupFrame (player);
+    R_SetupStrip(0, viewwidth - 1);
 
     // Clear buffers.
     R_ClearClipSegs ();
@@ -1122,20 +1179,52 @@ void R_RenderPlayerView (player_t *player)
         R_InterpolateTextureOffsets();
     }
 
+    numstrips = MIN(I_GetThreadCount(vid_render_threads), viewwidth);
+
+    if (numstrips > 1)
+    {
+        // [JN] Wall columns are recorded during the BSP walk and drawn by
+        // the strips. Pin their sources and everything else the strips
+        // look up in the zone memory until then, purging the rest.
+        Z_StartPinning();
+        R_StartRecordColumns(numstrips);
+    }
+
     // The head node is the last node output.
+    I_PerfStart(PERF_BSP);
     R_RenderBSPNode (numnodes-1);
+    I_PerfStop(PERF_BSP);
 
     // Check for new console commands.
     NetUpdate ();
 
-    R_DrawPlanes ();
-
-    // Check for new console commands.
-    NetUpdate ();
+    // [JN] Sort planes and things once for all strips.
+    R_SortPlanes ();
+    R_SortMasked ();
+    R_AddPSprites ();
 
     // [crispy] draw fuzz effect independent of rendering frame rate
-    R_SetFuzzPosDraw();
-    R_DrawMasked ();
+    R_SetFuzzPosDraw(numstrips > 1);
+
+    if (numstrips > 1)
+    {
+        R_StopRecordColumns();
+        I_RunThreadJobs(R_RenderStrip, numstrips);
+        Z_StopPinning();
+    }
+    else
+    {
+        I_PerfStart(PERF_PLANES);
+        R_DrawPlanes ();
+        I_PerfStop(PERF_PLANES);
+
+        // Check for new console commands.
+        NetUpdate ();
+
+        I_PerfStart(PERF_MASKED);
+        R_DrawMasked ();
+        I_PerfStop(PERF_MASKED);
+    }
 
     // Check for new console commands.
     NetUpdate ();
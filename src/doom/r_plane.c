@@ -76,28 +76,28 @@ int  ceilingclip[MAXWIDTH];  // [JN] 32-bit integer math
 // spanstart holds the start of a plane span
 // initialized to 0 at start
 //
-int			spanstart[MAXHEIGHT];
-int			spanstop[MAXHEIGHT];
+static THREADLOCAL int	spanstart[MAXHEIGHT];
 
 //
 // texture mapping
 //
-static lighttable_t**		planezlight;
-static fixed_t			planeheight;
+static THREADLOCAL lighttable_t**	planezlight;
+static THREADLOCAL fixed_t		planeheight;
+static THREADLOCAL void		(*planespanfunc) (void);  // [JN] spanfunc or plainspanfunc
 
 fixed_t*			yslope;
 fixed_t			yslopes[LOOKDIRS][MAXHEIGHT];
 fixed_t			distscale[MAXWIDTH];
 
-fixed_t			cachedheight[MAXHEIGHT];
-fixed_t			cacheddistance[MAXHEIGHT];
-fixed_t			cachedxstep[MAXHEIGHT];
-fixed_t			cachedystep[MAXHEIGHT];
+static THREADLOCAL fixed_t	cachedheight[MAXHEIGHT];
+static THREADLOCAL fixed_t	cacheddistance[MAXHEIGHT];
+static THREADLOCAL fixed_t	cachedxstep[MAXHEIGHT];
+static THREADLOCAL fixed_t	cachedystep[MAXHEIGHT];
 
 // [JN] Flowing effect for swirling liquids.
 // Render-only coords:
-static fixed_t swirlFlow_x;
-static fixed_t swirlFlow_y;
+static THREADLOCAL fixed_t swirlFlow_x;
+static THREADLOCAL fixed_t swirlFlow_y;
 // Actual coords, updates on game tic via P_UpdateSpecials:
 fixed_t swirlCoord_x;
 fixed_t swirlCoord_y;
@@ -112,16 +112,25 @@ void R_InitPlanes (void)
 }
 
 
+// [JN] Spans of a group of planes with the same flat, light level and
+// height, queued by R_MapPlane and drawn row by row by R_DrawPlaneSpans.
+// Every row has a list of its spans, linked by indexes.
+typedef struct
+{
+    int x1, x2;
+    int next;
+} planespan_t;
+
+static THREADLOCAL planespan_t *planespans;
+static THREADLOCAL int          numplanespans, maxplanespans;
+static THREADLOCAL int          spanrows[MAXHEIGHT];  // First span of a row, -1 if none
+static THREADLOCAL int          spanrowmin, spanrowmax;
+
 //
 // R_MapPlane
 //
-// Uses global vars:
-//  planeheight
-//  ds_source
-//  viewx
-//  viewy
-//
-// BASIC PRIMITIVE
+// Queues the span, it is drawn by R_DrawPlaneSpans
+// with other spans of the same row.
 //
 static void
 R_MapPlane
@@ -129,13 +138,6 @@ R_MapPlane
   int		x1,
   int		x2)
 {
-// [crispy] see below
-//  angle_t	angle;
-    fixed_t	distance;
-//  fixed_t	length;
-//  unsigned	index;
-    int dx, dy;
-	
 #ifdef RANGECHECK
     if (x2 < x1
      || x1 < 0
@@ -146,63 +148,121 @@ R_MapPlane
     }
 #endif
 
-    // [crispy] visplanes with the same flats now match up far better than before
-    // adapted from prboom-plus/src/r_plane.c:191-239, translated to fixed-point math
-    //
-    // SoM: because centery is an actual row of pixels (and it isn't really the
-    // center row because there are an even number of rows) some corrections need
-    // to be made depending on where the row lies relative to the centery row.
-
-    if (centery == y)
+    if (numplanespans == maxplanespans)
     {
-	return;
+        maxplanespans = maxplanespans ? maxplanespans * 2 : 1024;
+        planespans = I_Realloc(planespans, maxplanespans * sizeof(*planespans));
     }
 
-    dy = (abs(centery - y) << FRACBITS) + (y < centery ? -FRACUNIT : FRACUNIT) / 2;
+    planespans[numplanespans].x1 = x1;
+    planespans[numplanespans].x2 = x2;
+    planespans[numplanespans].next = spanrows[y];
+    spanrows[y] = numplanespans++;
 
-    if (planeheight != cachedheight[y])
-    {
-	cachedheight[y] = planeheight;
-	distance = cacheddistance[y] = FixedMul (planeheight, yslope[y]);
-	// [FG] avoid right-shifting in FixedMul() followed by left-shifting in FixedDiv()
-	ds_xstep = cachedxstep[y] = (fixed_t)((int64_t)viewsin * planeheight / dy) << detailshift;
-	ds_ystep = cachedystep[y] = (fixed_t)((int64_t)viewcos * planeheight / dy) << detailshift;
-    }
-    else
+    spanrowmin = MIN(spanrowmin, y);
+    spanrowmax = MAX(spanrowmax, y);
+}
+
+//
+// R_DrawPlaneSpans
+//
+// Uses global vars:
+//  planeheight
+//  ds_source
+//  viewx
+//  viewy
+//
+// BASIC PRIMITIVE
+//
+// [JN] Draws queued spans a row at a time. Distance, steps and colormap
+// of a row are the same for all of its spans, so they are found once.
+//
+static void R_DrawPlaneSpans (void)
+{
+// [crispy] see below
+//  angle_t	angle;
+    fixed_t	distance;
+//  fixed_t	length;
+//  unsigned	index;
+    int dy;
+
+    for (int y = spanrowmin ; y <= spanrowmax ; y++)
     {
-	distance = cacheddistance[y];
-	ds_xstep = cachedxstep[y];
-	ds_ystep = cachedystep[y];
-    }
+        int i = spanrows[y];
 
-    dx = x1 - centerx;
+        if (i < 0)
+        {
+            continue;
+        }
 
-    ds_xfrac = viewx + FixedMul(viewcos, distance) + dx * ds_xstep;
-    ds_yfrac = -viewy - FixedMul(viewsin, distance) + dx * ds_ystep;
+        spanrows[y] = -1;
 
-    // [JN] Add flowing offsets.
-    ds_xfrac += swirlFlow_x;
-    ds_yfrac += swirlFlow_y;
+        // [crispy] visplanes with the same flats now match up far better than before
+        // adapted from prboom-plus/src/r_plane.c:191-239, translated to fixed-point math
+        //
+        // SoM: because centery is an actual row of pixels (and it isn't really the
+        // center row because there are an even number of rows) some corrections need
+        // to be made depending on where the row lies relative to the centery row.
 
-    if (fixedcolormap)
-	ds_colormap[0] = ds_colormap[1] = fixedcolormap;
-    else
-    {
-	unsigned int index = distance >> LIGHTZSHIFT;
-	
-	if (index >= MAXLIGHTZ )
-	    index = MAXLIGHTZ-1;
+        if (centery == y)
+        {
+            continue;
+        }
+
+        dy = (abs(centery - y) << FRACBITS) + (y < centery ? -FRACUNIT : FRACUNIT) / 2;
+
+        if (planeheight != cachedheight[y])
+        {
+            cachedheight[y] = planeheight;
+            distance = cacheddistance[y] = FixedMul (planeheight, yslope[y]);
+            // [FG] avoid right-shifting in FixedMul() followed by left-shifting in FixedDiv()
+            ds_xstep = cachedxstep[y] = (fixed_t)((int64_t)viewsin * planeheight / dy) << detailshift;
+            ds_ystep = cachedystep[y] = (fixed_t)((int64_t)viewcos * planeheight / dy) << detailshift;
+        }
+        else
+        {
+            distance = cacheddistance[y];
+            ds_xstep = cachedxstep[y];
+            ds_ystep = cachedystep[y];
+        }
+
+        if (fixedcolormap)
+            ds_colormap[0] = ds_colormap[1] = fixedcolormap;
+        else
+        {
+            unsigned int index = distance >> LIGHTZSHIFT;
+
+            if (index >= MAXLIGHTZ )
+                index = MAXLIGHTZ-1;
+
+            ds_colormap[0] = planezlight[index];
+            ds_colormap[1] = colormaps;
+        }
+
+        ds_y = y;
+
+        for ( ; i >= 0 ; i = planespans[i].next)
+        {
+            const int dx = planespans[i].x1 - centerx;
+
+            ds_xfrac = viewx + FixedMul(viewcos, distance) + dx * ds_xstep;
+            ds_yfrac = -viewy - FixedMul(viewsin, distance) + dx * ds_ystep;
 
-	ds_colormap[0] = planezlight[index];
-	ds_colormap[1] = colormaps;
+            // [JN] Add flowing offsets.
+            ds_xfrac += swirlFlow_x;
+            ds_yfrac += swirlFlow_y;
+
+            ds_x1 = planespans[i].x1;
+            ds_x2 = planespans[i].x2;
+
+            // high or low detail
+            planespanfunc ();
+        }
     }
-	
-    ds_y = y;
-    ds_x1 = x1;
-    ds_x2 = x2;
 
-    // high or low detail
-    spanfunc ();	
+    numplanespans = 0;
+    spanrowmin = MAXHEIGHT;
+    spanrowmax = -1;
 }
 
 
@@ -237,9 +297,6 @@ void R_ClearPlanes (void)
     }
 
     lastopening = openings;
-
-    // texture calculation
-    memset(cachedheight, 0, sizeof(cachedheight));
 }
 
 // -----------------------------------------------------------------------------
@@ -412,19 +469,119 @@ R_MakeSpans
 
 
 
+// -----------------------------------------------------------------------------
+// R_ComparePlanes
+// [JN] Sorting order of visplanes: by flat, then by light level and height.
+// Visplanes never overlap each other, so drawing order doesn't matter.
+// -----------------------------------------------------------------------------
+
+static int R_ComparePlanes (const void *a, const void *b)
+{
+    const visplane_t *const pa = *(visplane_t *const *) a;
+    const visplane_t *const pb = *(visplane_t *const *) b;
+
+    if (pa->picnum != pb->picnum)
+    {
+        return pa->picnum < pb->picnum ? -1 : 1;
+    }
+    if (pa->lightlevel != pb->lightlevel)
+    {
+        return pa->lightlevel < pb->lightlevel ? -1 : 1;
+    }
+    if (pa->height != pb->height)
+    {
+        return pa->height < pb->height ? -1 : 1;
+    }
+
+    return 0;
+}
+
+//
+// R_SortPlanes
+// [JN] Planes are drawn grouped by flat, so each flat is resolved, cached
+// and released only once per frame. Spans of planes with the same flat,
+// light level and height are drawn together, a row at a time.
+// Called once per frame, before the planes of any strip are drawn.
+//
+
+static visplane_t **sortedplanes;
+static int          maxsortedplanes;
+static int          numsortedplanes;
+
+void R_SortPlanes (void)
+{
+    numsortedplanes = 0;
+
+    for (int i = 0 ; i < MAXVISPLANES ; i++)
+    for (visplane_t *pl = visplanes[i] ; pl ; pl = pl->next)
+    {
+        if (numsortedplanes == maxsortedplanes)
+        {
+            maxsortedplanes = maxsortedplanes ? maxsortedplanes * 2 : 128;
+            sortedplanes = I_Realloc(sortedplanes, maxsortedplanes * sizeof(*sortedplanes));
+        }
+        sortedplanes[numsortedplanes++] = pl;
+    }
+
+    qsort(sortedplanes, numsortedplanes, sizeof(*sortedplanes), R_ComparePlanes);
+
+    // [JN] CRL - openings counter.
+    IDRender.numopenings = lastopening - openings;
+    IDRender.numplanes = numsortedplanes;
+
+    for (int i = 0 ; i < numsortedplanes ; i++)
+    {
+        const int picnum = sortedplanes[i]->picnum;
+
+        if (picnum != skyflatnum && !(picnum & PL_SKYFLAT)
+        && (i == 0 || picnum != sortedplanes[i-1]->picnum))
+        {
+            IDRender.numflatswitches++;
+        }
+    }
+}
+
 //
 // R_DrawPlanes
 // At the end of each frame.
 //
+
 void R_DrawPlanes (void)
 {
-    // [JN] CRL - openings counter.
-    IDRender.numopenings = lastopening - openings;
+    int flatpicnum = -1;      // [JN] Flat that is currently cached...
+    int flatlumpnum = -1;     // ...its lump...
+    boolean swirling = false; // ...and whether it is a swirling one.
+    const visplane_t *spanplane = NULL;  // [JN] Last plane with queued spans.
 
-    for (int i = 0 ; i < MAXVISPLANES ; i++)
-    for (visplane_t *pl = visplanes[i] ; pl ; pl = pl->next, IDRender.numplanes++)
-    if (pl->minx <= pl->maxx)
+    // texture calculation
+    memset(cachedheight, 0, sizeof(cachedheight));
+    memset(spanrows, -1, sizeof(spanrows));
+    numplanespans = 0;
+    spanrowmin = MAXHEIGHT;
+    spanrowmax = -1;
+
+    for (int i = 0 ; i < numsortedplanes ; i++)
     {
+        visplane_t *const pl = sortedplanes[i];
+
+        // [JN] Draw only columns of the current strip.
+        const int minx = MAX(pl->minx, stripstart);
+        const int maxx = MIN(pl->maxx, stripstop);
+
+        if (minx > maxx)
+        {
+            continue;
+        }
+
+        // [JN] Draw queued spans once their group of planes is over.
+        if (spanplane && (pl->picnum != spanplane->picnum
+                      ||  pl->lightlevel != spanplane->lightlevel
+                      ||  pl->height != spanplane->height))
+        {
+            R_DrawPlaneSpans();
+            spanplane = NULL;
+        }
+
         // sky flat
         // [crispy] add support for MBF sky tranfers
         if (pl->picnum == skyflatnum || pl->picnum & PL_SKYFLAT)
@@ -454,6 +611,7 @@ void R_DrawPlanes (void)
             dc_colormap[0] = dc_colormap[1] = vis_invul_sky && fixedcolormap ? 
                                               fixedcolormap : colormaps;
             dc_texheight = textureheight[texture]>>FRACBITS;
+            colfunc = plaincolfunc;
 
             // [crispy] stretch short skies
             if (mouse_look && dc_texheight < 200)
@@ -461,7 +619,7 @@ void R_DrawPlanes (void)
                 dc_iscale = (dc_iscale * dc_texheight) / SKYSTRETCH_HEIGHT;  // [PN] Adjust scale
                 dc_texturemid = (dc_texturemid * dc_texheight) / SKYSTRETCH_HEIGHT;  // [PN] Adjust mid
             }
-            for (int x = pl->minx ; x <= pl->maxx ; x++)
+            for (int x = minx ; x <= maxx ; x++)
             {
                 if ((dc_yl = pl->top[x]) != USHRT_MAX && dc_yl <= (dc_yh = pl->bottom[x]))
                 {
@@ -470,47 +628,74 @@ void R_DrawPlanes (void)
                                         linearskyangle[x] : xtoviewangle[x]))^flip)>>ANGLETOSKYSHIFT;
                     dc_x = x;
                     dc_source = R_GetColumnMod2(texture, angle);
-                    colfunc ();
+                    R_QueueColumn ();
                 }
             }
+
+            R_FlushColumns ();
+            colfunc = basecolfunc;
         }
         else  // regular flat
         {
-            const boolean swirling = (flattranslation[pl->picnum] == -1);
-            const int stop = pl->maxx + 1;
-            const int lumpnum = firstflat + (swirling ? pl->picnum : flattranslation[pl->picnum]);
+            const int stop = maxx + 1;
 
-            // [crispy] add support for SMMU swirling flats
-            ds_source = swirling ? R_DistortedFlat(lumpnum) : W_CacheLumpNum(lumpnum, PU_STATIC);
-            ds_brightmap = R_BrightmapForFlatNum(lumpnum-firstflat);
-
-            // [JN] Apply flowing effect to swirling liquids.
-            if (swirling)
-            {
-                swirlFlow_x = swirlCoord_x;
-                swirlFlow_y = swirlCoord_y;
-            }
-            else
+            // [JN] Resolve the flat once for all planes using it.
+            if (pl->picnum != flatpicnum)
             {
-                swirlFlow_x = 0;
-                swirlFlow_y = 0;
+                if (flatlumpnum != -1 && !swirling)
+                {
+                    W_ReleaseLumpNum(flatlumpnum);
+                }
+
+                flatpicnum = pl->picnum;
+                swirling = (flattranslation[pl->picnum] == -1);
+                flatlumpnum = firstflat + (swirling ? pl->picnum : flattranslation[pl->picnum]);
+
+                // [crispy] add support for SMMU swirling flats
+                ds_source = swirling ? R_DistortedFlat(flatlumpnum) : W_CacheLumpNum(flatlumpnum, PU_STATIC);
+                ds_brightmap = R_BrightmapForFlatNum(flatlumpnum-firstflat);
+
+                // [JN] Pick brightmap-free drawer once per flat.
+                planespanfunc = fixedcolormap || ds_brightmap == nobrightmap ?
+                                plainspanfunc : spanfunc;
+
+                // [JN] Apply flowing effect to swirling liquids.
+                if (swirling)
+                {
+                    swirlFlow_x = swirlCoord_x;
+                    swirlFlow_y = swirlCoord_y;
+                }
+                else
+                {
+                    swirlFlow_x = 0;
+                    swirlFlow_y = 0;
+                }
             }
 
             planeheight = abs(pl->height-viewz);
             // [PN] Ensure 'light' is within the range [0, LIGHTLEVELS - 1] inclusively.
             const int light = BETWEEN(0, LIGHTLEVELS-1, (pl->lightlevel >> LIGHTSEGSHIFT) + (extralight * LIGHTBRIGHT));
             planezlight = zlight[light];
-            pl->top[pl->minx-1] = pl->top[stop] = USHRT_MAX;
 
-            for (int x = pl->minx ; x <= stop ; x++)
+            // [JN] Columns next to the strip belong to other threads, so
+            // instead of USHRT_MAX marks in pl->top[], pass an empty column
+            // for the first and the last step.
+            R_MakeSpans(minx, USHRT_MAX, 0, pl->top[minx], pl->bottom[minx]);
+
+            for (int x = minx + 1 ; x < stop ; x++)
             {
                 R_MakeSpans(x,pl->top[x-1], pl->bottom[x-1], pl->top[x], pl->bottom[x]);
             }
 
-            if (!swirling)
-            {
-                W_ReleaseLumpNum(lumpnum);
-            }
+            R_MakeSpans(stop, pl->top[stop-1], pl->bottom[stop-1], USHRT_MAX, 0);
+            spanplane = pl;
         }
     }
+
+    R_DrawPlaneSpans();
+
+    if (flatlumpnum != -1 && !swirling)
+    {
+        W_ReleaseLumpNum(flatlumpnum);
+    }
 }
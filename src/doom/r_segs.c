@@ -55,7 +55,7 @@ static int		rw_stopx;
 static angle_t		rw_centerangle;
 static fixed_t		rw_offset;
 static fixed_t		rw_scale;
-static fixed_t		rw_scalestep;
+static THREADLOCAL fixed_t		rw_scalestep;
 static fixed_t		rw_midtexturemid;
 static fixed_t		rw_toptexturemid;
 static fixed_t		rw_bottomtexturemid;
@@ -78,9 +78,9 @@ static int64_t		bottomfrac; // [crispy] WiggleFix
 static fixed_t		bottomstep;
 
 
-lighttable_t**	walllights;
+THREADLOCAL lighttable_t**	walllights;
 
-int *maskedtexturecol;  // [JN] 32-bit integer math
+THREADLOCAL int *maskedtexturecol;  // [JN] 32-bit integer math
 
 
 // [crispy] WiggleFix: add this code block near the top of r_segs.c
@@ -184,6 +184,15 @@ void R_FixWiggle (sector_t *sector)
 
 void R_RenderMaskedSegRange (drawseg_t *ds, int x1, int x2)
 {
+    // [JN] Draw only columns of the current strip.
+    x1 = MAX(x1, stripstart);
+    x2 = MIN(x2, stripstop);
+
+    if (x1 > x2)
+    {
+        return;
+    }
+
     // Calculate light table.
     // Use different light tables
     //   for horizontal / vertical / diagonal. Diagonal?
@@ -224,6 +233,12 @@ void R_RenderMaskedSegRange (drawseg_t *ds, int x1, int x2)
     if (fixedcolormap)
     dc_colormap[0] = dc_colormap[1] = fixedcolormap;
 
+    // [JN] Pick brightmap-free drawer once per range.
+    if (fixedcolormap || !vis_brightmaps || texturebrightmap[texnum] == nobrightmap)
+    {
+        colfunc = plaincolfunc;
+    }
+
     // draw the columns
     for (dc_x = x1 ; dc_x <= x2 ; dc_x++)
     {
@@ -276,6 +291,9 @@ void R_RenderMaskedSegRange (drawseg_t *ds, int x1, int x2)
 
         spryscale += rw_scalestep;
     }
+
+    R_FlushColumns ();
+    colfunc = basecolfunc;
 }
 
 // -----------------------------------------------------------------------------
@@ -295,6 +313,16 @@ void R_RenderSegLoop (void)
 {
     fixed_t texturecolumn = 0;  // [JN] Purely to shut up the compiler.
 
+    // [JN] Pick brightmap-free drawer once per seg for every wall tier.
+    // Nothing can be bright with fixed colormap or disabled brightmaps.
+    const boolean plain = fixedcolormap || !vis_brightmaps;
+    void (*const midcolfunc) (void) =
+        plain || texturebrightmap[midtexture] == nobrightmap ? plaincolfunc : basecolfunc;
+    void (*const topcolfunc) (void) =
+        plain || texturebrightmap[toptexture] == nobrightmap ? plaincolfunc : basecolfunc;
+    void (*const bottomcolfunc) (void) =
+        plain || texturebrightmap[bottomtexture] == nobrightmap ? plaincolfunc : basecolfunc;
+
     for ( ; rw_x < rw_stopx ; rw_x++)
     {
         // mark floor / ceiling areas
@@ -387,7 +415,8 @@ void R_RenderSegLoop (void)
             dc_source = R_GetColumn(midtexture, texturecolumn);
             dc_texheight = textureheight[midtexture] >> FRACBITS;
             dc_brightmap = texturebrightmap[midtexture];
-            colfunc ();
+            colfunc = midcolfunc;
+            R_QueueColumn ();
             ceilingclip[rw_x] = viewheight;
             floorclip[rw_x] = -1;
         }
@@ -408,7 +437,8 @@ void R_RenderSegLoop (void)
                     dc_source = R_GetColumn(toptexture,texturecolumn);
                     dc_texheight = textureheight[toptexture]>>FRACBITS;
                     dc_brightmap = texturebrightmap[toptexture];
-                    colfunc ();
+                    colfunc = topcolfunc;
+                    R_QueueColumn ();
                     ceilingclip[rw_x] = mid;
                 }
                 else
@@ -439,7 +469,8 @@ void R_RenderSegLoop (void)
                     dc_source = R_GetColumn(bottomtexture,texturecolumn);
                     dc_texheight = textureheight[bottomtexture]>>FRACBITS;
                     dc_brightmap = texturebrightmap[bottomtexture];
-                    colfunc ();
+                    colfunc = bottomcolfunc;
+                    R_QueueColumn ();
                     floorclip[rw_x] = mid;
                 }
                 else
@@ -475,6 +506,9 @@ void R_RenderSegLoop (void)
     topfrac += topstep;
     bottomfrac += bottomstep;
     }
+
+    R_FlushColumns ();
+    colfunc = basecolfunc;
 }
 
 
@@ -46,6 +46,11 @@
 static size_t num_vissprite, num_vissprite_alloc, num_vissprite_ptrs; // killough
 static vissprite_t *vissprites, **vissprite_ptrs;                     // killough
 
+// [JN] Player sprites are projected once per frame, before the strips
+// are rendered, so weapon bobbing interpolation is done only once.
+static vissprite_t pspritevis[NUMPSPRITES];
+static int         numpspritevis;
+
 typedef struct drawseg_xrange_item_s
 {
     short x1, x2;
@@ -56,13 +61,22 @@ typedef struct drawsegs_xrange_s
 {
     drawseg_xrange_item_t *items;
     int count;
+    int size;
 } drawsegs_xrange_t;
 
-#define DS_RANGES_COUNT 3
-static drawsegs_xrange_t drawsegs_xranges[DS_RANGES_COUNT];
-static drawseg_xrange_item_t *drawsegs_xrange;
-static unsigned int drawsegs_xrange_size = 0;
-static int drawsegs_xrange_count = 0;
+// [JN] Drawsegs index for sprite clipping, built once per frame in
+// R_DrawMasked. On every level the screen is split into buckets of
+// (1 << (DS_BUCKETBITS + level)) columns, and every bucket holds the
+// drawsegs overlapping it, latest first. A sprite is checked only
+// against two neighbour buckets of the smallest level covering it,
+// instead of scanning all the drawsegs.
+#define DS_BUCKETBITS 5
+#define DS_MAXLEVELS  16
+
+static drawsegs_xrange_t *drawsegs_xranges;
+static int drawsegs_xranges_size;
+static int drawsegs_levels;
+static int drawsegs_levelbase[DS_MAXLEVELS];
 
 
 //
@@ -358,11 +372,11 @@ static vissprite_t *R_NewVisSprite (void)
 // Masked means: partly transparent, i.e. stored in posts/runs of opaque pixels.
 // -----------------------------------------------------------------------------
 
-int *mfloorclip;    // [JN] 32-bit integer math
-int *mceilingclip;  // [JN] 32-bit integer math
+THREADLOCAL int *mfloorclip;    // [JN] 32-bit integer math
+THREADLOCAL int *mceilingclip;  // [JN] 32-bit integer math
 
-fixed_t spryscale;
-int64_t sprtopscreen; // [crispy] WiggleFix
+THREADLOCAL fixed_t spryscale;
+THREADLOCAL int64_t sprtopscreen; // [crispy] WiggleFix
 
 void R_DrawMaskedColumn (column_t *column)
 {
@@ -408,7 +422,7 @@ void R_DrawMaskedColumn (column_t *column)
             dc_texturemid = basetexturemid - (top<<FRACBITS);
     
             // Drawn by either R_DrawColumn or (SHADOW) R_DrawFuzzColumn.
-            colfunc ();	
+            R_QueueColumn ();
         }
         column = (column_t *)(  (byte *)column + column->length + 4);
     }
@@ -481,6 +495,11 @@ static void R_DrawVisSprite (vissprite_t *vis)
 	        colfunc = tlcolfunc;
 	    }
     }
+    // [JN] Brightmap-free drawer for opaque sprites.
+    else if (dc_brightmap == nobrightmap || dc_colormap[0] == dc_colormap[1])
+    {
+	colfunc = plaincolfunc;
+    }
 	
     dc_iscale = abs(vis->xiscale)>>detailshift;
     dc_texturemid = vis->texturemid;
@@ -500,6 +519,7 @@ static void R_DrawVisSprite (vissprite_t *vis)
 	R_DrawMaskedColumn (column);
     }
 
+    R_FlushColumns ();
     colfunc = basecolfunc;
 }
 
@@ -924,12 +944,12 @@ static inline void R_ApplyWeaponBob (fixed_t *sx, boolean bobx, fixed_t *sy, boo
 }
 
 //
-// R_DrawPSprite
+// R_ProjectPSprite
 //
 
 boolean pspr_interp = true; // interpolate weapon bobbing
 
-static void R_DrawPSprite (pspdef_t* psp)
+static void R_ProjectPSprite (pspdef_t* psp)
 {
     fixed_t		tx;
     int			x1;
@@ -939,7 +959,6 @@ static void R_DrawPSprite (pspdef_t* psp)
     int			lump;
     boolean		flip;
     vissprite_t*	vis;
-    vissprite_t		avis;
 
     fixed_t         psp_sx = psp->r_sx, psp_sy = psp->r_sy;    
     const int state = viewplayer->psprites[ps_weapon].state - states;       // [crispy]
@@ -1008,7 +1027,7 @@ static void R_DrawPSprite (pspdef_t* psp)
 	return;
     
     // store information in a vissprite
-    vis = &avis;
+    vis = &pspritevis[numpspritevis++];
     vis->translation = NULL; // [crispy] no color translation
     vis->mobjflags = 0;
     // [crispy] weapons drawn 1 pixel too high when player is idle
@@ -1104,16 +1123,23 @@ static void R_DrawPSprite (pspdef_t* psp)
 
     // [crispy] free look
     vis->texturemid += FixedMul(((centery - viewheight / 2) << FRACBITS), pspriteiscale) >> detailshift;
-
-    R_DrawVisSprite (vis);
 }
 
 // -----------------------------------------------------------------------------
-// R_DrawPlayerSprites
+// R_AddPSprites
+// [JN] Projects player sprites of the current frame. Called once per frame
+// from the main thread, before the strips are rendered.
 // -----------------------------------------------------------------------------
 
-static void R_DrawPlayerSprites (void)
+void R_AddPSprites (void)
 {
+    numpspritevis = 0;
+
+    // draw the psprites on top of everything
+    //  but does not draw on side views
+    if (viewangleoffset)
+        return;
+
     // RestlessRodent -- Do not draw player gun sprite if spectating
     if (crl_spectating)
         return;
@@ -1124,17 +1150,55 @@ static void R_DrawPlayerSprites (void)
                        + (extralight * LIGHTBRIGHT));
     spritelights = scalelight[lightnum];
 
-    // clip to screen bounds
-    mfloorclip = screenheightarray;
-    mceilingclip = negonearray;
-
     // add all active psprites
     int i;
     pspdef_t *psp;
     for (i = 0, psp = viewplayer->psprites; i < NUMPSPRITES; i++, psp++)
     {
         if (psp->state)
-            R_DrawPSprite(psp);
+            R_ProjectPSprite(psp);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_ClipVisSprite
+// [JN] Clips vissprite to given columns. Returns false if nothing is left.
+// -----------------------------------------------------------------------------
+
+boolean R_ClipVisSprite (vissprite_t *vis, int xl, int xh)
+{
+    if (vis->x1 > xh || vis->x2 < xl)
+        return false;
+
+    if (vis->x1 < xl)
+    {
+        vis->startfrac += vis->xiscale * (xl - vis->x1);
+        vis->x1 = xl;
+    }
+    if (vis->x2 > xh)
+    {
+        vis->x2 = xh;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// R_DrawPlayerSprites
+// -----------------------------------------------------------------------------
+
+static void R_DrawPlayerSprites (void)
+{
+    // clip to screen bounds
+    mfloorclip = screenheightarray;
+    mceilingclip = negonearray;
+
+    for (int i = 0 ; i < numpspritevis ; i++)
+    {
+        vissprite_t vis = pspritevis[i];
+
+        if (R_ClipVisSprite(&vis, stripstart, stripstop))
+            R_DrawVisSprite(&vis);
     }
 }
 
@@ -1188,6 +1252,78 @@ static void msort(vissprite_t **s, vissprite_t **t, const int n)
     }
 }
 
+// -----------------------------------------------------------------------------
+// R_RadixSortVisSprites
+// [JN] Stable LSD radix sort by descending scale, eight bits per pass.
+// Gives exactly the same order as msort, which is still used for small
+// counts. "t" is a scratch buffer of "n" pointers.
+// -----------------------------------------------------------------------------
+
+#define VISSORT_RADIX 64
+
+static inline unsigned int VisSpriteKey (const vissprite_t *spr)
+{
+    // Signed scale to unsigned, inverted for descending order.
+    return ~((unsigned int) spr->scale ^ 0x80000000u);
+}
+
+static void R_RadixSortVisSprites (vissprite_t **s, vissprite_t **t, const int n)
+{
+    vissprite_t **const dest = s;
+    int count[4][256];
+    int pass;
+    int i;
+
+    memset(count, 0, sizeof(count));
+
+    for (i = 0; i < n; i++)
+    {
+        const unsigned int key = VisSpriteKey(s[i]);
+
+        count[0][key & 0xff]++;
+        count[1][(key >> 8) & 0xff]++;
+        count[2][(key >> 16) & 0xff]++;
+        count[3][key >> 24]++;
+    }
+
+    for (pass = 0; pass < 4; pass++)
+    {
+        const int shift = pass * 8;
+        int *c = count[pass];
+        int sum = 0;
+        vissprite_t **swap;
+
+        // All keys have the same digit, nothing to do on this pass.
+        if (c[(VisSpriteKey(s[0]) >> shift) & 0xff] == n)
+        {
+            continue;
+        }
+
+        for (i = 0; i < 256; i++)
+        {
+            const int tmp = c[i];
+
+            c[i] = sum;
+            sum += tmp;
+        }
+
+        for (i = 0; i < n; i++)
+        {
+            t[c[(VisSpriteKey(s[i]) >> shift) & 0xff]++] = s[i];
+        }
+
+        swap = s;
+        s = t;
+        t = swap;
+    }
+
+    // Odd number of passes made, result is in the scratch buffer.
+    if (s != dest)
+    {
+        bcopyp(dest, s, n);
+    }
+}
+
 // -----------------------------------------------------------------------------
 // R_SortVisSprites
 // -----------------------------------------------------------------------------
@@ -1220,8 +1356,12 @@ static void R_SortVisSprites (void)
 
         // killough 9/22/98: replace qsort with merge sort, since the keys
         // are roughly in order to begin with, due to BSP rendering.
+        // [JN] Radix sort is faster with many sprites, both are stable.
 
-        msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+        if (num_vissprite < VISSORT_RADIX)
+            msort(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
+        else
+            R_RadixSortVisSprites(vissprite_ptrs, vissprite_ptrs + num_vissprite, num_vissprite);
     }
 }
 
@@ -1241,25 +1381,65 @@ static void R_DrawSprite (vissprite_t* spr)
     fixed_t		scale;
     fixed_t		lowscale;
     int			silhouette;
+    int			level;
+    int			shift;
+    const drawsegs_xrange_t *range1;
+    const drawsegs_xrange_t *range2;
+    const drawseg_xrange_item_t *item;
+    int			i1 = 0;
+    int			i2 = 0;
 		
     for (x = spr->x1 ; x<=spr->x2 ; x++)
 	clipbot[x] = cliptop[x] = -2;
-    
+
+    // [JN] Find the smallest level where the sprite
+    // is covered by at most two neighbour buckets.
+    for (level = 0 ; level < drawsegs_levels - 1 ; level++)
+    {
+	shift = DS_BUCKETBITS + level;
+
+	if ((spr->x2 >> shift) - (spr->x1 >> shift) <= 1)
+	    break;
+    }
+
+    shift = DS_BUCKETBITS + level;
+    range1 = &drawsegs_xranges[drawsegs_levelbase[level] + (spr->x1 >> shift)];
+    range2 = &drawsegs_xranges[drawsegs_levelbase[level] + (spr->x2 >> shift)];
+
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale
     //  is the clip seg.
-    for (ds=ds_p-1 ; ds >= drawsegs ; ds--)
+    // [JN] Both buckets are sorted from end to start, so merge them,
+    // taking drawsegs present in both buckets only once.
+    for (;;)
     {
+	if (i1 < range1->count
+	 && (range1 == range2 || i2 >= range2->count
+	  || range1->items[i1].user > range2->items[i2].user))
+	{
+	    item = &range1->items[i1++];
+	}
+	else if (range1 != range2 && i2 < range2->count)
+	{
+	    item = &range2->items[i2++];
+
+	    if (i1 < range1->count && range1->items[i1].user == item->user)
+		i1++;
+	}
+	else
+	{
+	    break;
+	}
+
 	// determine if the drawseg obscures the sprite
-	if (ds->x1 > spr->x2
-	    || ds->x2 < spr->x1
-	    || (!ds->silhouette
-		&& !ds->maskedtexturecol) )
+	if (item->x1 > spr->x2 || item->x2 < spr->x1)
 	{
 	    // does not cover sprite
 	    continue;
 	}
-			
+
+	ds = item->user;
+
 	r1 = ds->x1 < spr->x1 ? spr->x1 : ds->x1;
 	r2 = ds->x2 > spr->x2 ? spr->x2 : ds->x2;
 
@@ -1341,89 +1521,119 @@ static void R_DrawSprite (vissprite_t* spr)
 }
 
 // -------------------------------------------------------------------------
-// R_DrawMasked
+// R_BuildDrawsegsIndex
+// [JN] Puts drawsegs that may clip sprites into buckets of every level,
+// going from end to start, so every bucket is in R_DrawSprite order.
 // -------------------------------------------------------------------------
 
-void R_DrawMasked (void)
+static void R_BuildDrawsegsIndex (void)
 {
-    int        i;
     drawseg_t *ds;
+    int        numranges = 0;
+    int        level;
+    int        i;
 
-    R_SortVisSprites();
+    for (level = 0 ; level < DS_MAXLEVELS ; level++)
+    {
+        const int shift = DS_BUCKETBITS + level;
+
+        drawsegs_levelbase[level] = numranges;
+        numranges += ((viewwidth - 1) >> shift) + 1;
+
+        // [JN] Top level covers any sprite with two buckets.
+        if (((viewwidth - 1) >> shift) <= 1)
+        {
+            level++;
+            break;
+        }
+    }
+
+    drawsegs_levels = level;
 
-    // [JN] Andrey Budko
-    // Makes sense for scenes with huge amount of drawsegs.
-    // ~12% of speed improvement on epic.wad map05
-    for (i = 0 ; i < DS_RANGES_COUNT ; i++)
+    if (drawsegs_xranges_size < numranges)
+    {
+        drawsegs_xranges = I_Realloc(drawsegs_xranges,
+                                     numranges * sizeof(*drawsegs_xranges));
+        memset(drawsegs_xranges + drawsegs_xranges_size, 0,
+               (numranges - drawsegs_xranges_size) * sizeof(*drawsegs_xranges));
+        drawsegs_xranges_size = numranges;
+    }
+
+    for (i = 0 ; i < numranges ; i++)
     {
         drawsegs_xranges[i].count = 0;
     }
 
-    if (num_vissprite > 0)
+    for (ds = ds_p ; ds-- > drawsegs ; )
     {
-        if (drawsegs_xrange_size < maxdrawsegs)
+        if (!ds->silhouette && !ds->maskedtexturecol)
         {
-            drawsegs_xrange_size = 2 * maxdrawsegs;
-
-            for(i = 0; i < DS_RANGES_COUNT; i++)
-            {
-                drawsegs_xranges[i].items = I_Realloc(
-                drawsegs_xranges[i].items,
-                drawsegs_xrange_size * sizeof(drawsegs_xranges[i].items[0]));
-            }
+            continue;
         }
 
-        for (ds = ds_p; ds-- > drawsegs;)
+        for (level = 0 ; level < drawsegs_levels ; level++)
         {
-            if (ds->silhouette || ds->maskedtexturecol)
-            {
-                drawsegs_xranges[0].items[drawsegs_xranges[0].count].x1 = ds->x1;
-                drawsegs_xranges[0].items[drawsegs_xranges[0].count].x2 = ds->x2;
-                drawsegs_xranges[0].items[drawsegs_xranges[0].count].user = ds;
+            const int shift = DS_BUCKETBITS + level;
+            drawsegs_xrange_t *range = &drawsegs_xranges[drawsegs_levelbase[level]];
+            int b;
 
-                // [JN] Andrey Budko: ~13% of speed improvement on sunder.wad map10
-                if (ds->x1 < centerx)
-                {
-                    drawsegs_xranges[1].items[drawsegs_xranges[1].count] = 
-                    drawsegs_xranges[0].items[drawsegs_xranges[0].count];
-                    drawsegs_xranges[1].count++;
-                }
-                if (ds->x2 >= centerx)
+            for (b = ds->x1 >> shift ; b <= ds->x2 >> shift ; b++)
+            {
+                if (range[b].count == range[b].size)
                 {
-                    drawsegs_xranges[2].items[drawsegs_xranges[2].count] = 
-                    drawsegs_xranges[0].items[drawsegs_xranges[0].count];
-                    drawsegs_xranges[2].count++;
+                    range[b].size = range[b].size ? range[b].size * 2 : 64;
+                    range[b].items = I_Realloc(range[b].items,
+                                               range[b].size * sizeof(*range[b].items));
                 }
 
-                drawsegs_xranges[0].count++;
+                range[b].items[range[b].count].x1 = ds->x1;
+                range[b].items[range[b].count].x2 = ds->x2;
+                range[b].items[range[b].count].user = ds;
+                range[b].count++;
             }
         }
     }
+}
 
-    // draw all vissprites back to front
+// -------------------------------------------------------------------------
+// R_SortMasked
+// [JN] Sorts vissprites and builds drawsegs index for R_DrawMasked.
+// Called once per frame, before the masked parts of any strip are drawn.
+// -------------------------------------------------------------------------
+
+void R_SortMasked (void)
+{
+    R_SortVisSprites();
+
+    if (num_vissprite > 0)
+    {
+        R_BuildDrawsegsIndex();
+    }
 
     IDRender.numsprites = num_vissprite;
+}
+
+// -------------------------------------------------------------------------
+// R_DrawMasked
+// -------------------------------------------------------------------------
+
+void R_DrawMasked (void)
+{
+    int        i;
+    drawseg_t *ds;
+
+    // draw all vissprites back to front
+
     for (i = num_vissprite ; --i>=0 ; )
     {
-        vissprite_t* spr = vissprite_ptrs[i];
+        // [JN] Draw only the part within current strip. Vissprites are
+        // shared by all strips, so clip a copy of it.
+        vissprite_t spr = *vissprite_ptrs[i];
 
-        if (spr->x2 < centerx)
-        {
-            drawsegs_xrange = drawsegs_xranges[1].items;
-            drawsegs_xrange_count = drawsegs_xranges[1].count;
-        }
-        else if (spr->x1 >= centerx)
-        {
-            drawsegs_xrange = drawsegs_xranges[2].items;
-            drawsegs_xrange_count = drawsegs_xranges[2].count;
-        }
-        else
-        {
-            drawsegs_xrange = drawsegs_xranges[0].items;
-            drawsegs_xrange_count = drawsegs_xranges[0].count;
-        }
+        if (!R_ClipVisSprite(&spr, stripstart, stripstop))
+            continue;
 
-        R_DrawSprite(vissprite_ptrs[i]);    // [JN] killough
+        R_DrawSprite(&spr);    // [JN] killough
     }
 
     // render any remaining masked mid textures
@@ -1436,9 +1646,5 @@ void R_DrawMasked (void)
             R_RenderMaskedSegRange (ds, ds->x1, ds->x2);
 
     // draw the psprites on top of everything
-    //  but does not draw on side views
-    if (!viewangleoffset)
-    {
-        R_DrawPlayerSprites ();
-    }
+    R_DrawPlayerSprites ();
 }
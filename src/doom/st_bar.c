@@ -243,7 +243,7 @@ static const int ST_cheat_massacre (boolean explode)
     int killcount = 0;
     thinker_t *th;
 
-    for (th = thinkercap.next; th != &thinkercap; th = th->next)
+    for (th = thinklistcap[th_mobj].cnext; th != &thinklistcap[th_mobj]; th = th->cnext)
     {
         if (th->function.acp1 == (actionf_p1)P_MobjThinker)
         {
@@ -320,6 +320,7 @@ boolean ST_Responder (event_t *ev)
                     if (plyr->mo)
                     {
                         plyr->mo->health = deh_god_mode_health;
+                        P_DirtyMobj(plyr->mo);  // [JN] Game state hash.
                     }
                     plyr->health = deh_god_mode_health;
                 }
@@ -330,6 +331,7 @@ boolean ST_Responder (event_t *ev)
                     if (plyr->mo)
                     {
                         plyr->mo->health = 100;
+                        P_DirtyMobj(plyr->mo);  // [JN] Game state hash.
                     }
                     plyr->health = deh_god_mode_health;
                     CT_SetMessage(plyr, DEH_String(STSTR_DQDON), false, NULL);
@@ -467,11 +469,13 @@ boolean ST_Responder (event_t *ev)
                 if (plyr->cheats & CF_NOCLIP)
                 {
                     plyr->mo->flags |= MF_NOCLIP;
+                    P_DirtyMobj(plyr->mo);  // [JN] Game state hash.
                     CT_SetMessage(plyr, DEH_String(STSTR_NCON), false, NULL);
                 }
                 else
                 {
                     plyr->mo->flags &= ~MF_NOCLIP;
+                    P_DirtyMobj(plyr->mo);  // [JN] Game state hash.
                     CT_SetMessage(plyr, DEH_String(STSTR_NCOFF), false, NULL);
                 }
 
@@ -43,6 +43,7 @@
 #include "i_endoom.h"
 #include "i_input.h"
 #include "i_joystick.h"
+#include "i_perf.h"
 #include "i_sound.h"
 #include "i_swap.h" // [crispy] SHORT()
 #include "i_system.h"
@@ -265,9 +266,13 @@ void D_Display(void)
             // [JN] Main status bar drawing function.
             if (dp_screen_size < 13 || (automapactive && !automap_overlay))
             {
+                I_PerfStart(PERF_STBAR);
                 SB_Drawer();
+                I_PerfStop(PERF_STBAR);
             }
 
+            I_PerfStart(PERF_WIDGETS);
+
             if (widget_enable)
             {
                 // [JN] Left widgets are available while active game level.
@@ -306,6 +311,7 @@ void D_Display(void)
                 ID_DrawCrosshair();
             }
 
+            I_PerfStop(PERF_WIDGETS);
             break;
         case GS_INTERMISSION:
             IN_Drawer();
@@ -323,7 +329,9 @@ void D_Display(void)
     {
         if (dp_screen_size < 13 && gamestate != GS_FINALE)
         {
+            I_PerfStart(PERF_WIDGETS);
             ID_RightWidgets();
+            I_PerfStop(PERF_WIDGETS);
         }
     }
 
@@ -1366,6 +1374,8 @@ void D_DoomMain(void)
 
     CT_Init();
 
+    I_InitPerf();
+
     tprintf(DEH_String("R_Init: Init Heretic refresh daemon - ["), 1);
     hprintf(DEH_String("Loading graphics"));
     R_Init();
@@ -141,6 +141,7 @@ typedef struct thinker_s
 {
     struct thinker_s *prev, *next;
     think_t function;
+    boolean pooled;             // [JN] mobj from the mobj pool
 } thinker_t;
 
 typedef union
@@ -151,36 +152,42 @@ typedef union
 
 struct player_s;
 
+// [JN] Fields read by every movement and collision check are grouped
+// right after the position, so P_XYMovement and P_TryMove touch as
+// few cache lines as possible. Rarely used fields are at the end.
 typedef struct mobj_s
 {
     thinker_t thinker;          // thinker links
 
 // info for drawing
-    fixed_t x, y, z;
+    fixed_t x, y, z;            // must follow the thinker, as in degenmobj_t
+
+// movement info
+    fixed_t momx, momy, momz;   // momentums
+    fixed_t radius, height;     // for movement checking
+    fixed_t floorz, ceilingz;   // closest together of contacted secs
+    int flags;
+    int flags2;                 // Heretic flags
+    int intflags;  // killough 9/15/98: internal flags
+    struct subsector_s *subsector;
+    mobjinfo_t *info;           // &mobjinfo[mobj->type]
+    mobjtype_t type;
+    int health;
+    struct player_s *player;    // only valid if type == MT_PLAYER
+    int validcount;             // if == validcount, already checked
+
+// interaction info
     struct mobj_s *snext, *sprev;       // links in sector (if needed)
+    struct mobj_s *bnext, *bprev;       // links in blocks (if needed)
     angle_t angle;
     spritenum_t sprite;         // used to find patch_t and flip value
     int frame;                  // might be ord with FF_FULLBRIGHT
 
-// interaction info
-    struct mobj_s *bnext, *bprev;       // links in blocks (if needed)
-    struct subsector_s *subsector;
-    fixed_t floorz, ceilingz;   // closest together of contacted secs
-    fixed_t radius, height;     // for movement checking
-    fixed_t momx, momy, momz;   // momentums
-
-    int validcount;             // if == validcount, already checked
-
-    mobjtype_t type;
-    mobjinfo_t *info;           // &mobjinfo[mobj->type]
     int tics;                   // state tic counter
     state_t *state;
     int damage;                 // For missiles
-    int flags;
-    int flags2;                 // Heretic flags
     specialval_t special1;      // Special info
     specialval_t special2;      // Special info
-    int health;
     int movedir;                // 0-7
     int movecount;              // when 0, select a new dir
     struct mobj_s *target;      // thing being chased/attacked (or NULL)
@@ -190,15 +197,13 @@ typedef struct mobj_s
     // teleporting
     int threshold;              // if >0, the target will be chased
     // no matter what (even if shot)
-    struct player_s *player;    // only valid if type == MT_PLAYER
     int lastlook;               // player number last looked for
 
-    mapthing_t spawnpoint;      // for nightmare respawn
-
-    int   intflags;  // killough 9/15/98: internal flags
     short gear;      // killough 11/98: used in torque simulation
     int   geartics;  // [JN] Duration of torque sumulation.
 
+    mapthing_t spawnpoint;      // for nightmare respawn
+
     // [AM] If true, ok to interpolate this tic.
     boolean interp;
 
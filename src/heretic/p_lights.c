@@ -179,22 +179,22 @@ void EV_TurnTagLightsOff(line_t * line)
     sector_t *tsec;
     line_t *templine;
 
-    sector = sectors;
-    for (j = 0; j < numsectors; j++, sector++)
-        if (sector->tag == line->tag)
+    j = -1;
+    while ((j = P_FindSectorFromTag(line->tag, j)) >= 0)
+    {
+        sector = &sectors[j];
+        min = sector->lightlevel;
+        for (i = 0; i < sector->linecount; i++)
         {
-            min = sector->lightlevel;
-            for (i = 0; i < sector->linecount; i++)
-            {
-                templine = sector->lines[i];
-                tsec = getNextSector(templine, sector);
-                if (!tsec)
-                    continue;
-                if (tsec->lightlevel < min)
-                    min = tsec->lightlevel;
-            }
-            sector->lightlevel = min;
+            templine = sector->lines[i];
+            tsec = getNextSector(templine, sector);
+            if (!tsec)
+                continue;
+            if (tsec->lightlevel < min)
+                min = tsec->lightlevel;
         }
+        sector->lightlevel = min;
+    }
 }
 
 //==================================================================
@@ -210,29 +210,28 @@ void EV_LightTurnOn(line_t * line, int bright)
     sector_t *temp;
     line_t *templine;
 
-    sector = sectors;
-
-    for (i = 0; i < numsectors; i++, sector++)
-        if (sector->tag == line->tag)
+    i = -1;
+    while ((i = P_FindSectorFromTag(line->tag, i)) >= 0)
+    {
+        sector = &sectors[i];
+        //
+        // bright = 0 means to search for highest
+        // light level surrounding sector
+        //
+        if (!bright)
         {
-            //
-            // bright = 0 means to search for highest
-            // light level surrounding sector
-            //
-            if (!bright)
+            for (j = 0; j < sector->linecount; j++)
             {
-                for (j = 0; j < sector->linecount; j++)
-                {
-                    templine = sector->lines[j];
-                    temp = getNextSector(templine, sector);
-                    if (!temp)
-                        continue;
-                    if (temp->lightlevel > bright)
-                        bright = temp->lightlevel;
-                }
+                templine = sector->lines[j];
+                temp = getNextSector(templine, sector);
+                if (!temp)
+                    continue;
+                if (temp->lightlevel > bright)
+                    bright = temp->lightlevel;
             }
-            sector->lightlevel = bright;
         }
+        sector->lightlevel = bright;
+    }
 }
 
 //==================================================================
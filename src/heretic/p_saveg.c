@@ -30,7 +30,12 @@
 #include "id_vars.h"
 
 
-static FILE *SaveGameFP;
+// [JN] The savegame is serialized into a memory buffer, which is written
+// to disk in one go by SV_Close and read from disk in one go by SV_OpenRead.
+static byte   *SaveBuffer;
+static size_t  SaveBufferSize;  // allocated size of SaveBuffer
+static size_t  SaveLength;      // bytes of data in SaveBuffer
+static size_t  SavePos;         // current read/write position
 
 int savepage; // [crispy]
 
@@ -58,6 +63,28 @@ char *SV_Filename(int slot)
     return filename;
 }
 
+//==========================================================================
+//
+// SV_Grow
+//
+//==========================================================================
+
+static void SV_Grow(size_t size)
+{
+    if (SavePos + size > SaveBufferSize)
+    {
+        size_t newsize = SaveBufferSize ? SaveBufferSize : 64 * 1024;
+
+        while (SavePos + size > newsize)
+        {
+            newsize *= 2;
+        }
+
+        SaveBuffer = I_Realloc(SaveBuffer, newsize);
+        SaveBufferSize = newsize;
+    }
+}
+
 //==========================================================================
 //
 // SV_Open
@@ -66,25 +93,62 @@ char *SV_Filename(int slot)
 
 void SV_Open(char *fileName)
 {
-    SaveGameFP = M_fopen(fileName, "wb");
+    SavePos = 0;
+    SaveLength = 0;
 }
 
 void SV_OpenRead(char *filename)
 {
-    SaveGameFP = M_fopen(filename, "rb");
+    FILE *handle;
+    long length;
+
+    handle = M_fopen(filename, "rb");
+
+    if (handle == NULL)
+    {
+        I_Error("Couldn't read file %s", filename);
+    }
+
+    length = M_FileLength(handle);
+    SavePos = 0;
+    SaveLength = 0;
+
+    if (length > 0)
+    {
+        SV_Grow(length);
+        SaveLength = fread(SaveBuffer, 1, length, handle);
+    }
+
+    fclose(handle);
 }
 
 //==========================================================================
 //
 // SV_Close
 //
+// Writes the buffer to a temporary file, which is then renamed to the
+// real file. This prevents an existing savegame from being overwritten
+// by a partially written one.
+//
 //==========================================================================
 
 void SV_Close(char *fileName)
 {
+    char *tempname;
+
     SV_WriteByte(SAVE_GAME_TERMINATOR);
 
-    fclose(SaveGameFP);
+    tempname = M_StringJoin(savegamedir, "temp.sav", NULL);
+
+    if (!M_WriteFile(tempname, SaveBuffer, (int) SaveLength))
+    {
+        I_Error("Failed to write savegame file '%s'.", tempname);
+    }
+
+    M_remove(fileName);
+    M_rename(tempname, fileName);
+
+    free(tempname);
 }
 
 //==========================================================================
@@ -95,12 +159,17 @@ void SV_Close(char *fileName)
 
 void SV_Write(void *buffer, int size)
 {
-    fwrite(buffer, size, 1, SaveGameFP);
+    SV_Grow(size);
+    memcpy(SaveBuffer + SavePos, buffer, size);
+    SavePos += size;
+    SaveLength = SavePos;
 }
 
 void SV_WriteByte(byte val)
 {
-    SV_Write(&val, sizeof(byte));
+    SV_Grow(1);
+    SaveBuffer[SavePos++] = val;
+    SaveLength = SavePos;
 }
 
 void SV_WriteWord(unsigned short val)
@@ -136,19 +205,25 @@ void SV_WritePtr(const void *ptr)
 
 void SV_Read(void *buffer, int size)
 {
-    int retval = fread(buffer, 1, size, SaveGameFP);
-    if (retval != size)
+    if (SavePos + size > SaveLength)
     {
         I_Error("Incomplete read in SV_Read: Expected %d, got %d bytes",
-            size, retval);
+            size, (int) (SaveLength - SavePos));
     }
+
+    memcpy(buffer, SaveBuffer + SavePos, size);
+    SavePos += size;
 }
 
 byte SV_ReadByte(void)
 {
-    byte result;
-    SV_Read(&result, sizeof(byte));
-    return result;
+    if (SavePos >= SaveLength)
+    {
+        I_Error("Incomplete read in SV_Read: Expected %d, got %d bytes",
+            1, 0);
+    }
+
+    return SaveBuffer[SavePos++];
 }
 
 uint16_t SV_ReadWord(void)
@@ -1681,6 +1756,7 @@ void P_UnArchiveWorld(void)
         sec->specialdata = 0;
         sec->soundtarget = 0;
     }
+    P_InitTagLists();           // [JN] tags were read again
 
 //
 // do lines
@@ -1762,7 +1838,7 @@ void P_UnArchiveThinkers(void)
         if (currentthinker->function == P_MobjThinker)
             P_RemoveMobj((mobj_t *) currentthinker);
         else
-            Z_Free(currentthinker);
+            P_FreeThinker(currentthinker);
         currentthinker = next;
     }
     P_InitThinkers();
@@ -1777,7 +1853,7 @@ void P_UnArchiveThinkers(void)
                 return;         // end of list
 
             case tc_mobj:
-                mobj = Z_Malloc(sizeof(*mobj), PU_LEVEL, NULL);
+                mobj = P_AllocMobj();
                 saveg_read_mobj_t(mobj);
 //              mobj->target = NULL;
                 P_SetThingPosition(mobj);
@@ -2070,7 +2146,7 @@ void P_UnArchiveOldSpecials (void)
     // rewind 1 byte so G_DoLoadGame can find the termination marker, and fill
     // oldspecial with 0s.
     if (termbyte == SAVE_GAME_TERMINATOR)
-        fseek(SaveGameFP, -1, SEEK_CUR);
+        SavePos--;
 
     for (i=0, sec = sectors ; i<numsectors ; i++,sec++)
     {
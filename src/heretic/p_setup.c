@@ -1512,6 +1512,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
     S_Start();                  // make sure all sounds are stopped before Z_FreeTags
 
     Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+    P_InitMobjPool();
 
     P_InitThinkers();
 
@@ -1531,6 +1532,11 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
     printf("P_SetupLevel: E%dM%d, ", gameepisode, gamemap);
 
     lumpnum = W_GetNumForName(lumpname);
+    // [JN] Let the map lumps be read from memory-mapped WAD in background.
+    W_PrefetchLumps(lumpnum, ML_BLOCKMAP + 1);
+
+    // [JN] Log memory left after the previous level, if -zonestats is given.
+    Z_LogStats(lumpname);
 
     // [crispy] check and log map and nodes format
     crispy_mapformat = P_CheckMapFormat(lumpnum);
@@ -1570,6 +1576,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
 
     rejectmatrix = W_CacheLumpNum(lumpnum + ML_REJECT, PU_LEVEL);
     P_GroupLines();
+    P_InitTagLists();
 
     // [crispy] remove slime trails
     P_RemoveSlimeTrails();
@@ -287,7 +287,6 @@ void P_InitPicAnims(void)
     const char *startname;
     const char *endname;
     int i;
-    boolean init_swirl = false;
     // [crispy] add support for ANIMATED lumps
     animdef_t *animdefs;
     const boolean from_lump = (W_CheckNumForName("ANIMATED") != -1);
@@ -337,12 +336,8 @@ void P_InitPicAnims(void)
         lastanim->numpics = lastanim->picnum - lastanim->basepic + 1;
         lastanim->speed = from_lump ? LONG(animdefs[i].speed) : animdefs[i].speed;
         // [crispy] add support for SMMU swirling flats
-        if (lastanim->speed > 65535 || lastanim->numpics == 1)
-        {
-                init_swirl = true;
-        }
-        else
-        if (lastanim->numpics < 2)
+        // [JN] Distorted flats are made on demand by R_DistortedFlat.
+        if (lastanim->speed <= 65535 && lastanim->numpics < 1)
         {
             // [crispy] make non-fatal, skip invalid animation sequences
             fprintf (stderr, "P_InitPicAnims: bad cycle from %s to %s\n",
@@ -355,10 +350,6 @@ void P_InitPicAnims(void)
     {
         W_ReleaseLumpName("ANIMATED");
     }
-    if (init_swirl)
-    {
-        R_InitDistortedFlats();
-    }
 }
 
 /*
@@ -559,17 +550,69 @@ fixed_t P_FindHighestCeilingSurrounding(sector_t * sec)
 
 //==================================================================
 //
-//      RETURN NEXT SECTOR # THAT LINE TAG REFERS TO
+//      P_InitTagLists
+//
+//      [JN] killough 1/30/98: hash sectors by tag, so finding the
+//      sectors of a tag does not scan all of them. Chains are built
+//      backwards, so sectors are found in ascending order, like the
+//      linear search did.
 //
 //==================================================================
-int P_FindSectorFromLineTag(line_t * line, int start)
+void P_InitTagLists(void)
 {
     int i;
 
-    for (i = start + 1; i < numsectors; i++)
-        if (sectors[i].tag == line->tag)
-            return i;
-    return -1;
+    for (i = numsectors; --i >= 0;)
+        sectors[i].firsttag = -1;
+
+    for (i = numsectors; --i >= 0;)
+    {
+        const int j = (unsigned) sectors[i].tag % (unsigned) numsectors;
+
+        sectors[i].nexttag = sectors[j].firsttag;
+        sectors[j].firsttag = i;
+    }
+}
+
+//==================================================================
+//
+//      RETURN NEXT SECTOR # THAT TAG REFERS TO
+//
+//      [JN] Like the linear search, returns the first sector after
+//      start, which does not need to have this tag: EV_BuildStairs
+//      passes the last stair step it raised.
+//
+//==================================================================
+int P_FindSectorFromTag(int tag, int start)
+{
+    int i;
+
+    if (start >= 0 && sectors[start].tag == tag)
+    {
+        i = sectors[start].nexttag;
+    }
+    else
+    {
+        i = sectors[(unsigned) tag % (unsigned) numsectors].firsttag;
+
+        while (i >= 0 && i <= start)
+            i = sectors[i].nexttag;
+    }
+
+    while (i >= 0 && sectors[i].tag != tag)
+        i = sectors[i].nexttag;
+
+    return i;
+}
+
+//==================================================================
+//
+//      RETURN NEXT SECTOR # THAT LINE TAG REFERS TO
+//
+//==================================================================
+int P_FindSectorFromLineTag(line_t * line, int start)
+{
+    return P_FindSectorFromTag(line->tag, start);
 }
 
 //==================================================================
@@ -1342,13 +1385,10 @@ void P_SpawnSpecials(void)
             case 271:
             case 272:
               {
-                int secnum;
-                for (secnum = 0; secnum < numsectors; secnum++)
+                int secnum = -1;
+                while ((secnum = P_FindSectorFromTag(lines[i].tag, secnum)) >= 0)
                   {
-                    if (sectors[secnum].tag == lines[i].tag)
-                        {
-                            sectors[secnum].sky = i | PL_SKYFLAT;
-                        }
+                    sectors[secnum].sky = i | PL_SKYFLAT;
                   }
               }
              break;
@@ -136,29 +136,27 @@ boolean EV_Teleport(line_t * line, int side, mobj_t * thing)
         return (false);
     }
     tag = line->tag;
-    for (i = 0; i < numsectors; i++)
+    i = -1;
+    while ((i = P_FindSectorFromTag(tag, i)) >= 0)
     {
-        if (sectors[i].tag == tag)
+        for (thinker = thinkercap.next; thinker != &thinkercap;
+             thinker = thinker->next)
         {
-            for (thinker = thinkercap.next; thinker != &thinkercap;
-                 thinker = thinker->next)
-            {
-                if (thinker->function != P_MobjThinker)
-                {               // Not a mobj
-                    continue;
-                }
-                m = (mobj_t *) thinker;
-                if (m->type != MT_TELEPORTMAN)
-                {               // Not a teleportman
-                    continue;
-                }
-                sector = m->subsector->sector;
-                if (sector - sectors != i)
-                {               // Wrong sector
-                    continue;
-                }
-                return (P_Teleport(thing, m->x, m->y, m->angle));
+            if (thinker->function != P_MobjThinker)
+            {               // Not a mobj
+                continue;
+            }
+            m = (mobj_t *) thinker;
+            if (m->type != MT_TELEPORTMAN)
+            {               // Not a teleportman
+                continue;
+            }
+            sector = m->subsector->sector;
+            if (sector - sectors != i)
+            {               // Wrong sector
+                continue;
             }
+            return (P_Teleport(thing, m->x, m->y, m->angle));
         }
     }
     return (false);
@@ -249,7 +249,7 @@ static const byte iron_lich_2[256] =
     0, 1, 0, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0,
 };
 
-const byte *dc_brightmap = nobrightmap;
+THREADLOCAL const byte *dc_brightmap = nobrightmap;
 
 // [crispy] brightmaps for textures
 
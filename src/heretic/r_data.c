@@ -24,6 +24,7 @@
 
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "m_misc.h"
 #include "r_local.h"
 #include "p_local.h"
@@ -178,8 +179,18 @@ void R_GenerateComposite(int texnum)
 
     texture = textures[texnum];
 
-    block = Z_Malloc(texturecompositesize[texnum], PU_STATIC,
-                     &texturecomposite[texnum]);
+    // [JN] Render threads may ask for the same texture at once. Build it
+    // under the cache lock and hand out the pointer only once it's done,
+    // so nobody gets to read a half-built composite.
+    I_LockCache();
+
+    if (texturecomposite[texnum])
+    {
+        I_UnlockCache();
+        return;
+    }
+
+    block = Z_Malloc(texturecompositesize[texnum], PU_STATIC, NULL);
 
     collump = texturecolumnlump[texnum];
     colofs = texturecolumnofs[texnum];
@@ -285,9 +296,13 @@ void R_GenerateComposite(int texnum)
     free(source); // free temporary column
     free(marks); // free transparency marks
 
+    Z_ChangeUser(block, (void **) &texturecomposite[texnum]);
+
     // Now that the texture has been built in column cache, it is purgable
     // from zone memory.
     Z_ChangeTag(block, PU_CACHE);
+
+    I_UnlockCache();
 }
 
 
@@ -459,15 +474,25 @@ void R_GenerateLookup(int texnum)
 byte *R_GetColumn(int tex, int col)
 {
     int lump, ofs;
+    byte *composite;
 
     col &= texturewidthmask[tex];
     lump = texturecolumnlump[tex][col];
     ofs = texturecolumnofs[tex][col];
     if (lump > 0)
         return (byte *) W_CacheLumpNum(lump, PU_CACHE) + ofs;
+
+    // [JN] Render threads may purge or build composites at any time,
+    // so the composite is looked up and pinned for the frame under
+    // the cache lock.
+    I_LockCache();
     if (!texturecomposite[tex])
         R_GenerateComposite(tex);
-    return texturecomposite[tex] + ofs;
+    composite = texturecomposite[tex];
+    Z_PinBlock(composite);
+    I_UnlockCache();
+
+    return composite + ofs;
 }
 
 /*
@@ -86,6 +86,10 @@ typedef struct
     short lightlevel;
     short special, tag;
 
+    // [JN] killough 1/30/98: chain of sectors with the same
+    // tag hash, see P_InitTagLists.
+    int firsttag, nexttag;
+
     int soundtraversed;         // 0 = untraversed, 1,2 = sndlines -1
     mobj_t *soundtarget;        // thing that made a sound (or null)
 
@@ -391,7 +395,7 @@ extern fixed_t viewcos, viewsin;
 
 extern int detailshift;         // 0 = high, 1 = low
 
-extern void (*colfunc) (void);
+extern THREADLOCAL void (*colfunc) (void);
 extern void (*basecolfunc) (void);
 extern void (*tlcolfunc) (void);
 extern void (*tladdcolfunc) (void);
@@ -399,6 +403,15 @@ extern void (*transtlcolfunc) (void);
 extern void (*extratlcolfunc) (void);
 extern void (*spanfunc) (void);
 
+// [JN] Columns of the view drawn by the current thread.
+extern THREADLOCAL int stripstart, stripstop;
+
+// [JN] First column of the strip, when the view is split into "numstrips".
+inline static int R_StripStart (int strip, int numstrips)
+{
+    return viewwidth * strip / numstrips;
+}
+
 // [crispy] smooth texture scrolling
 extern void R_InterpolateTextureOffsets (void);
 
@@ -462,10 +475,10 @@ extern const byte **texturebrightmap;
 //
 // R_bsp.c
 //
-extern seg_t *curline;
-extern side_t *sidedef;
-extern line_t *linedef;
-extern sector_t *frontsector, *backsector;
+extern THREADLOCAL seg_t *curline;
+extern THREADLOCAL side_t *sidedef;
+extern THREADLOCAL line_t *linedef;
+extern THREADLOCAL sector_t *frontsector, *backsector;
 
 extern int rw_x;
 extern int rw_stopx;
@@ -494,7 +507,7 @@ void R_RenderBSPNode(int bspnum);
 // R_segs.c
 //
 extern angle_t rw_angle1;           // angle to line origin
-extern lighttable_t **walllights;
+extern THREADLOCAL lighttable_t **walllights;
 
 
 void R_RenderMaskedSegRange(drawseg_t * ds, int x1, int x2);
@@ -523,6 +536,7 @@ void R_ClearPlanes(void);
 void R_MapPlane(int y, int x1, int x2);
 extern void R_MakeSpans (unsigned int x, unsigned int t1, unsigned int b1, 
                          unsigned int t2, unsigned int b2);
+void R_SetupPlanes(void);
 void R_DrawPlanes(void);
 
 visplane_t *R_FindPlane(fixed_t height, int picnum, int lightlevel,
@@ -574,11 +588,11 @@ extern int negonearray[MAXWIDTH];       // [crispy] 32-bit integer math
 extern int screenheightarray[MAXWIDTH]; // [crispy] 32-bit integer math
 
 // vars for R_DrawMaskedColumn
-extern int *mfloorclip;   // [crispy] 32-bit integer math
-extern int *mceilingclip; // [crispy] 32-bit integer math
-extern fixed_t spryscale;
-extern int64_t sprtopscreen; // [crispy] WiggleFix
-extern fixed_t sprbotscreen;
+extern THREADLOCAL int *mfloorclip;   // [crispy] 32-bit integer math
+extern THREADLOCAL int *mceilingclip; // [crispy] 32-bit integer math
+extern THREADLOCAL fixed_t spryscale;
+extern THREADLOCAL int64_t sprtopscreen; // [crispy] WiggleFix
+extern THREADLOCAL fixed_t sprbotscreen;
 
 extern fixed_t pspritescale, pspriteiscale;
 
@@ -592,8 +606,9 @@ void R_AddPSprites(void);
 void R_DrawSprites(void);
 void R_InitSprites(const char **namelist);
 void R_ClearSprites(void);
+void R_SortMasked(void);
 void R_DrawMasked(void);
-void R_ClipVisSprite(vissprite_t * vis, int xl, int xh);
+boolean R_ClipVisSprite(vissprite_t * vis, int xl, int xh);
 
 //=============================================================================
 //
@@ -601,17 +616,22 @@ void R_ClipVisSprite(vissprite_t * vis, int xl, int xh);
 //
 //=============================================================================
 
-extern lighttable_t *dc_colormap[2];
-extern int dc_x;
-extern int dc_yl;
-extern int dc_yh;
-extern fixed_t dc_iscale;
-extern fixed_t dc_texturemid;
-extern int dc_texheight;
-extern byte *dc_source;         // first pixel in a column
+extern THREADLOCAL lighttable_t *dc_colormap[2];
+extern THREADLOCAL int dc_x;
+extern THREADLOCAL int dc_yl;
+extern THREADLOCAL int dc_yh;
+extern THREADLOCAL fixed_t dc_iscale;
+extern THREADLOCAL fixed_t dc_texturemid;
+extern THREADLOCAL int dc_texheight;
+extern THREADLOCAL byte *dc_source;         // first pixel in a column
 extern pixel_t *ylookup[MAXHEIGHT];
 extern int columnofs[MAXWIDTH];
 
+void R_StartRecordColumns(int numstrips);
+void R_StopRecordColumns(void);
+void R_DrawWallColumn(void);
+void R_ReplayColumns(int strip);
+
 void R_DrawColumn(void);
 void R_DrawColumnLow(void);
 void R_DrawTLColumn(void);
@@ -625,21 +645,21 @@ void R_DrawTranslatedTLColumnLow(void);
 void R_DrawExtraTLColumn(void);
 void R_DrawExtraTLColumnLow(void);
 
-extern int ds_y;
-extern int ds_x1;
-extern int ds_x2;
-extern lighttable_t *ds_colormap[2];
-extern fixed_t ds_xfrac;
-extern fixed_t ds_yfrac;
-extern fixed_t ds_xstep;
-extern fixed_t ds_ystep;
-extern byte *ds_source;         // start of a 64*64 tile image
+extern THREADLOCAL int ds_y;
+extern THREADLOCAL int ds_x1;
+extern THREADLOCAL int ds_x2;
+extern THREADLOCAL lighttable_t *ds_colormap[2];
+extern THREADLOCAL fixed_t ds_xfrac;
+extern THREADLOCAL fixed_t ds_yfrac;
+extern THREADLOCAL fixed_t ds_xstep;
+extern THREADLOCAL fixed_t ds_ystep;
+extern THREADLOCAL byte *ds_source;         // start of a 64*64 tile image
 
 extern byte *translationtables;
-extern byte *dc_translation;
+extern THREADLOCAL byte *dc_translation;
 
-extern const byte *dc_brightmap;
-extern const byte *ds_brightmap;
+extern THREADLOCAL const byte *dc_brightmap;
+extern THREADLOCAL const byte *ds_brightmap;
 
 void R_DrawSpan(void);
 void R_DrawSpanLow(void);
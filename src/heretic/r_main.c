@@ -25,6 +25,8 @@
 #include "p_local.h"
 #include "tables.h"
 #include "sb_bar.h"
+#include "i_perf.h"
+#include "i_thread.h"
 
 #include "id_vars.h"
 #include "id_func.h"
@@ -113,7 +115,7 @@ int LIGHTZSHIFT;
 // [JN] Shifring value used for "full" brightmaps to light up ammo pickups.
 int BMAPSHIFTINDEX;
 
-void (*colfunc) (void);
+THREADLOCAL void (*colfunc) (void);
 void (*basecolfunc) (void);
 void (*tlcolfunc) (void);
 void (*tladdcolfunc) (void);
@@ -122,6 +124,10 @@ void (*transtlcolfunc) (void);
 void (*extratlcolfunc) (void);
 void (*spanfunc) (void);
 
+// [JN] Columns of the view drawn by the current thread.
+THREADLOCAL int stripstart, stripstop;
+static int numstrips = 1;
+
 //
 // R_AddPointToBox
 // Expand a given bbox
@@ -143,7 +149,6 @@ R_AddPointToBox
 	box[BOXTOP] = y;
 }
 
-
 // -----------------------------------------------------------------------------
 // R_PointOnSide
 // Traverse BSP (sub) tree, check point against partition plane.
@@ -1114,7 +1119,6 @@ void R_SetupFrame (player_t* player)
             // [crispy] sizeof(lighttable_t) not needed in paletted render
             // and breaks invulnerability colormap index in true color render
             * 256 /* * sizeof(lighttable_t)*/;
-        walllights = scalelightfixed;
         for (i = 0; i < MAXLIGHTSCALE; i++)
         {
             scalelightfixed[i] = fixedcolormap;
@@ -1127,6 +1131,52 @@ void R_SetupFrame (player_t* player)
     validcount++;
 }
 
+// -----------------------------------------------------------------------------
+// R_SetupStrip
+// [JN] Sets up render state of the current thread for columns x1...x2.
+// -----------------------------------------------------------------------------
+
+static void R_SetupStrip (int x1, int x2)
+{
+    stripstart = x1;
+    stripstop = x2;
+
+    colfunc = basecolfunc;
+
+    if (fixedcolormap)
+    {
+        walllights = scalelightfixed;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_RenderStrip
+// [JN] Draws one vertical strip of the view. BSP tree is walked only once
+// per frame on the main thread, strips are drawing recorded wall columns,
+// then parts of planes and masked things which are within their bounds.
+// -----------------------------------------------------------------------------
+
+static void R_RenderStrip (int strip)
+{
+    R_SetupStrip(R_StripStart(strip, numstrips),
+                 R_StripStart(strip + 1, numstrips) - 1);
+
+    // [JN] Phase timings are taken from the first strip,
+    // recorded wall columns are counted as a part of planes.
+    if (!strip)
+        I_PerfStart(PERF_PLANES);
+    R_ReplayColumns (strip);
+    R_DrawPlanes ();
+    if (!strip)
+    {
+        I_PerfStop(PERF_PLANES);
+        I_PerfStart(PERF_MASKED);
+    }
+    R_DrawMasked ();
+    if (!strip)
+        I_PerfStop(PERF_MASKED);
+}
+
 //
 // R_RenderView
 //
@@ -1137,12 +1187,14 @@ void R_RenderPlayerView (player_t *player)
 
     // Start frame
     R_SetupFrame (player);
+    R_SetupStrip(0, viewwidth - 1);
 
     // Clear buffers.
     R_ClearClipSegs ();
     R_ClearDrawSegs ();
     R_ClearPlanes ();
     R_ClearSprites ();
+
     if (automapactive && !automap_overlay)
     {
         R_RenderBSPNode (numnodes-1);
@@ -1158,18 +1210,49 @@ void R_RenderPlayerView (player_t *player)
         R_InterpolateTextureOffsets();
     }
 
+    numstrips = MIN(I_GetThreadCount(vid_render_threads), viewwidth);
+
+    if (numstrips > 1)
+    {
+        // [JN] Wall columns are recorded during the BSP walk and drawn by
+        // the strips. Pin their sources and everything else the strips
+        // look up in the zone memory until then, purging the rest.
+        Z_StartPinning();
+        R_StartRecordColumns(numstrips);
+    }
+
     // The head node is the last node output.
+    I_PerfStart(PERF_BSP);
     R_RenderBSPNode (numnodes-1);
+    I_PerfStop(PERF_BSP);
 
     // Check for new console commands.
     NetUpdate ();
 
-    R_DrawPlanes ();
+    // [JN] Set up planes and sort things once for all strips.
+    R_SetupPlanes ();
+    R_SortMasked ();
+    R_AddPSprites ();
 
-    // Check for new console commands.
-    NetUpdate ();
+    if (numstrips > 1)
+    {
+        R_StopRecordColumns();
+        I_RunThreadJobs(R_RenderStrip, numstrips);
+        Z_StopPinning();
+    }
+    else
+    {
+        I_PerfStart(PERF_PLANES);
+        R_DrawPlanes ();
+        I_PerfStop(PERF_PLANES);
 
-    R_DrawMasked ();
+        // Check for new console commands.
+        NetUpdate ();
+
+        I_PerfStart(PERF_MASKED);
+        R_DrawMasked ();
+        I_PerfStop(PERF_MASKED);
+    }
 
     // Check for new console commands.
     NetUpdate ();
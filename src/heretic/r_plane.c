@@ -70,31 +70,30 @@ int  ceilingclip[MAXWIDTH];  // [JN] 32-bit integer math
 // spanstart holds the start of a plane span
 // initialized to 0 at start
 //
-int			spanstart[MAXHEIGHT];
-int			spanstop[MAXHEIGHT];
+static THREADLOCAL int	spanstart[MAXHEIGHT];
 
 //
 // texture mapping
 //
-lighttable_t**		planezlight;
-fixed_t			planeheight;
+static THREADLOCAL lighttable_t**	planezlight;
+static THREADLOCAL fixed_t		planeheight;
 
 fixed_t*			yslope;
 fixed_t			yslopes[LOOKDIRS][MAXHEIGHT];
 fixed_t			distscale[MAXWIDTH];
 
-fixed_t			cachedheight[MAXHEIGHT];
-fixed_t			cacheddistance[MAXHEIGHT];
-fixed_t			cachedxstep[MAXHEIGHT];
-fixed_t			cachedystep[MAXHEIGHT];
+static THREADLOCAL fixed_t	cachedheight[MAXHEIGHT];
+static THREADLOCAL fixed_t	cacheddistance[MAXHEIGHT];
+static THREADLOCAL fixed_t	cachedxstep[MAXHEIGHT];
+static THREADLOCAL fixed_t	cachedystep[MAXHEIGHT];
 
-static fixed_t xsmoothscrolloffset; // [crispy]
-static fixed_t ysmoothscrolloffset; // [crispy]
+static THREADLOCAL fixed_t xsmoothscrolloffset; // [crispy]
+static THREADLOCAL fixed_t ysmoothscrolloffset; // [crispy]
 
 // [JN] Flowing effect for swirling liquids.
 // Render-only coords:
-static fixed_t swirlFlow_x;
-static fixed_t swirlFlow_y;
+static THREADLOCAL fixed_t swirlFlow_x;
+static THREADLOCAL fixed_t swirlFlow_y;
 // Actual coords, updates on game tic via P_UpdateSpecials:
 fixed_t swirlCoord_x;
 fixed_t swirlCoord_y;
@@ -255,9 +254,6 @@ void R_ClearPlanes (void)
     }
 
     lastopening = openings;
-
-    // texture calculation
-    memset(cachedheight, 0, sizeof(cachedheight));
 }
 
 // -----------------------------------------------------------------------------
@@ -433,6 +429,44 @@ R_MakeSpans
 }
 
 
+// -----------------------------------------------------------------------------
+// R_SetupPlanes
+// [JN] Per-frame state of R_DrawPlanes. Called once per frame, before
+// the planes of any strip are drawn, so every strip scrolls flats by
+// the same amount.
+// -----------------------------------------------------------------------------
+
+static int interpfactor; // [crispy]
+
+void R_SetupPlanes (void)
+{
+    // [JN] CRL - openings counter.
+    IDRender.numopenings = lastopening - openings;
+
+    for (int i = 0 ; i < MAXVISPLANES ; i++)
+    for (visplane_t *pl = visplanes[i] ; pl ; pl = pl->next)
+    IDRender.numplanes++;
+
+    // [crispy] Use old value of interpfactor if uncapped and paused. This
+    // ensures that scrolling stops smoothly when pausing.
+    if (vid_uncapped_fps && realleveltime > oldleveltime && !crl_freeze)
+    {
+        // [crispy] Scrolling normally advances every *other* gametic, so
+        // interpolation needs to span two tics
+        if (leveltime & 1)
+        {
+            interpfactor = (FRACUNIT + fractionaltic) >> 1;
+        }
+        else
+        {
+            interpfactor = fractionaltic >> 1;
+        }
+    }
+    else if (!vid_uncapped_fps)
+    {
+        interpfactor = 0;
+    }
+}
 
 //
 // R_DrawPlanes
@@ -449,15 +483,22 @@ void R_DrawPlanes (void)
     int count;
     fixed_t frac, fracstep;
     int heightmask; // [crispy]
-    static int interpfactor; // [crispy]
 
-    // [JN] CRL - openings counter.
-    IDRender.numopenings = lastopening - openings;
+    // texture calculation
+    memset(cachedheight, 0, sizeof(cachedheight));
 
     for (int i = 0 ; i < MAXVISPLANES ; i++)
-    for (visplane_t *pl = visplanes[i] ; pl ; pl = pl->next, IDRender.numplanes++)
-    if (pl->minx <= pl->maxx)
+    for (visplane_t *pl = visplanes[i] ; pl ; pl = pl->next)
     {
+        // [JN] Draw only columns of the current strip.
+        const int minx = MAX(pl->minx, stripstart);
+        const int maxx = MIN(pl->maxx, stripstop);
+
+        if (minx > maxx)
+        {
+            continue;
+        }
+
         //
         // sky flat
         // [crispy] add support for MBF sky transfers
@@ -497,7 +538,7 @@ void R_DrawPlanes (void)
                 dc_colormap[0] = dc_colormap[1] = colormaps;
             }
             dc_texheight = textureheight[texture]>>FRACBITS;
-            for (x = pl->minx; x <= pl->maxx; x++)
+            for (x = minx; x <= maxx; x++)
             {
                 dc_yl = pl->top[x];
                 dc_yh = pl->bottom[x];
@@ -634,7 +675,7 @@ void R_DrawPlanes (void)
         else  // regular flat
         {
             const boolean swirling = (flattranslation[pl->picnum] == -1);
-            const int stop = pl->maxx + 1;
+            const int stop = maxx + 1;
             const int lumpnum = firstflat + (swirling ? pl->picnum : flattranslation[pl->picnum]);
 
             // [crispy] adapt swirl from src/doom to src/heretic
@@ -653,26 +694,6 @@ void R_DrawPlanes (void)
                 swirlFlow_y = 0;
             }
 
-            // [crispy] Use old value of interpfactor if uncapped and paused. This
-            // ensures that scrolling stops smoothly when pausing.
-            if (vid_uncapped_fps && realleveltime > oldleveltime && !crl_freeze)
-            {
-                // [crispy] Scrolling normally advances every *other* gametic, so
-                // interpolation needs to span two tics
-                if (leveltime & 1)
-                {
-                    interpfactor = (FRACUNIT + fractionaltic) >> 1;
-                }
-                else
-                {
-                    interpfactor = fractionaltic >> 1;
-                }
-            }
-            else if (!vid_uncapped_fps)
-            {
-                interpfactor = 0;
-            }
-
             //[crispy] use smoothscrolloffsets to unconditonally animate all scrolling floors
             switch (pl->special)
             {
@@ -727,13 +748,19 @@ void R_DrawPlanes (void)
             // [PN] Ensure 'light' is within the range [0, LIGHTLEVELS - 1] inclusively.
             const int light = BETWEEN(0, LIGHTLEVELS-1, (pl->lightlevel >> LIGHTSEGSHIFT) + (extralight * LIGHTBRIGHT));
             planezlight = zlight[light];
-            pl->top[pl->minx-1] = pl->top[stop] = USHRT_MAX;
 
-            for (int x = pl->minx ; x <= stop ; x++)
+            // [JN] Columns next to the strip belong to other threads, so
+            // instead of USHRT_MAX marks in pl->top[], pass an empty column
+            // for the first and the last step.
+            R_MakeSpans(minx, USHRT_MAX, 0, pl->top[minx], pl->bottom[minx]);
+
+            for (int x = minx + 1 ; x < stop ; x++)
             {
                 R_MakeSpans(x,pl->top[x-1], pl->bottom[x-1], pl->top[x], pl->bottom[x]);
             }
 
+            R_MakeSpans(stop, pl->top[stop-1], pl->bottom[stop-1], USHRT_MAX, 0);
+
             if (!swirling)
             {
                 W_ReleaseLumpNum(lumpnum);
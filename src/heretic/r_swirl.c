@@ -37,8 +37,22 @@
 #define AMP2 2                          // [PN] Amplitude for the secondary distortion.
 #define SPEED 32                        // [PN] Speed of the wave distortion.
 
-static int *offsets = NULL;             // [PN] Array to store offsets for all frames.
-static int *offset;                     // [PN] Current pointer to offsets for a specific frame.
+// [JN] Offsets are calculated lazily, only for the current frame of
+// the sequence, instead of keeping a table for all frames (4 MB).
+// Every render thread has its own offsets and distorted flats.
+static THREADLOCAL unsigned short offsets[FLATSIZE];
+static THREADLOCAL int offsetsframe = -1;
+
+// [JN] Distorted flats of the current frame, one per swirling flat on the map.
+typedef struct
+{
+    int  flatnum;
+    int  tic;
+    byte pixels[FLATSIZE];
+} swirlflat_t;
+
+static THREADLOCAL swirlflat_t **swirlflats;
+static THREADLOCAL int numswirlflats;
 
 
 // [PN] Helper function to calculate the offset based on sine wave values.
@@ -55,64 +69,79 @@ static inline int calculate_offset (int x, int y, int i, int factor, int factor2
 
 
 
-void R_InitDistortedFlats (void)
+// -----------------------------------------------------------------------------
+// R_CalcDistortedOffsets
+// [JN] Calculates texel offsets of the given frame of the sequence.
+// -----------------------------------------------------------------------------
+
+static void R_CalcDistortedOffsets (const int frame)
 {
-	if (!offsets)
-	{
-		offsets = I_Realloc(offsets, SEQUENCE * FLATSIZE * sizeof(*offsets));
-		offset = offsets;
-
-		for (int i = 0; i < SEQUENCE; i++)
-		{
-			for (int x = 0; x < 64; x++)
-			{
-				for (int y = 0; y < 64; y++)
-				{
-                    // [PN] Calculate X distortion.
-                    const int x1 = calculate_offset(x, y, i, SWIRLFACTOR, SWIRLFACTOR2, AMP, AMP2, SPEED);
-                    // [PN] Calculate Y distortion (swapped x and y).                    
-                    const int y1 = calculate_offset(y, x, i, SWIRLFACTOR, SWIRLFACTOR2, AMP, AMP2, SPEED);
-
-					offset[(y << 6) + x] = (y1 << 6) + x1;
-				}
-			}
-
-			offset += FLATSIZE;
-		}
-	}
+    for (int x = 0; x < 64; x++)
+    {
+        for (int y = 0; y < 64; y++)
+        {
+            // [PN] Calculate X distortion.
+            const int x1 = calculate_offset(x, y, frame, SWIRLFACTOR, SWIRLFACTOR2, AMP, AMP2, SPEED);
+            // [PN] Calculate Y distortion (swapped x and y).
+            const int y1 = calculate_offset(y, x, frame, SWIRLFACTOR, SWIRLFACTOR2, AMP, AMP2, SPEED);
+
+            offsets[(y << 6) + x] = (y1 << 6) + x1;
+        }
+    }
+
+    offsetsframe = frame;
 }
 
+// -----------------------------------------------------------------------------
+// R_DistortedFlat
+// [JN] Returns distorted flat of the current tic. Every swirling flat has
+// its own cache slot, so switching between them within a frame does not
+// redo the distortion.
+// -----------------------------------------------------------------------------
+
 byte *R_DistortedFlat (int flatnum)
 {
-	static int swirltic = -1;
-	static int swirlflat = -1;
-	static byte distortedflat[FLATSIZE];
-
-	if (swirltic != leveltime)
-	{
-		offset = offsets + ((leveltime & (SEQUENCE - 1)) * FLATSIZE);
-
-		swirltic = leveltime;
-		swirlflat = -1;
-	}
-
-	if (swirlflat != flatnum)
-	{
-		byte *normalflat;
-		int i;
-
-		normalflat = W_CacheLumpNum(flatnum, PU_STATIC);
+    swirlflat_t *flat = NULL;
+
+    for (int i = 0; i < numswirlflats; i++)
+    {
+        if (swirlflats[i]->flatnum == flatnum)
+        {
+            flat = swirlflats[i];
+            break;
+        }
+    }
+
+    if (!flat)
+    {
+        swirlflats = I_Realloc(swirlflats, (numswirlflats + 1) * sizeof(*swirlflats));
+        flat = swirlflats[numswirlflats++] = I_Realloc(NULL, sizeof(*flat));
+        flat->flatnum = flatnum;
+        flat->tic = -1;
+    }
+
+    if (flat->tic != leveltime)
+    {
+        const int frame = leveltime & (SEQUENCE - 1);
+        const byte *normalflat;
+
+        if (offsetsframe != frame)
+        {
+            R_CalcDistortedOffsets(frame);
+        }
+
+        normalflat = W_CacheLumpNum(flatnum, PU_STATIC);
 
         // [PN] Loop through each pixel and apply the distortion.
-		for (i = 0; i < FLATSIZE; i++)
-		{
-			distortedflat[i] = normalflat[offset[i]];
-		}
+        for (int i = 0; i < FLATSIZE; i++)
+        {
+            flat->pixels[i] = normalflat[offsets[i]];
+        }
 
-		W_ReleaseLumpNum(flatnum);
+        W_ReleaseLumpNum(flatnum);
 
-		swirlflat = flatnum;
-	}
+        flat->tic = leveltime;
+    }
 
-	return distortedflat;
+    return flat->pixels;
 }
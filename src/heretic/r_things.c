@@ -74,6 +74,11 @@ const char *spritename;
 static size_t num_vissprite, num_vissprite_alloc, num_vissprite_ptrs; // killough
 static vissprite_t *vissprites, **vissprite_ptrs;                     // killough
 
+// [JN] Player sprites are projected once per frame, before the strips
+// are rendered, so weapon bobbing interpolation is done only once.
+static vissprite_t pspritevis[NUMPSPRITES];
+static int         numpspritevis;
+
 typedef struct drawseg_xrange_item_s
 {
     short x1, x2;
@@ -88,9 +93,9 @@ typedef struct drawsegs_xrange_s
 
 #define DS_RANGES_COUNT 3
 static drawsegs_xrange_t drawsegs_xranges[DS_RANGES_COUNT];
-static drawseg_xrange_item_t *drawsegs_xrange;
+static THREADLOCAL drawseg_xrange_item_t *drawsegs_xrange;
 static unsigned int drawsegs_xrange_size = 0;
-static int drawsegs_xrange_count = 0;
+static THREADLOCAL int drawsegs_xrange_count = 0;
 
 
 /*
@@ -312,12 +317,12 @@ static vissprite_t *R_NewVisSprite (void)
 // Masked means: partly transparent, i.e. stored in posts/runs of opaque pixels.
 // -----------------------------------------------------------------------------
 
-int *mfloorclip;    // [JN] 32-bit integer math
-int *mceilingclip;  // [JN] 32-bit integer math
+THREADLOCAL int *mfloorclip;    // [JN] 32-bit integer math
+THREADLOCAL int *mceilingclip;  // [JN] 32-bit integer math
 
-fixed_t spryscale;
-int64_t sprtopscreen; // [crispy] WiggleFix
-fixed_t sprbotscreen;
+THREADLOCAL fixed_t spryscale;
+THREADLOCAL int64_t sprtopscreen; // [crispy] WiggleFix
+THREADLOCAL fixed_t sprbotscreen;
 
 void R_DrawMaskedColumn(column_t * column, signed int baseclip)
 {
@@ -778,7 +783,7 @@ static inline void R_ApplyWeaponBob (fixed_t *sx, boolean bobx, fixed_t *sy, boo
 }
 
 //
-// R_DrawPSprite
+// R_ProjectPSprite
 //
 
 static const int PSpriteSY[NUMWEAPONS] = {
@@ -795,7 +800,7 @@ static const int PSpriteSY[NUMWEAPONS] = {
 
 boolean pspr_interp = true; // interpolate weapon bobbing
 
-void R_DrawPSprite (pspdef_t* psp)
+static void R_ProjectPSprite (pspdef_t* psp)
 {
     fixed_t		tx;
     int			x1;
@@ -805,7 +810,6 @@ void R_DrawPSprite (pspdef_t* psp)
     int			lump;
     boolean		flip;
     vissprite_t*	vis;
-    vissprite_t		avis;
 
     fixed_t psp_sx = psp->r_sx, psp_sy = psp->r_sy;                           // [crispy]
     const int state = viewplayer->psprites[ps_weapon].state - states;         // [crispy]
@@ -887,7 +891,7 @@ void R_DrawPSprite (pspdef_t* psp)
 //
 // store information in a vissprite
 //
-    vis = &avis;
+    vis = &pspritevis[numpspritevis++];
     vis->mobjflags = 0;
     vis->psprite = true;
     vis->footclip = 0;
@@ -977,16 +981,23 @@ void R_DrawPSprite (pspdef_t* psp)
             pspr_interp = true;
         }
     }
-
-    R_DrawVisSprite (vis);
 }
 
 // -----------------------------------------------------------------------------
-// R_DrawPlayerSprites
+// R_AddPSprites
+// [JN] Projects player sprites of the current frame. Called once per frame
+// from the main thread, before the strips are rendered.
 // -----------------------------------------------------------------------------
 
-static void R_DrawPlayerSprites (void)
+void R_AddPSprites (void)
 {
+    numpspritevis = 0;
+
+    // draw the psprites on top of everything
+    //  but does not draw on side views
+    if (viewangleoffset)
+        return;
+
     // RestlessRodent -- Do not draw player gun sprite if spectating
     if (crl_spectating)
         return;
@@ -997,17 +1008,55 @@ static void R_DrawPlayerSprites (void)
                        + (extralight * LIGHTBRIGHT));
     spritelights = scalelight[lightnum];
 
-    // clip to screen bounds
-    mfloorclip = screenheightarray;
-    mceilingclip = negonearray;
-
     // add all active psprites
     int i;
     pspdef_t *psp;
     for (i = 0, psp = viewplayer->psprites; i < NUMPSPRITES; i++, psp++)
     {
         if (psp->state)
-            R_DrawPSprite(psp);
+            R_ProjectPSprite(psp);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_ClipVisSprite
+// [JN] Clips vissprite to given columns. Returns false if nothing is left.
+// -----------------------------------------------------------------------------
+
+boolean R_ClipVisSprite (vissprite_t *vis, int xl, int xh)
+{
+    if (vis->x1 > xh || vis->x2 < xl)
+        return false;
+
+    if (vis->x1 < xl)
+    {
+        vis->startfrac += vis->xiscale * (xl - vis->x1);
+        vis->x1 = xl;
+    }
+    if (vis->x2 > xh)
+    {
+        vis->x2 = xh;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// R_DrawPlayerSprites
+// -----------------------------------------------------------------------------
+
+static void R_DrawPlayerSprites (void)
+{
+    // clip to screen bounds
+    mfloorclip = screenheightarray;
+    mceilingclip = negonearray;
+
+    for (int i = 0 ; i < numpspritevis ; i++)
+    {
+        vissprite_t vis = pspritevis[i];
+
+        if (R_ClipVisSprite(&vis, stripstart, stripstop))
+            R_DrawVisSprite(&vis);
     }
 }
 
@@ -1214,10 +1263,12 @@ void R_DrawSprite (vissprite_t* spr)
 }
 
 // -------------------------------------------------------------------------
-// R_DrawMasked
+// R_SortMasked
+// [JN] Sorts vissprites and builds drawsegs index for R_DrawMasked.
+// Called once per frame, before the masked parts of any strip are drawn.
 // -------------------------------------------------------------------------
 
-void R_DrawMasked (void)
+void R_SortMasked (void)
 {
     int        i;
     drawseg_t *ds;
@@ -1273,19 +1324,35 @@ void R_DrawMasked (void)
         }
     }
 
+    IDRender.numsprites = num_vissprite;
+}
+
+// -------------------------------------------------------------------------
+// R_DrawMasked
+// -------------------------------------------------------------------------
+
+void R_DrawMasked (void)
+{
+    int        i;
+    drawseg_t *ds;
+
     // draw all vissprites back to front
 
-    IDRender.numsprites = num_vissprite;
     for (i = num_vissprite ; --i>=0 ; )
     {
-        vissprite_t* spr = vissprite_ptrs[i];
+        // [JN] Draw only the part within current strip. Vissprites are
+        // shared by all strips, so clip a copy of it.
+        vissprite_t spr = *vissprite_ptrs[i];
+
+        if (!R_ClipVisSprite(&spr, stripstart, stripstop))
+            continue;
 
-        if (spr->x2 < centerx)
+        if (spr.x2 < centerx)
         {
             drawsegs_xrange = drawsegs_xranges[1].items;
             drawsegs_xrange_count = drawsegs_xranges[1].count;
         }
-        else if (spr->x1 >= centerx)
+        else if (spr.x1 >= centerx)
         {
             drawsegs_xrange = drawsegs_xranges[2].items;
             drawsegs_xrange_count = drawsegs_xranges[2].count;
@@ -1296,7 +1363,7 @@ void R_DrawMasked (void)
             drawsegs_xrange_count = drawsegs_xranges[0].count;
         }
 
-        R_DrawSprite(vissprite_ptrs[i]);    // [JN] killough
+        R_DrawSprite(&spr);    // [JN] killough
     }
 
     // render any remaining masked mid textures
@@ -1309,9 +1376,5 @@ void R_DrawMasked (void)
             R_RenderMaskedSegRange (ds, ds->x1, ds->x2);
 
     // draw the psprites on top of everything
-    //  but does not draw on side views
-    if (!viewangleoffset)
-    {
-        R_DrawPlayerSprites ();
-    }
+    R_DrawPlayerSprites ();
 }
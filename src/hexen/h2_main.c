@@ -42,6 +42,7 @@
 #include "s_sound.h"
 #include "i_input.h"
 #include "i_joystick.h"
+#include "i_perf.h"
 #include "i_system.h"
 #include "i_timer.h"
 #include "m_argv.h"
@@ -497,6 +498,8 @@ void D_DoomMain(void)
     ST_Message("ST_Init: Init startup screen.\n");
     ST_Init();
 
+    I_InitPerf();
+
     // Show version message now, so it's visible during R_Init()
     ST_Message("R_Init: Init Hexen refresh daemon");
     R_Init();
@@ -1050,9 +1053,13 @@ static void DrawAndBlit(void)
             // [JN] Main status bar drawing function.
             if (dp_screen_size < 13 || (automapactive && !automap_overlay))
             {
+                I_PerfStart(PERF_STBAR);
                 SB_Drawer();
+                I_PerfStop(PERF_STBAR);
             }
 
+            I_PerfStart(PERF_WIDGETS);
+
             if (widget_enable)
             {
                 // [JN] Left widgets are available while active game level.
@@ -1091,6 +1098,7 @@ static void DrawAndBlit(void)
                 ID_DrawCrosshair();
             }
 
+            I_PerfStop(PERF_WIDGETS);
             break;
         case GS_INTERMISSION:
             IN_Drawer();
@@ -1108,7 +1116,9 @@ static void DrawAndBlit(void)
     {
         if (dp_screen_size < 13 && gamestate != GS_FINALE)
         {
+            I_PerfStart(PERF_WIDGETS);
             ID_RightWidgets();
+            I_PerfStop(PERF_WIDGETS);
         }
     }
 
@@ -28,6 +28,8 @@
 #include "p_local.h"
 #include "r_local.h"
 
+#include "i_perf.h"
+#include "i_timer.h"
 #include "id_vars.h"
 #include "id_func.h"
 
@@ -351,6 +353,72 @@ void ID_LeftWidgets (void)
     }
 }
 
+// -----------------------------------------------------------------------------
+// ID_ZoneWidget
+//  [JN] Zone memory usage, sizes are in KiB. Updated once a second.
+// -----------------------------------------------------------------------------
+
+static void ID_ZoneWidget (int yy)
+{
+    static zonestats_t stats;
+    static unsigned int lastmallocs, lastfrees;
+    static int lasttime, mallocrate, freerate;
+    const int time = I_GetTimeMS();
+    const char *names[5 + PU_NUM_TAGS + 2];
+    char values[5 + PU_NUM_TAGS + 2][16];
+    int  i, n = 0;
+
+    if (!lasttime || time - lasttime >= 1000)
+    {
+        Z_GetStats(&stats);
+
+        if (lasttime)
+        {
+            mallocrate = (int) (stats.mallocs - lastmallocs) * 1000 / (time - lasttime);
+            freerate = (int) (stats.frees - lastfrees) * 1000 / (time - lasttime);
+        }
+
+        lastmallocs = stats.mallocs;
+        lastfrees = stats.frees;
+        lasttime = time;
+    }
+
+    names[n] = "ZONE";
+    M_snprintf(values[n++], 16, "%dK", stats.zonesize >> 10);
+    names[n] = "GROW";
+    M_snprintf(values[n++], 16, "%d", stats.growths);
+    names[n] = "FREE";
+    M_snprintf(values[n++], 16, "%dK", stats.freebytes >> 10);
+    names[n] = "LRG";
+    M_snprintf(values[n++], 16, "%dK", stats.largestfree >> 10);
+    names[n] = "FRG";
+    M_snprintf(values[n++], 16, "%d%%", stats.freebytes ?
+               100 - (int) ((int64_t) stats.largestfree * 100 / stats.freebytes) : 0);
+
+    for (i = 0 ; i < PU_NUM_TAGS ; i++)
+    {
+        if (zone_tagnames[i])
+        {
+            names[n] = zone_tagnames[i];
+            M_snprintf(values[n++], 16, "%dK/%d", stats.bytes[i] >> 10, stats.blocks[i]);
+        }
+    }
+
+    names[n] = "ALC/S";
+    M_snprintf(values[n++], 16, "%d", mallocrate);
+    names[n] = "FRE/S";
+    M_snprintf(values[n++], 16, "%d", freerate);
+
+    for (i = 0 ; i < n ; i++)
+    {
+        const int x = ORIGWIDTH + WIDESCREENDELTA - 7 - MN_TextAWidth(values[i]);
+
+        MN_DrTextA(values[i], x, yy, ID_WidgetColor(widget_render_val));
+        MN_DrTextA(names[i], x - 4 - MN_TextAWidth(names[i]), yy, ID_WidgetColor(widget_render_str));
+        yy += 10;
+    }
+}
+
 // -----------------------------------------------------------------------------
 // ID_RightWidgets.
 //  [JN] Draw actual frames per second value.
@@ -391,6 +459,38 @@ void ID_RightWidgets (void)
     {
         MN_DrTextA(ID_Local_Time, ORIGWIDTH + WIDESCREENDELTA - 7
                               - MN_TextAWidth(ID_Local_Time), yy, cr[CR_GRAY]);
+
+        yy += 10;
+    }
+
+    // [JN] Zone memory usage.
+    if (widget_render == 3)
+    {
+        ID_ZoneWidget(yy + 5);
+    }
+
+    // [JN] Frame phase timings, in microseconds.
+    if (widget_render == 2)
+    {
+        char str[32];
+        int  i;
+
+        yy += 5;
+        MN_DrTextA("MIN/AVG/P99", ORIGWIDTH + WIDESCREENDELTA - 7 - MN_TextAWidth("MIN/AVG/P99"), yy, ID_WidgetColor(widget_render_str));
+
+        for (i = 0 ; i < NUMPERFPHASES ; i++)
+        {
+            perfstat_t stat;
+            int x;
+
+            yy += 10;
+            I_PerfGetStats(i, &stat);
+            M_snprintf(str, sizeof(str), "%d/%d/%d", stat.min, stat.avg, stat.p99);
+            x = ORIGWIDTH + WIDESCREENDELTA - 7 - MN_TextAWidth(str);
+
+            MN_DrTextA(str, x, yy, ID_WidgetColor(widget_render_val));
+            MN_DrTextA(perf_names[i], x - 4 - MN_TextAWidth(perf_names[i]), yy, ID_WidgetColor(widget_render_str));
+        }
     }
 }
 
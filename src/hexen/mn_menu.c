@@ -3052,7 +3052,9 @@ static void M_Draw_ID_Widgets (void)
                M_Item_Glow(6, widget_coords ? GLOW_GREEN : GLOW_DARKRED));
 
     // Render counters
-    sprintf(str, widget_render ? "ON" : "OFF");
+    sprintf(str, widget_render == 1 ? "ON"      :
+                 widget_render == 2 ? "TIMINGS" :
+                 widget_render == 3 ? "ZONE"    : "OFF");
     MN_DrTextA(str, M_ItemRightAlign(str), 90,
                M_Item_Glow(7, widget_render ? GLOW_GREEN : GLOW_DARKRED));
 
@@ -3102,7 +3104,7 @@ static void M_ID_Widget_Coords (int choice)
 
 static void M_ID_Widget_Render (int choice)
 {
-    widget_render ^= 1;
+    widget_render = M_INT_Slider(widget_render, 0, 3, choice, false);
 }
 
 static void M_ID_Widget_Health (int choice)
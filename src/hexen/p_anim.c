@@ -560,8 +560,6 @@ void P_InitFTAnims(void)
     }
     SC_Close();
 
-    // [JN] Initialize swirling surfaces.
-    R_InitDistortedFlats();
     // [JN] Predefine flat names to avoid extra hitting of R_FlatNumForName.
     x_001 = R_FlatNumForName("x_001");
     x_005 = R_FlatNumForName("x_005");
@@ -86,6 +86,7 @@ extern int TimerGame;           // tic countdown for deathmatch
 void P_InitThinkers(void);
 void P_AddThinker(thinker_t * thinker);
 void P_RemoveThinker(thinker_t * thinker);
+void P_FreeThinker(thinker_t * thinker);
 
 // ***** P_PSPR *****
 
@@ -145,6 +146,9 @@ extern mobj_t *MissileMobj;
 extern fixed_t FloatBobOffsets[64];
 
 
+void P_InitMobjPool(void);
+mobj_t *P_AllocMobj(void);
+void P_FreeMobj(mobj_t * mobj);
 mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type);
 void P_RemoveMobj(mobj_t * th);
 boolean P_SetMobjState(mobj_t * mobj, statenum_t state);
@@ -1209,6 +1209,75 @@ void P_MobjThinker(thinker_t *thinker)
     }
 }
 
+//==========================================================================
+//
+// [JN] Mobj pool
+//
+// Mobjs are allocated from PU_LEVEL pages of MOBJPAGE mobjs, and freed
+// ones are reused first, so the mobjs of a level are packed together
+// instead of being scattered through the zone. The pages are freed with
+// the level by Z_FreeTags, P_InitMobjPool then forgets them.
+//
+//==========================================================================
+
+#define MOBJPAGE 128
+
+static mobj_t *mobjpage;        // current page
+static int mobjpageused;        // mobjs taken from the current page
+static mobj_t *mobjfree;        // freed mobjs, linked by thinker.next
+
+void P_InitMobjPool(void)
+{
+    mobjpage = NULL;
+    mobjpageused = MOBJPAGE;
+    mobjfree = NULL;
+}
+
+//==========================================================================
+//
+// P_AllocMobj
+//
+// Returns a cleared mobj, must be added with P_AddThinker.
+//
+//==========================================================================
+
+mobj_t *P_AllocMobj(void)
+{
+    mobj_t *mobj;
+
+    if (mobjfree)
+    {
+        mobj = mobjfree;
+        mobjfree = (mobj_t *) mobj->thinker.next;
+    }
+    else
+    {
+        if (mobjpageused == MOBJPAGE)
+        {
+            mobjpage = Z_Malloc(MOBJPAGE * sizeof(*mobjpage), PU_LEVEL, NULL);
+            mobjpageused = 0;
+        }
+        mobj = &mobjpage[mobjpageused++];
+    }
+
+    memset(mobj, 0, sizeof(*mobj));
+    return mobj;
+}
+
+//==========================================================================
+//
+// P_FreeMobj
+//
+// Returns a mobj to the pool, it must not be linked anymore.
+//
+//==========================================================================
+
+void P_FreeMobj(mobj_t * mobj)
+{
+    mobj->thinker.next = (thinker_t *) mobjfree;
+    mobjfree = mobj;
+}
+
 //==========================================================================
 //
 // P_SpawnMobj
@@ -1222,8 +1291,7 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type)
     mobjinfo_t *info;
     fixed_t space;
 
-    mobj = Z_Malloc(sizeof(*mobj), PU_LEVEL, NULL);
-    memset(mobj, 0, sizeof(*mobj));
+    mobj = P_AllocMobj();
     info = &mobjinfo[type];
     mobj->type = type;
     mobj->info = info;
@@ -891,6 +891,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
     */
 
     Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+    P_InitMobjPool();
 
     P_InitThinkers();
     leveltime = 0;
@@ -899,6 +900,11 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
 
     M_snprintf(lumpname, sizeof(lumpname), "MAP%02d", map);
     lumpnum = W_GetNumForName(lumpname);
+    // [JN] Let the map lumps be read from memory-mapped WAD in background.
+    W_PrefetchLumps(lumpnum, ML_BEHAVIOR + 1);
+
+    // [JN] Log memory left after the previous level, if -zonestats is given.
+    Z_LogStats(lumpname);
 
     maplumpinfo = lumpinfo[lumpnum];
 
@@ -919,6 +925,7 @@ void P_SetupLevel(int episode, int map, int playermask, skill_t skill)
     P_LoadSegs(lumpnum + ML_SEGS);
     rejectmatrix = W_CacheLumpNum(lumpnum + ML_REJECT, PU_LEVEL);
     P_GroupLines();
+    P_InitTagLists();
 
     // [crispy] remove slime trails
     P_RemoveSlimeTrails();
@@ -68,8 +68,10 @@ static struct
 {
     line_t *line;
     int lineTag;
+    int nextTagged;             // [JN] next line of the same tag hash
 } TaggedLines[MAX_TAGGED_LINES];
 static int TaggedLineCount;
+static int FirstTaggedLine[MAX_TAGGED_LINES];
 
 mobj_t LavaInflictor;
 
@@ -329,24 +331,66 @@ int     P_FindSectorFromLineTag(line_t  *line,int start)
 }
 */
 
+//=========================================================================
+//
+// P_InitTagLists
+//
+// [JN] killough 1/30/98: hash sectors by tag, so finding the sectors
+// of a tag, e.g. by TagBusy for every ACS tag wait, does not scan all
+// of them. Chains are built backwards, so sectors are found in
+// ascending order, like the linear search did.
+//
+//=========================================================================
+
+void P_InitTagLists(void)
+{
+    int i;
+
+    for (i = numsectors; --i >= 0;)
+    {
+        sectors[i].firsttag = -1;
+    }
+    for (i = numsectors; --i >= 0;)
+    {
+        const int j = (unsigned) sectors[i].tag % (unsigned) numsectors;
+
+        sectors[i].nexttag = sectors[j].firsttag;
+        sectors[j].firsttag = i;
+    }
+}
+
 //=========================================================================
 //
 // P_FindSectorFromTag
 //
+// [JN] Like the linear search, returns the first sector after start,
+// which does not need to have this tag.
+//
 //=========================================================================
 
 int P_FindSectorFromTag(int tag, int start)
 {
     int i;
 
-    for (i = start + 1; i < numsectors; i++)
+    if (start >= 0 && sectors[start].tag == tag)
+    {
+        i = sectors[start].nexttag;
+    }
+    else
     {
-        if (sectors[i].tag == tag)
+        i = sectors[(unsigned) tag % (unsigned) numsectors].firsttag;
+
+        while (i >= 0 && i <= start)
         {
-            return i;
+            i = sectors[i].nexttag;
         }
     }
-    return -1;
+
+    while (i >= 0 && sectors[i].tag != tag)
+    {
+        i = sectors[i].nexttag;
+    }
+    return i;
 }
 
 //==================================================================
@@ -1198,6 +1242,20 @@ void P_SpawnSpecials(void)
         }
     }
 
+    // [JN] Chain tagged lines by tag hash for P_FindLine, backwards,
+    // so lines are found in the order they were added.
+    for (i = 0; i < MAX_TAGGED_LINES; i++)
+    {
+        FirstTaggedLine[i] = -1;
+    }
+    for (i = TaggedLineCount; --i >= 0;)
+    {
+        const int j = (unsigned) TaggedLines[i].lineTag % MAX_TAGGED_LINES;
+
+        TaggedLines[i].nextTagged = FirstTaggedLine[j];
+        FirstTaggedLine[j] = i;
+    }
+
     //
     //      Init other misc stuff
     //
@@ -1222,7 +1280,10 @@ line_t *P_FindLine(int lineTag, int *searchPosition)
 {
     int i;
 
-    for (i = *searchPosition + 1; i < TaggedLineCount; i++)
+    i = *searchPosition >= 0 ? TaggedLines[*searchPosition].nextTagged :
+        FirstTaggedLine[(unsigned) lineTag % MAX_TAGGED_LINES];
+
+    for (; i >= 0; i = TaggedLines[i].nextTagged)
     {
         if (TaggedLines[i].lineTag == lineTag)
         {
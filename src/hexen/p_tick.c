@@ -125,7 +125,7 @@ static void RunThinkers(void)
             nextthinker = currentthinker->next;
             currentthinker->next->prev = currentthinker->prev;
             currentthinker->prev->next = currentthinker->next;
-            Z_Free(currentthinker);
+            P_FreeThinker(currentthinker);
         }
         else
         {
@@ -157,10 +157,14 @@ void P_InitThinkers(void)
 //
 // Adds a new thinker at the end of the list.
 //
+// [JN] Mobjs get their function before being added and are
+// allocated by P_AllocMobj, other thinkers by Z_Malloc.
+//
 //==========================================================================
 
 void P_AddThinker(thinker_t * thinker)
 {
+    thinker->pooled = thinker->function == P_MobjThinker;
     thinkercap.prev->next = thinker;
     thinker->next = &thinkercap;
     thinker->prev = thinkercap.prev;
@@ -180,3 +184,24 @@ void P_RemoveThinker(thinker_t * thinker)
 {
     thinker->function = (think_t) - 1;
 }
+
+//==========================================================================
+//
+// P_FreeThinker
+//
+// [JN] Frees a thinker which is no longer linked,
+// mobjs are returned to the mobj pool.
+//
+//==========================================================================
+
+void P_FreeThinker(thinker_t * thinker)
+{
+    if (thinker->pooled)
+    {
+        P_FreeMobj((mobj_t *) thinker);
+    }
+    else
+    {
+        Z_Free(thinker);
+    }
+}
@@ -307,7 +307,7 @@ static const byte blueonly[256] =
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 };
 
-const byte *dc_brightmap = nobrightmap;
+THREADLOCAL const byte *dc_brightmap = nobrightmap;
 
 // [crispy] brightmaps for textures
 
@@ -23,10 +23,10 @@
 #include "am_map.h"
 
 
-seg_t *curline;
-side_t *sidedef;
-line_t *linedef;
-sector_t *frontsector, *backsector;
+THREADLOCAL seg_t *curline;
+THREADLOCAL side_t *sidedef;
+THREADLOCAL line_t *linedef;
+THREADLOCAL sector_t *frontsector, *backsector;
 
 // [JN] killough: New code which removes 2s linedef limit
 drawseg_t *drawsegs;
@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include "h2def.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "i_video.h"
 #include "r_local.h"
 #include "v_video.h"
@@ -51,14 +52,152 @@ static pixel_t *background_buffer = NULL;
 ==================
 */
 
-lighttable_t *dc_colormap[2]; // [crispy] brightmaps
-int dc_x;
-int dc_yl;
-int dc_yh;
-fixed_t dc_iscale;
-fixed_t dc_texturemid;
-int dc_texheight; // [crispy]
-byte *dc_source;                // first pixel in a column (possibly virtual)
+THREADLOCAL lighttable_t *dc_colormap[2]; // [crispy] brightmaps
+THREADLOCAL int dc_x;
+THREADLOCAL int dc_yl;
+THREADLOCAL int dc_yh;
+THREADLOCAL fixed_t dc_iscale;
+THREADLOCAL fixed_t dc_texturemid;
+THREADLOCAL int dc_texheight; // [crispy]
+THREADLOCAL byte *dc_source;                // first pixel in a column (possibly virtual)
+
+// -----------------------------------------------------------------------------
+// Wall column recording.
+//
+// [JN] With more than one render thread, BSP tree is walked only once per
+// frame on the main thread. Wall columns can't be drawn at that point, as
+// every strip is drawn by its own thread, so R_DrawWallColumn records them
+// into the list of the strip they belong to instead. Every strip replays
+// its own list with R_ReplayColumns later on.
+//
+// Wall columns never overlap each other, so replaying them strip by strip
+// gives the same result as drawing them during the BSP walk.
+// -----------------------------------------------------------------------------
+
+typedef struct
+{
+    void (*func) (void);
+    lighttable_t *colormap[2];
+    const byte   *brightmap;
+    byte         *source;
+    fixed_t       iscale;
+    fixed_t       texturemid;
+    int           texheight;
+    int           x;
+    int           yl;
+    int           yh;
+} colcmd_t;
+
+typedef struct
+{
+    colcmd_t *cmds;
+    int       count;
+    int       size;
+} colstrip_t;
+
+static colstrip_t colstrips[MAXTHREADS];
+static byte       colstripnum[MAXWIDTH];  // Strip of every view column.
+static boolean    recordcolumns;
+
+// -----------------------------------------------------------------------------
+// R_StartRecordColumns
+//  Empties column lists of "numstrips" strips and starts recording.
+// -----------------------------------------------------------------------------
+
+void R_StartRecordColumns (int numstrips)
+{
+    for (int i = 0 ; i < numstrips ; i++)
+    {
+        colstrips[i].count = 0;
+
+        for (int x = R_StripStart(i, numstrips) ; x < R_StripStart(i + 1, numstrips) ; x++)
+        {
+            colstripnum[x] = i;
+        }
+    }
+
+    recordcolumns = true;
+}
+
+// -----------------------------------------------------------------------------
+// R_StopRecordColumns
+// -----------------------------------------------------------------------------
+
+void R_StopRecordColumns (void)
+{
+    recordcolumns = false;
+}
+
+// -----------------------------------------------------------------------------
+// R_DrawWallColumn
+//  Draws wall column with colfunc, or stores current dc_* values
+//  and colfunc in the list of its strip while recording.
+// -----------------------------------------------------------------------------
+
+void R_DrawWallColumn (void)
+{
+    colstrip_t *strip;
+    colcmd_t *cmd;
+
+    if (!recordcolumns)
+    {
+        colfunc();
+        return;
+    }
+
+    if (dc_yl > dc_yh)
+    {
+        return;
+    }
+
+    strip = &colstrips[colstripnum[dc_x]];
+
+    if (strip->count == strip->size)
+    {
+        strip->size = strip->size ? strip->size * 2 : 512;
+        strip->cmds = I_Realloc(strip->cmds, strip->size * sizeof(*strip->cmds));
+    }
+
+    cmd = &strip->cmds[strip->count++];
+    cmd->func = colfunc;
+    cmd->colormap[0] = dc_colormap[0];
+    cmd->colormap[1] = dc_colormap[1];
+    cmd->brightmap = dc_brightmap;
+    cmd->source = dc_source;
+    cmd->iscale = dc_iscale;
+    cmd->texturemid = dc_texturemid;
+    cmd->texheight = dc_texheight;
+    cmd->x = dc_x;
+    cmd->yl = dc_yl;
+    cmd->yh = dc_yh;
+}
+
+// -----------------------------------------------------------------------------
+// R_ReplayColumns
+//  Draws recorded wall columns of the strip.
+// -----------------------------------------------------------------------------
+
+void R_ReplayColumns (int strip)
+{
+    const colstrip_t *const cs = &colstrips[strip];
+
+    for (int i = 0 ; i < cs->count ; i++)
+    {
+        const colcmd_t *const cmd = &cs->cmds[i];
+
+        dc_colormap[0] = cmd->colormap[0];
+        dc_colormap[1] = cmd->colormap[1];
+        dc_brightmap = cmd->brightmap;
+        dc_source = cmd->source;
+        dc_iscale = cmd->iscale;
+        dc_texturemid = cmd->texturemid;
+        dc_texheight = cmd->texheight;
+        dc_x = cmd->x;
+        dc_yl = cmd->yl;
+        dc_yh = cmd->yh;
+        cmd->func();
+    }
+}
 
 // -----------------------------------------------------------------------------
 // R_DrawColumn
@@ -381,7 +520,7 @@ void R_DrawTLAddColumnLow(void)
 // do/while with for loops, and simplified arithmetic operations.
 // -----------------------------------------------------------------------------
 
-byte *dc_translation;
+THREADLOCAL byte *dc_translation;
 byte *translationtables;
 
 void R_DrawTranslatedColumn(void)
@@ -684,15 +823,15 @@ void R_InitTranslationTables(void)
 // The loop unrolling by four is retained for performance reasons.
 // -----------------------------------------------------------------------------
 
-int ds_y;
-int ds_x1;
-int ds_x2;
-lighttable_t *ds_colormap;
-fixed_t ds_xfrac;
-fixed_t ds_yfrac;
-fixed_t ds_xstep;
-fixed_t ds_ystep;
-byte *ds_source;                // start of a 64*64 tile image
+THREADLOCAL int ds_y;
+THREADLOCAL int ds_x1;
+THREADLOCAL int ds_x2;
+THREADLOCAL lighttable_t *ds_colormap;
+THREADLOCAL fixed_t ds_xfrac;
+THREADLOCAL fixed_t ds_yfrac;
+THREADLOCAL fixed_t ds_xstep;
+THREADLOCAL fixed_t ds_ystep;
+THREADLOCAL byte *ds_source;                // start of a 64*64 tile image
 
 void R_DrawSpan(void)
 {
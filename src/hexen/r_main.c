@@ -23,6 +23,8 @@
 #include "h2def.h"
 #include "m_bbox.h"
 #include "r_local.h"
+#include "i_perf.h"
+#include "i_thread.h"
 
 #include "id_vars.h"
 #include "id_func.h"
@@ -91,7 +93,7 @@ int LIGHTSCALESHIFT;
 int MAXLIGHTZ;
 int LIGHTZSHIFT;
 
-void (*colfunc) (void);
+THREADLOCAL void (*colfunc) (void);
 void (*basecolfunc) (void);
 void (*tlcolfunc) (void);
 void (*tladdcolfunc) (void);
@@ -99,6 +101,10 @@ void (*transcolfunc) (void);
 void (*extratlcolfunc) (void);
 void (*spanfunc) (void);
 
+// [JN] Columns of the view drawn by the current thread.
+THREADLOCAL int stripstart, stripstop;
+static int numstrips = 1;
+
 void SB_ForceRedraw(void); // [crispy] sb_bar.c
 
 /*
@@ -1086,7 +1092,6 @@ void R_SetupFrame(player_t * player)
             // [crispy] sizeof(lighttable_t) not needed in paletted render
             // and breaks Torch's fixed colormap indexes in true color render
             * 256 /* * sizeof(lighttable_t)*/;
-        walllights = scalelightfixed;
         for (i = 0; i < MAXLIGHTSCALE; i++)
         {
             scalelightfixed[i] = fixedcolormap;
@@ -1107,6 +1112,52 @@ void R_SetupFrame(player_t * player)
 #endif
 }
 
+// -----------------------------------------------------------------------------
+// R_SetupStrip
+// [JN] Sets up render state of the current thread for columns x1...x2.
+// -----------------------------------------------------------------------------
+
+static void R_SetupStrip (int x1, int x2)
+{
+    stripstart = x1;
+    stripstop = x2;
+
+    colfunc = basecolfunc;
+
+    if (fixedcolormap)
+    {
+        walllights = scalelightfixed;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// R_RenderStrip
+// [JN] Draws one vertical strip of the view. BSP tree is walked only once
+// per frame on the main thread, strips are drawing recorded wall columns,
+// then parts of planes and masked things which are within their bounds.
+// -----------------------------------------------------------------------------
+
+static void R_RenderStrip (int strip)
+{
+    R_SetupStrip(R_StripStart(strip, numstrips),
+                 R_StripStart(strip + 1, numstrips) - 1);
+
+    // [JN] Phase timings are taken from the first strip,
+    // recorded wall columns are counted as a part of planes.
+    if (!strip)
+        I_PerfStart(PERF_PLANES);
+    R_ReplayColumns (strip);
+    R_DrawPlanes ();
+    if (!strip)
+    {
+        I_PerfStop(PERF_PLANES);
+        I_PerfStart(PERF_MASKED);
+    }
+    R_DrawMasked ();
+    if (!strip)
+        I_PerfStop(PERF_MASKED);
+}
+
 /*
 ==============
 =
@@ -1123,6 +1174,7 @@ void R_RenderPlayerView(player_t * player)
     memset(&IDRender, 0, sizeof(IDRender));
 
     R_SetupFrame(player);
+    R_SetupStrip(0, viewwidth - 1);
     R_ClearClipSegs();
     R_ClearDrawSegs();
     R_ClearPlanes();
@@ -1141,6 +1193,18 @@ void R_RenderPlayerView(player_t * player)
     R_InterpolateTextureOffsets(); // [crispy] Smooth texture scrolling
     }
 
+    numstrips = MIN(I_GetThreadCount(vid_render_threads), viewwidth);
+
+    if (numstrips > 1)
+    {
+        // [JN] Wall columns are recorded during the BSP walk and drawn by
+        // the strips. Pin their sources and everything else the strips
+        // look up in the zone memory until then, purging the rest.
+        Z_StartPinning();
+        R_StartRecordColumns(numstrips);
+    }
+
+    I_PerfStart(PERF_BSP);
     // Make displayed player invisible locally
     if (localQuakeHappening[displayplayer] && gamestate == GS_LEVEL)
     {
@@ -1152,10 +1216,31 @@ void R_RenderPlayerView(player_t * player)
     {
         R_RenderBSPNode(numnodes - 1);  // head node is the last node output
     }
+    I_PerfStop(PERF_BSP);
 
     NetUpdate();                // check for new console commands
-    R_DrawPlanes();
-    NetUpdate();                // check for new console commands
-    R_DrawMasked();
+
+    // [JN] Set up planes and sort things once for all strips.
+    R_SetupPlanes();
+    R_SortMasked();
+    R_AddPSprites();
+
+    if (numstrips > 1)
+    {
+        R_StopRecordColumns();
+        I_RunThreadJobs(R_RenderStrip, numstrips);
+        Z_StopPinning();
+    }
+    else
+    {
+        I_PerfStart(PERF_PLANES);
+        R_DrawPlanes();
+        I_PerfStop(PERF_PLANES);
+        NetUpdate();                // check for new console commands
+        I_PerfStart(PERF_MASKED);
+        R_DrawMasked();
+        I_PerfStop(PERF_MASKED);
+    }
+
     NetUpdate();                // check for new console commands
 }
@@ -45,7 +45,7 @@ angle_t rw_centerangle;
 fixed_t rw_offset;
 fixed_t rw_distance;
 fixed_t rw_scale;
-fixed_t rw_scalestep;
+THREADLOCAL fixed_t rw_scalestep;
 fixed_t rw_midtexturemid;
 fixed_t rw_toptexturemid;
 fixed_t rw_bottomtexturemid;
@@ -60,9 +60,9 @@ int64_t bottomfrac; // [crispy] WiggleFix
 fixed_t bottomstep;
 
 
-lighttable_t **walllights;
+THREADLOCAL lighttable_t **walllights;
 
-int *maskedtexturecol;  // [crispy] 32-bit integer math
+THREADLOCAL int *maskedtexturecol;  // [crispy] 32-bit integer math
 
 // [crispy] WiggleFix: add this code block near the top of r_segs.c
 //
@@ -165,6 +165,15 @@ void R_FixWiggle (sector_t *sector)
 
 void R_RenderMaskedSegRange (drawseg_t *ds, int x1, int x2)
 {
+    // [JN] Draw only columns of the current strip.
+    x1 = MAX(x1, stripstart);
+    x2 = MIN(x2, stripstop);
+
+    if (x1 > x2)
+    {
+        return;
+    }
+
     // Calculate light table.
     // Use different light tables
     //   for horizontal / vertical / diagonal. Diagonal?
@@ -363,7 +372,7 @@ void R_RenderSegLoop(void)
             dc_source = R_GetColumn(midtexture, texturecolumn);
             dc_texheight = textureheight[midtexture] >> FRACBITS;
             dc_brightmap = texturebrightmap[midtexture];
-            colfunc ();
+            R_DrawWallColumn ();
             ceilingclip[rw_x] = viewheight;
             floorclip[rw_x] = -1;
         }
@@ -384,7 +393,7 @@ void R_RenderSegLoop(void)
                     dc_source = R_GetColumn(toptexture,texturecolumn);
                     dc_texheight = textureheight[toptexture]>>FRACBITS;
                     dc_brightmap = texturebrightmap[toptexture];
-                    colfunc ();
+                    R_DrawWallColumn ();
                     ceilingclip[rw_x] = mid;
                 }
                 else
@@ -415,7 +424,7 @@ void R_RenderSegLoop(void)
                     dc_source = R_GetColumn(bottomtexture,texturecolumn);
                     dc_texheight = textureheight[bottomtexture]>>FRACBITS;
                     dc_brightmap = texturebrightmap[bottomtexture];
-                    colfunc ();
+                    R_DrawWallColumn ();
                     floorclip[rw_x] = mid;
                 }
                 else
@@ -22,5 +22,4 @@
 
 #include "doomtype.h"
 
-extern void  R_InitDistortedFlats (void);
 extern byte *R_DistortedFlat (int flatnum);
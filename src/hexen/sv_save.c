@@ -155,7 +155,11 @@ static mobj_t **MobjList;
 static mobj_t ***TargetPlayerAddrs;
 static int TargetPlayerCount;
 static boolean SavingPlayers;
-static FILE *SavingFP;
+static byte *SaveBuffer;
+static size_t SaveBufferSize;   // allocated size of SaveBuffer
+static size_t SaveLength;       // bytes of data in SaveBuffer
+static size_t SavePos;          // current read/write position
+static char *SaveFileName;      // file being written, NULL when reading
 
 // CODE --------------------------------------------------------------------
 
@@ -2108,7 +2112,7 @@ void SV_LoadGame(int slot)
     SV_OpenRead(fileName);
 
     // Set the save pointer and skip the description field
-    fseek(SavingFP, HXS_DESCRIPTION_LENGTH, SEEK_CUR);
+    SavePos += HXS_DESCRIPTION_LENGTH;
 
     // Check the version text
 
@@ -2609,6 +2613,7 @@ static void UnarchiveWorld(void)
         sec->specialdata = 0;
         sec->soundtarget = 0;
     }
+    P_InitTagLists();           // [JN] tags were read again
     for (i = 0, li = lines; i < numlines; i++, li++)
     {
         li->flags = SV_ReadWord();
@@ -2717,7 +2722,7 @@ static void UnarchiveMobjs(void)
     MobjList = Z_Malloc(MobjCount * sizeof(mobj_t *), PU_STATIC, NULL);
     for (i = 0; i < MobjCount; i++)
     {
-        MobjList[i] = Z_Malloc(sizeof(mobj_t), PU_LEVEL, NULL);
+        MobjList[i] = P_AllocMobj();
     }
     for (i = 0; i < MobjCount; i++)
     {
@@ -3158,7 +3163,7 @@ static void RemoveAllThinkers(void)
         }
         else
         {
-            Z_Free(thinker);
+            P_FreeThinker(thinker);
         }
         thinker = nextThinker;
     }
@@ -3485,40 +3490,102 @@ static boolean ExistingFile(char *name)
     }
 }
 
+//==========================================================================
+//
+// SV_Grow
+//
+//==========================================================================
+
+static void SV_Grow(size_t size)
+{
+    if (SavePos + size > SaveBufferSize)
+    {
+        size_t newsize = SaveBufferSize ? SaveBufferSize : 64 * 1024;
+
+        while (SavePos + size > newsize)
+        {
+            newsize *= 2;
+        }
+
+        SaveBuffer = I_Realloc(SaveBuffer, newsize);
+        SaveBufferSize = newsize;
+    }
+}
+
 //==========================================================================
 //
 // SV_Open
 //
+// [JN] Save files are read into a memory buffer in one go, and written
+// from it in one go by SV_Close.
+//
 //==========================================================================
 
 static void SV_OpenRead(char *fileName)
 {
-    SavingFP = M_fopen(fileName, "rb");
+    FILE *handle;
+    long length;
+
+    handle = M_fopen(fileName, "rb");
 
     // Should never happen, only if hex6.sav cannot ever be created.
-    if (SavingFP == NULL)
+    if (handle == NULL)
     {
         I_Error("Could not load savegame %s", fileName);
     }
+
+    length = M_FileLength(handle);
+    SavePos = 0;
+    SaveLength = 0;
+
+    if (length > 0)
+    {
+        SV_Grow(length);
+        SaveLength = fread(SaveBuffer, 1, length, handle);
+    }
+
+    fclose(handle);
 }
 
 static void SV_OpenWrite(char *fileName)
 {
-    SavingFP = M_fopen(fileName, "wb");
+    free(SaveFileName);
+    SaveFileName = M_StringDuplicate(fileName);
+    SavePos = 0;
+    SaveLength = 0;
 }
 
 //==========================================================================
 //
 // SV_Close
 //
+// Writes the buffer to a temporary file, which is then renamed to the
+// real file, so an existing file is never left partially written.
+//
 //==========================================================================
 
 static void SV_Close(void)
 {
-    if (SavingFP)
+    char *tempName;
+
+    if (SaveFileName == NULL)
     {
-        fclose(SavingFP);
+        return;
     }
+
+    tempName = M_StringJoin(SavePath, "temp.sav", NULL);
+
+    if (!M_WriteFile(tempName, SaveBuffer, (int) SaveLength))
+    {
+        I_Error("Couldn't write to file %s", tempName);
+    }
+
+    M_remove(SaveFileName);
+    M_rename(tempName, SaveFileName);
+
+    free(tempName);
+    free(SaveFileName);
+    SaveFileName = NULL;
 }
 
 //==========================================================================
@@ -3529,19 +3596,25 @@ static void SV_Close(void)
 
 static void SV_Read(void *buffer, int size)
 {
-    int retval = fread(buffer, 1, size, SavingFP);
-    if (retval != size)
+    if (SavePos + size > SaveLength)
     {
         I_Error("Incomplete read in SV_Read: Expected %d, got %d bytes",
-            size, retval);
+            size, SavePos < SaveLength ? (int) (SaveLength - SavePos) : 0);
     }
+
+    memcpy(buffer, SaveBuffer + SavePos, size);
+    SavePos += size;
 }
 
 static byte SV_ReadByte(void)
 {
-    byte result;
-    SV_Read(&result, sizeof(byte));
-    return result;
+    if (SavePos >= SaveLength)
+    {
+        I_Error("Incomplete read in SV_Read: Expected %d, got %d bytes",
+            1, 0);
+    }
+
+    return SaveBuffer[SavePos++];
 }
 
 static uint16_t SV_ReadWord(void)
@@ -3578,24 +3651,29 @@ static void *SV_ReadPtr(void)
 
 static void SV_Write(const void *buffer, int size)
 {
-    fwrite(buffer, size, 1, SavingFP);
+    SV_Grow(size);
+    memcpy(SaveBuffer + SavePos, buffer, size);
+    SavePos += size;
+    SaveLength = SavePos;
 }
 
 static void SV_WriteByte(byte val)
 {
-    fwrite(&val, sizeof(byte), 1, SavingFP);
+    SV_Grow(1);
+    SaveBuffer[SavePos++] = val;
+    SaveLength = SavePos;
 }
 
 static void SV_WriteWord(unsigned short val)
 {
     val = SHORT(val);
-    fwrite(&val, sizeof(unsigned short), 1, SavingFP);
+    SV_Write(&val, sizeof(unsigned short));
 }
 
 static void SV_WriteLong(unsigned int val)
 {
     val = LONG(val);
-    fwrite(&val, sizeof(int), 1, SavingFP);
+    SV_Write(&val, sizeof(int));
 }
 
 static void SV_WriteLongLong(int64_t val)
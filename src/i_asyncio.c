@@ -0,0 +1,245 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Background file writing, used for savegames.
+//
+//      The data is written to a temporary file, flushed to disk and
+//      only then renamed over the real file, so the real file is either
+//      the old or the new one, never a partial one. Writes are done one
+//      at a time on a thread of their own, the game thread picks up the
+//      result in I_PollFileWrites and reports it through the "done"
+//      function. Pending writes are finished before the program exits.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "SDL.h"
+
+#include "i_asyncio.h"
+#include "i_system.h"
+#include "m_misc.h"
+
+
+static SDL_Thread   *write_thread;
+static SDL_atomic_t  write_finished;
+static boolean       write_success;
+static boolean       exit_registered;
+
+static char         *write_filename;
+static char         *write_tempname;
+static byte         *write_data;
+static size_t        write_length;
+static writedone_t   write_done;
+
+
+// -----------------------------------------------------------------------------
+// RenameOverFile
+// Renames the temporary file over the real one in a single step, so
+// there is no moment when neither the old nor the new file exists.
+// -----------------------------------------------------------------------------
+
+static boolean RenameOverFile (void)
+{
+#ifdef _WIN32
+    wchar_t *wtemp, *wname;
+    boolean success;
+
+    wtemp = M_ConvertUtf8ToWide(write_tempname);
+    wname = M_ConvertUtf8ToWide(write_filename);
+
+    success = wtemp && wname
+           && MoveFileExW(wtemp, wname, MOVEFILE_REPLACE_EXISTING
+                                      | MOVEFILE_WRITE_THROUGH) != 0;
+
+    free(wtemp);
+    free(wname);
+
+    return success;
+#else
+    // POSIX rename replaces the target atomically.
+    return M_rename(write_tempname, write_filename) == 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// WriteDurable
+// Writes the data to the temporary file, makes sure it has reached
+// the disk and renames it to the real file.
+// -----------------------------------------------------------------------------
+
+static boolean WriteDurable (void)
+{
+    FILE *handle;
+    boolean success;
+
+    handle = M_fopen(write_tempname, "wb");
+
+    if (handle == NULL)
+    {
+        return false;
+    }
+
+    success = fwrite(write_data, 1, write_length, handle) == write_length
+           && fflush(handle) == 0;
+
+#ifdef _WIN32
+    success = success && _commit(_fileno(handle)) == 0;
+#else
+    success = success && fsync(fileno(handle)) == 0;
+#endif
+
+    success = fclose(handle) == 0 && success;
+
+    if (!success)
+    {
+        M_remove(write_tempname);
+        return false;
+    }
+
+    return RenameOverFile();
+}
+
+// -----------------------------------------------------------------------------
+// WriteThread
+// -----------------------------------------------------------------------------
+
+static int SDLCALL WriteThread (void *data)
+{
+    write_success = WriteDurable();
+    SDL_AtomicSet(&write_finished, 1);
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// FinishWrite
+// Waits for the write thread and releases the job, reporting the result
+// if "report" is set.
+// -----------------------------------------------------------------------------
+
+static void FinishWrite (boolean report)
+{
+    writedone_t done = write_done;
+
+    if (write_thread)
+    {
+        SDL_WaitThread(write_thread, NULL);
+        write_thread = NULL;
+    }
+
+    write_done = NULL;
+
+    if (report && done)
+    {
+        done(write_filename, write_success, write_data, write_length);
+    }
+
+    free(write_data);
+    free(write_filename);
+    free(write_tempname);
+    write_data = NULL;
+    write_filename = NULL;
+    write_tempname = NULL;
+}
+
+// -----------------------------------------------------------------------------
+// ExitWait
+// Makes sure a write in flight is not cut off by quitting. The result
+// is not reported, the game is going away.
+// -----------------------------------------------------------------------------
+
+static void ExitWait (void)
+{
+    if (write_data)
+    {
+        FinishWrite(false);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_WriteFileAsync
+// -----------------------------------------------------------------------------
+
+void I_WriteFileAsync (const char *filename, const char *tempname,
+                       byte *data, size_t length, writedone_t done)
+{
+    // Both writes may use the same temporary file,
+    // so the previous one has to be finished first.
+    I_WaitFileWrites();
+
+    if (!exit_registered)
+    {
+        I_AtExit(ExitWait, true);
+        exit_registered = true;
+    }
+
+    write_filename = M_StringDuplicate(filename);
+    write_tempname = M_StringDuplicate(tempname);
+    write_data = data;
+    write_length = length;
+    write_done = done;
+    write_success = false;
+    SDL_AtomicSet(&write_finished, 0);
+
+    write_thread = SDL_CreateThread(WriteThread, "asyncio", NULL);
+
+    if (write_thread == NULL)
+    {
+        // No thread, write right here.
+        WriteThread(NULL);
+        FinishWrite(true);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_PollFileWrites
+// -----------------------------------------------------------------------------
+
+void I_PollFileWrites (void)
+{
+    if (write_data && SDL_AtomicGet(&write_finished))
+    {
+        FinishWrite(true);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_WaitFileWrites
+// -----------------------------------------------------------------------------
+
+void I_WaitFileWrites (void)
+{
+    if (write_data)
+    {
+        FinishWrite(true);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_FileWritePending
+// -----------------------------------------------------------------------------
+
+boolean I_FileWritePending (void)
+{
+    return write_data != NULL;
+}
@@ -0,0 +1,47 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Background file writing, used for savegames.
+//
+
+
+#ifndef __I_ASYNCIO__
+#define __I_ASYNCIO__
+
+#include <stddef.h>
+
+#include "doomtype.h"
+
+// Called on the game thread once a write has finished. "data" is
+// still valid during the call and is freed right after it.
+typedef void (*writedone_t) (const char *filename, boolean success,
+                             const byte *data, size_t length);
+
+// Writes "data" to "tempname", flushes it to disk and renames it to
+// "filename" on a background thread. Takes ownership of "data", which
+// must be allocated with malloc(). Only one write is in flight at a time,
+// a previous one is finished first.
+void I_WriteFileAsync (const char *filename, const char *tempname,
+                       byte *data, size_t length, writedone_t done);
+
+// Calls the "done" function of a finished write, if any.
+void I_PollFileWrites (void);
+
+// Blocks until the write in flight, if any, has finished.
+void I_WaitFileWrites (void);
+
+// True while a write is in flight.
+boolean I_FileWritePending (void);
+
+#endif
@@ -0,0 +1,201 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Per-phase frame profiler.
+//
+//      Every phase sums its time within the frame, I_PerfEndFrame then
+//      stores the sums into a rolling window of the last PERF_WINDOW
+//      frames, used by the rendering counters widget, and writes them
+//      as a CSV row to the -perflog file.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "i_perf.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "id_vars.h"
+#include "m_argv.h"
+#include "m_misc.h"
+
+
+#define PERF_WINDOW 256
+
+const char *perf_names[NUMPERFPHASES] = {
+    "BSP", "PLN", "MSK", "STB", "WDG", "BLT", "SLP"
+};
+
+static uint64_t perf_start[NUMPERFPHASES];
+static uint64_t perf_frame[NUMPERFPHASES];
+static int      perf_window[NUMPERFPHASES][PERF_WINDOW];
+static int      perf_frames;
+static uint64_t perf_lastframe;
+static FILE    *perf_log;
+
+
+// -----------------------------------------------------------------------------
+// ClosePerfLog
+// -----------------------------------------------------------------------------
+
+static void ClosePerfLog (void)
+{
+    if (perf_log)
+    {
+        fclose(perf_log);
+        perf_log = NULL;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_InitPerf
+// -----------------------------------------------------------------------------
+
+void I_InitPerf (void)
+{
+    int p;
+
+    //!
+    // @arg <file>
+    // @category video
+    //
+    // Write timings of every rendered frame, in microseconds,
+    // to the given file as CSV.
+    //
+
+    p = M_CheckParmWithArgs("-perflog", 1);
+
+    if (p)
+    {
+        int i;
+
+        perf_log = M_fopen(myargv[p + 1], "w");
+
+        if (!perf_log)
+        {
+            I_Error("I_InitPerf: Failed to open %s", myargv[p + 1]);
+        }
+
+        fprintf(perf_log, "frame");
+        for (i = 0; i < NUMPERFPHASES; i++)
+        {
+            fprintf(perf_log, ",%s", perf_names[i]);
+        }
+        fprintf(perf_log, ",total\n");
+
+        I_AtExit(ClosePerfLog, true);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_PerfActive
+// -----------------------------------------------------------------------------
+
+boolean I_PerfActive (void)
+{
+    return widget_render == 2 || perf_log != NULL;
+}
+
+// -----------------------------------------------------------------------------
+// I_PerfStart, I_PerfStop
+// -----------------------------------------------------------------------------
+
+void I_PerfStart (perfphase_t phase)
+{
+    if (I_PerfActive())
+    {
+        perf_start[phase] = I_GetTimeUS();
+    }
+}
+
+void I_PerfStop (perfphase_t phase)
+{
+    if (I_PerfActive() && perf_start[phase])
+    {
+        perf_frame[phase] += I_GetTimeUS() - perf_start[phase];
+        perf_start[phase] = 0;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_PerfEndFrame
+// -----------------------------------------------------------------------------
+
+void I_PerfEndFrame (void)
+{
+    const uint64_t now = I_GetTimeUS();
+    const int slot = perf_frames % PERF_WINDOW;
+    int i;
+
+    if (!I_PerfActive())
+    {
+        perf_lastframe = now;
+        return;
+    }
+
+    for (i = 0; i < NUMPERFPHASES; i++)
+    {
+        perf_window[i][slot] = (int) perf_frame[i];
+    }
+
+    if (perf_log)
+    {
+        fprintf(perf_log, "%d", perf_frames);
+        for (i = 0; i < NUMPERFPHASES; i++)
+        {
+            fprintf(perf_log, ",%d", (int) perf_frame[i]);
+        }
+        fprintf(perf_log, ",%d\n", perf_lastframe ? (int) (now - perf_lastframe) : 0);
+    }
+
+    memset(perf_frame, 0, sizeof(perf_frame));
+    perf_lastframe = now;
+    perf_frames++;
+}
+
+// -----------------------------------------------------------------------------
+// I_PerfGetStats
+// -----------------------------------------------------------------------------
+
+static int CompareTimes (const void *a, const void *b)
+{
+    return *(const int *) a - *(const int *) b;
+}
+
+void I_PerfGetStats (perfphase_t phase, perfstat_t *stat)
+{
+    const int count = perf_frames < PERF_WINDOW ? perf_frames : PERF_WINDOW;
+    int times[PERF_WINDOW];
+    int64_t sum = 0;
+    int i;
+
+    if (!count)
+    {
+        stat->min = stat->avg = stat->p99 = 0;
+        return;
+    }
+
+    memcpy(times, perf_window[phase], count * sizeof(*times));
+    qsort(times, count, sizeof(*times), CompareTimes);
+
+    for (i = 0; i < count; i++)
+    {
+        sum += times[i];
+    }
+
+    stat->min = times[0];
+    stat->avg = (int) (sum / count);
+    stat->p99 = times[(count * 99 - 1) / 100];
+}
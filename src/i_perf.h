@@ -0,0 +1,61 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Per-phase frame profiler.
+//
+
+
+#ifndef __I_PERF__
+#define __I_PERF__
+
+#include "doomtype.h"
+
+typedef enum
+{
+    PERF_BSP,       // R_RenderBSPNode
+    PERF_PLANES,    // R_DrawPlanes
+    PERF_MASKED,    // R_DrawMasked
+    PERF_STBAR,     // Status bar
+    PERF_WIDGETS,   // Widgets, crosshair and messages
+    PERF_BLIT,      // I_FinishUpdate blit and present
+    PERF_SLEEP,     // Frame limiter
+    NUMPERFPHASES
+} perfphase_t;
+
+// Timings of a phase over the last frames, in microseconds.
+typedef struct
+{
+    int min;
+    int avg;
+    int p99;
+} perfstat_t;
+
+extern const char *perf_names[NUMPERFPHASES];
+
+// Opens -perflog file, if given.
+void I_InitPerf (void);
+
+// True if timings are shown or logged, phases are not measured otherwise.
+boolean I_PerfActive (void);
+
+// Measures a phase, repeated measurements within a frame are summed.
+void I_PerfStart (perfphase_t phase);
+void I_PerfStop (perfphase_t phase);
+
+// Ends the frame: stores timings to the rolling window and the log.
+void I_PerfEndFrame (void);
+
+void I_PerfGetStats (perfphase_t phase, perfstat_t *stat);
+
+#endif
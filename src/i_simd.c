@@ -0,0 +1,880 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      SIMD pixel kernels for TrueColor drawers.
+//
+//      Scalar kernels are the reference. AVX2 kernels are processing
+//      8 pixels per iteration, texels, brightmap tests and colormap
+//      lookups are all done with gathers. Best available set is selected
+//      by I_InitSIMD at startup.
+//
+//      SSE2 has no gathers, so it is only used for the blending kernels
+//      (4 pixels per iteration), where per channel math is the most of
+//      the work. Plain copies are staying scalar without AVX2.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+#ifdef CRISPY_TRUECOLOR
+
+#include "i_simd.h"
+#include "i_system.h"
+#include "i_truecolor.h"
+#include "m_argv.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(HAVE_SSE2) && (defined(__GNUC__) || defined(_MSC_VER))
+#define HAVE_AVX2
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#endif
+
+#define TEXEL(s) (brightmap[s] ? colormap1[s] : colormap0[s])
+
+
+// -----------------------------------------------------------------------------
+// Scalar kernels.
+// -----------------------------------------------------------------------------
+
+static void DrawSpanPixels_Scalar (pixel_t *dest, int count,
+                                   fixed_t *xfrac, fixed_t *yfrac,
+                                   fixed_t xstep, fixed_t ystep,
+                                   const byte *source, const byte *brightmap,
+                                   const pixel_t *colormap0,
+                                   const pixel_t *colormap1)
+{
+    fixed_t xf = *xfrac;
+    fixed_t yf = *yfrac;
+
+    for ( ; count > 0 ; count--)
+    {
+        const unsigned int ytemp = (yf >> 10) & 0x0fc0;
+        const unsigned int xtemp = (xf >> 16) & 0x3f;
+        const byte s = source[xtemp | ytemp];
+
+        *dest++ = TEXEL(s);
+        xf += xstep;
+        yf += ystep;
+    }
+
+    *xfrac = xf;
+    *yfrac = yf;
+}
+
+static void DrawColumnPixels_Scalar (pixel_t *dest, int pitch, int count,
+                                     fixed_t frac, fixed_t fracstep,
+                                     const byte *source, int heightmask,
+                                     const byte *brightmap,
+                                     const pixel_t *colormap0,
+                                     const pixel_t *colormap1)
+{
+    for ( ; count > 0 ; count--)
+    {
+        const unsigned s = source[(frac >> FRACBITS) & heightmask];
+
+        *dest = TEXEL(s);
+        dest += pitch;
+        frac += fracstep;
+    }
+}
+
+static void DrawSpanPixelsPlain_Scalar (pixel_t *dest, int count,
+                                        fixed_t *xfrac, fixed_t *yfrac,
+                                        fixed_t xstep, fixed_t ystep,
+                                        const byte *source,
+                                        const pixel_t *colormap)
+{
+    fixed_t xf = *xfrac;
+    fixed_t yf = *yfrac;
+
+    for ( ; count > 0 ; count--)
+    {
+        const unsigned int ytemp = (yf >> 10) & 0x0fc0;
+        const unsigned int xtemp = (xf >> 16) & 0x3f;
+
+        *dest++ = colormap[source[xtemp | ytemp]];
+        xf += xstep;
+        yf += ystep;
+    }
+
+    *xfrac = xf;
+    *yfrac = yf;
+}
+
+static void DrawColumnPixelsPlain_Scalar (pixel_t *dest, int pitch, int count,
+                                          fixed_t frac, fixed_t fracstep,
+                                          const byte *source, int heightmask,
+                                          const pixel_t *colormap)
+{
+    for ( ; count > 0 ; count--)
+    {
+        *dest = colormap[source[(frac >> FRACBITS) & heightmask]];
+        dest += pitch;
+        frac += fracstep;
+    }
+}
+
+static void DrawTLColumnPixels_Scalar (pixel_t *dest, int pitch, int count,
+                                       fixed_t frac, fixed_t fracstep,
+                                       const byte *source, int heightmask,
+                                       const byte *brightmap,
+                                       const pixel_t *colormap0,
+                                       const pixel_t *colormap1,
+                                       int alpha)
+{
+    for ( ; count > 0 ; count--)
+    {
+        const unsigned s = source[(frac >> FRACBITS) & heightmask];
+        const pixel_t destrgb = TEXEL(s);
+
+        *dest = I_BlendOver(*dest, destrgb, alpha);
+        dest += pitch;
+        frac += fracstep;
+    }
+}
+
+static void DrawTLAddColumnPixels_Scalar (pixel_t *dest, int pitch, int count,
+                                          fixed_t frac, fixed_t fracstep,
+                                          const byte *source, int heightmask,
+                                          const byte *brightmap,
+                                          const pixel_t *colormap0,
+                                          const pixel_t *colormap1)
+{
+    for ( ; count > 0 ; count--)
+    {
+        const unsigned s = source[(frac >> FRACBITS) & heightmask];
+        const pixel_t destrgb = TEXEL(s);
+
+        *dest = I_BlendAdd(*dest, destrgb);
+        dest += pitch;
+        frac += fracstep;
+    }
+}
+
+static void DrawFuzzPixels_Scalar (pixel_t *dest, int pitch, int count,
+                                   const int *offsets, int alpha)
+{
+    for (int i = 0 ; i < count ; i++)
+    {
+        *dest = I_BlendDark(dest[offsets[i]], alpha);
+        dest += pitch;
+    }
+}
+
+#ifdef HAVE_SSE2
+
+// -----------------------------------------------------------------------------
+// SSE2 kernels.
+// -----------------------------------------------------------------------------
+
+// Steps of lanes 0..3, computed unsigned to wrap around like the
+// scalar "frac += fracstep" does.
+static inline __m128i Steps4 (fixed_t start, fixed_t step)
+{
+    const unsigned int s = (unsigned int) step;
+
+    return _mm_add_epi32(_mm_set1_epi32(start),
+                         _mm_set_epi32((int)(s * 3), (int)(s * 2), (int) s, 0));
+}
+
+// Per channel ((fg * alpha + bg * (255 - alpha)) >> 8), as I_BlendOver does.
+// Both products and their sum are fitting into unsigned 16 bits.
+static inline __m128i BlendOver4 (__m128i bg, __m128i fg,
+                                  __m128i fga, __m128i bga)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_srli_epi16(_mm_add_epi16(
+                        _mm_mullo_epi16(_mm_unpacklo_epi8(fg, zero), fga),
+                        _mm_mullo_epi16(_mm_unpacklo_epi8(bg, zero), bga)), 8);
+    const __m128i hi = _mm_srli_epi16(_mm_add_epi16(
+                        _mm_mullo_epi16(_mm_unpackhi_epi8(fg, zero), fga),
+                        _mm_mullo_epi16(_mm_unpackhi_epi8(bg, zero), bga)), 8);
+
+    return _mm_or_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32((int)0xFF000000));
+}
+
+// Per channel ((bg * alpha) >> 8), as I_BlendDark does.
+static inline __m128i BlendDark4 (__m128i bg, __m128i alpha)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(bg, zero), alpha), 8);
+    const __m128i hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(bg, zero), alpha), 8);
+
+    return _mm_or_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32((int)0xFF000000));
+}
+
+// Additive LUT is a saturated sum of two channels, see I_InitTCTransMaps.
+static inline __m128i BlendAdd4 (__m128i bg, __m128i fg)
+{
+    return _mm_or_si128(_mm_adds_epu8(bg, fg), _mm_set1_epi32((int)0xFF000000));
+}
+
+// Texels of four column pixels.
+static inline __m128i ColumnTexels4 (__m128i fracs, __m128i mask,
+                                     const byte *source, const byte *brightmap,
+                                     const pixel_t *colormap0,
+                                     const pixel_t *colormap1)
+{
+    int idx[4];
+    pixel_t px[4];
+
+    _mm_storeu_si128((__m128i *) idx, _mm_and_si128(_mm_srai_epi32(fracs, FRACBITS), mask));
+
+    for (int j = 0 ; j < 4 ; j++)
+    {
+        const unsigned s = source[idx[j]];
+        px[j] = TEXEL(s);
+    }
+
+    return _mm_loadu_si128((const __m128i *) px);
+}
+
+static inline __m128i LoadColumn4 (const pixel_t *dest, int pitch)
+{
+    return _mm_set_epi32((int) dest[pitch * 3], (int) dest[pitch * 2],
+                         (int) dest[pitch], (int) dest[0]);
+}
+
+static inline void StoreColumn4 (pixel_t *dest, int pitch, __m128i v)
+{
+    pixel_t px[4];
+
+    _mm_storeu_si128((__m128i *) px, v);
+    dest[0] = px[0];
+    dest[pitch] = px[1];
+    dest[pitch * 2] = px[2];
+    dest[pitch * 3] = px[3];
+}
+
+static void DrawTLColumnPixels_SSE2 (pixel_t *dest, int pitch, int count,
+                                     fixed_t frac, fixed_t fracstep,
+                                     const byte *source, int heightmask,
+                                     const byte *brightmap,
+                                     const pixel_t *colormap0,
+                                     const pixel_t *colormap1,
+                                     int alpha)
+{
+    const __m128i step4 = _mm_set1_epi32((int)((unsigned int) fracstep * 4));
+    const __m128i mask = _mm_set1_epi32(heightmask);
+    const __m128i fga = _mm_set1_epi16((short) alpha);
+    const __m128i bga = _mm_set1_epi16((short)(0xFF - alpha));
+    __m128i fracs = Steps4(frac, fracstep);
+
+    for ( ; count >= 4 ; count -= 4)
+    {
+        const __m128i fg = ColumnTexels4(fracs, mask, source, brightmap,
+                                         colormap0, colormap1);
+
+        StoreColumn4(dest, pitch, BlendOver4(LoadColumn4(dest, pitch), fg, fga, bga));
+        fracs = _mm_add_epi32(fracs, step4);
+        dest += pitch * 4;
+    }
+
+    DrawTLColumnPixels_Scalar(dest, pitch, count, _mm_cvtsi128_si32(fracs), fracstep,
+                              source, heightmask, brightmap, colormap0, colormap1,
+                              alpha);
+}
+
+static void DrawTLAddColumnPixels_SSE2 (pixel_t *dest, int pitch, int count,
+                                        fixed_t frac, fixed_t fracstep,
+                                        const byte *source, int heightmask,
+                                        const byte *brightmap,
+                                        const pixel_t *colormap0,
+                                        const pixel_t *colormap1)
+{
+    const __m128i step4 = _mm_set1_epi32((int)((unsigned int) fracstep * 4));
+    const __m128i mask = _mm_set1_epi32(heightmask);
+    __m128i fracs = Steps4(frac, fracstep);
+
+    for ( ; count >= 4 ; count -= 4)
+    {
+        const __m128i fg = ColumnTexels4(fracs, mask, source, brightmap,
+                                         colormap0, colormap1);
+
+        StoreColumn4(dest, pitch, BlendAdd4(LoadColumn4(dest, pitch), fg));
+        fracs = _mm_add_epi32(fracs, step4);
+        dest += pitch * 4;
+    }
+
+    DrawTLAddColumnPixels_Scalar(dest, pitch, count, _mm_cvtsi128_si32(fracs), fracstep,
+                                 source, heightmask, brightmap, colormap0, colormap1);
+}
+
+// Fuzz pixel may read the pixel right above, which is written by the
+// previous step. Such four pixels are done one by one to keep the result.
+static void DrawFuzzPixels_SSE2 (pixel_t *dest, int pitch, int count,
+                                 const int *offsets, int alpha)
+{
+    const __m128i alpha16 = _mm_set1_epi16((short) alpha);
+    int i = 0;
+
+    for ( ; i + 4 <= count ; i += 4)
+    {
+        if (offsets[i+1] < 0 || offsets[i+2] < 0 || offsets[i+3] < 0)
+        {
+            DrawFuzzPixels_Scalar(dest, pitch, 4, offsets + i, alpha);
+        }
+        else
+        {
+            const __m128i bg = _mm_set_epi32((int) dest[pitch * 3 + offsets[i+3]],
+                                             (int) dest[pitch * 2 + offsets[i+2]],
+                                             (int) dest[pitch + offsets[i+1]],
+                                             (int) dest[offsets[i]]);
+
+            StoreColumn4(dest, pitch, BlendDark4(bg, alpha16));
+        }
+        dest += pitch * 4;
+    }
+
+    DrawFuzzPixels_Scalar(dest, pitch, count - i, offsets + i, alpha);
+}
+
+#endif
+
+#ifdef HAVE_AVX2
+
+// -----------------------------------------------------------------------------
+// AVX2 kernels.
+// -----------------------------------------------------------------------------
+
+TARGET_AVX2
+static inline __m256i Steps8 (fixed_t start, fixed_t step)
+{
+    const unsigned int s = (unsigned int) step;
+
+    return _mm256_add_epi32(_mm256_set1_epi32(start),
+                            _mm256_set_epi32((int)(s * 7), (int)(s * 6),
+                                             (int)(s * 5), (int)(s * 4),
+                                             (int)(s * 3), (int)(s * 2),
+                                             (int) s, 0));
+}
+
+// Gathers eight bytes at base[idx]. Bytes are read as aligned dwords,
+// which never cross a page boundary, so the read can't fault even when
+// a byte is the last one of its array.
+TARGET_AVX2
+static inline __m256i GatherBytes8 (const byte *base, __m256i idx)
+{
+    const int *words = (const int *)((uintptr_t) base & ~(uintptr_t) 3);
+    const __m256i pos = _mm256_add_epi32(idx, _mm256_set1_epi32((int)((uintptr_t) base & 3)));
+    const __m256i w = _mm256_i32gather_epi32(words, _mm256_srai_epi32(pos, 2), 4);
+    const __m256i shift = _mm256_slli_epi32(_mm256_and_si256(pos, _mm256_set1_epi32(3)), 3);
+
+    return _mm256_and_si256(_mm256_srlv_epi32(w, shift), _mm256_set1_epi32(0xFF));
+}
+
+// Gathers eight colormap entries by texel indexes.
+TARGET_AVX2
+static inline __m256i GatherTexels8 (__m256i idx, const byte *source,
+                                     const byte *brightmap,
+                                     const pixel_t *colormap0,
+                                     const pixel_t *colormap1)
+{
+    const __m256i sv = GatherBytes8(source, idx);
+    const __m256i dark = _mm256_cmpeq_epi32(GatherBytes8(brightmap, sv),
+                                            _mm256_setzero_si256());
+    const __m256i c0 = _mm256_i32gather_epi32((const int *) colormap0, sv, 4);
+    const __m256i c1 = _mm256_i32gather_epi32((const int *) colormap1, sv, 4);
+
+    return _mm256_blendv_epi8(c1, c0, dark);
+}
+
+TARGET_AVX2
+static inline __m256i ColumnTexels8 (__m256i fracs, __m256i mask,
+                                     const byte *source, const byte *brightmap,
+                                     const pixel_t *colormap0,
+                                     const pixel_t *colormap1)
+{
+    return GatherTexels8(_mm256_and_si256(_mm256_srai_epi32(fracs, FRACBITS), mask),
+                         source, brightmap, colormap0, colormap1);
+}
+
+TARGET_AVX2
+static inline __m256i LoadColumn8 (const pixel_t *dest, int pitch)
+{
+    const __m256i rows = _mm256_mullo_epi32(_mm256_set1_epi32(pitch),
+                                            _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+
+    return _mm256_i32gather_epi32((const int *) dest, rows, 4);
+}
+
+TARGET_AVX2
+static inline void StoreColumn8 (pixel_t *dest, int pitch, __m256i v)
+{
+    pixel_t px[8];
+
+    _mm256_storeu_si256((__m256i *) px, v);
+
+    for (int j = 0 ; j < 8 ; j++)
+    {
+        dest[pitch * j] = px[j];
+    }
+}
+
+TARGET_AVX2
+static void DrawSpanPixels_AVX2 (pixel_t *dest, int count,
+                                 fixed_t *xfrac, fixed_t *yfrac,
+                                 fixed_t xstep, fixed_t ystep,
+                                 const byte *source, const byte *brightmap,
+                                 const pixel_t *colormap0,
+                                 const pixel_t *colormap1)
+{
+    const __m256i xstep8 = _mm256_set1_epi32((int)((unsigned int) xstep * 8));
+    const __m256i ystep8 = _mm256_set1_epi32((int)((unsigned int) ystep * 8));
+    const __m256i xmask = _mm256_set1_epi32(0x3f);
+    const __m256i ymask = _mm256_set1_epi32(0x0fc0);
+    __m256i xv = Steps8(*xfrac, xstep);
+    __m256i yv = Steps8(*yfrac, ystep);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+        const __m256i spot = _mm256_or_si256(_mm256_and_si256(_mm256_srai_epi32(xv, 16), xmask),
+                                             _mm256_and_si256(_mm256_srai_epi32(yv, 10), ymask));
+
+        _mm256_storeu_si256((__m256i *) dest,
+                            GatherTexels8(spot, source, brightmap, colormap0, colormap1));
+
+        xv = _mm256_add_epi32(xv, xstep8);
+        yv = _mm256_add_epi32(yv, ystep8);
+        dest += 8;
+    }
+
+    *xfrac = _mm_cvtsi128_si32(_mm256_castsi256_si128(xv));
+    *yfrac = _mm_cvtsi128_si32(_mm256_castsi256_si128(yv));
+
+    DrawSpanPixels_Scalar(dest, count, xfrac, yfrac, xstep, ystep,
+                        source, brightmap, colormap0, colormap1);
+}
+
+TARGET_AVX2
+static void DrawColumnPixels_AVX2 (pixel_t *dest, int pitch, int count,
+                                   fixed_t frac, fixed_t fracstep,
+                                   const byte *source, int heightmask,
+                                   const byte *brightmap,
+                                   const pixel_t *colormap0,
+                                   const pixel_t *colormap1)
+{
+    const __m256i step8 = _mm256_set1_epi32((int)((unsigned int) fracstep * 8));
+    const __m256i mask = _mm256_set1_epi32(heightmask);
+    __m256i fracs = Steps8(frac, fracstep);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+        StoreColumn8(dest, pitch, ColumnTexels8(fracs, mask, source, brightmap,
+                                                colormap0, colormap1));
+        fracs = _mm256_add_epi32(fracs, step8);
+        dest += pitch * 8;
+    }
+
+    DrawColumnPixels_Scalar(dest, pitch, count, _mm_cvtsi128_si32(_mm256_castsi256_si128(fracs)),
+                          fracstep, source, heightmask, brightmap, colormap0, colormap1);
+}
+
+// Gathers eight colormap entries by texel indexes, without brightmap.
+TARGET_AVX2
+static inline __m256i GatherPlainTexels8 (__m256i idx, const byte *source,
+                                          const pixel_t *colormap)
+{
+    return _mm256_i32gather_epi32((const int *) colormap, GatherBytes8(source, idx), 4);
+}
+
+TARGET_AVX2
+static void DrawSpanPixelsPlain_AVX2 (pixel_t *dest, int count,
+                                      fixed_t *xfrac, fixed_t *yfrac,
+                                      fixed_t xstep, fixed_t ystep,
+                                      const byte *source,
+                                      const pixel_t *colormap)
+{
+    const __m256i xstep8 = _mm256_set1_epi32((int)((unsigned int) xstep * 8));
+    const __m256i ystep8 = _mm256_set1_epi32((int)((unsigned int) ystep * 8));
+    const __m256i xmask = _mm256_set1_epi32(0x3f);
+    const __m256i ymask = _mm256_set1_epi32(0x0fc0);
+    __m256i xv = Steps8(*xfrac, xstep);
+    __m256i yv = Steps8(*yfrac, ystep);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+        const __m256i spot = _mm256_or_si256(_mm256_and_si256(_mm256_srai_epi32(xv, 16), xmask),
+                                             _mm256_and_si256(_mm256_srai_epi32(yv, 10), ymask));
+
+        _mm256_storeu_si256((__m256i *) dest, GatherPlainTexels8(spot, source, colormap));
+
+        xv = _mm256_add_epi32(xv, xstep8);
+        yv = _mm256_add_epi32(yv, ystep8);
+        dest += 8;
+    }
+
+    *xfrac = _mm_cvtsi128_si32(_mm256_castsi256_si128(xv));
+    *yfrac = _mm_cvtsi128_si32(_mm256_castsi256_si128(yv));
+
+    DrawSpanPixelsPlain_Scalar(dest, count, xfrac, yfrac, xstep, ystep,
+                             source, colormap);
+}
+
+TARGET_AVX2
+static void DrawColumnPixelsPlain_AVX2 (pixel_t *dest, int pitch, int count,
+                                        fixed_t frac, fixed_t fracstep,
+                                        const byte *source, int heightmask,
+                                        const pixel_t *colormap)
+{
+    const __m256i step8 = _mm256_set1_epi32((int)((unsigned int) fracstep * 8));
+    const __m256i mask = _mm256_set1_epi32(heightmask);
+    __m256i fracs = Steps8(frac, fracstep);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+        const __m256i idx = _mm256_and_si256(_mm256_srai_epi32(fracs, FRACBITS), mask);
+
+        StoreColumn8(dest, pitch, GatherPlainTexels8(idx, source, colormap));
+        fracs = _mm256_add_epi32(fracs, step8);
+        dest += pitch * 8;
+    }
+
+    DrawColumnPixelsPlain_Scalar(dest, pitch, count, _mm_cvtsi128_si32(_mm256_castsi256_si128(fracs)),
+                               fracstep, source, heightmask, colormap);
+}
+
+TARGET_AVX2
+static void DrawTLColumnPixels_AVX2 (pixel_t *dest, int pitch, int count,
+                                     fixed_t frac, fixed_t fracstep,
+                                     const byte *source, int heightmask,
+                                     const byte *brightmap,
+                                     const pixel_t *colormap0,
+                                     const pixel_t *colormap1,
+                                     int alpha)
+{
+    const __m256i step8 = _mm256_set1_epi32((int)((unsigned int) fracstep * 8));
+    const __m256i mask = _mm256_set1_epi32(heightmask);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i fga = _mm256_set1_epi16((short) alpha);
+    const __m256i bga = _mm256_set1_epi16((short)(0xFF - alpha));
+    const __m256i opaque = _mm256_set1_epi32((int)0xFF000000);
+    __m256i fracs = Steps8(frac, fracstep);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+        const __m256i fg = ColumnTexels8(fracs, mask, source, brightmap,
+                                         colormap0, colormap1);
+        const __m256i bg = LoadColumn8(dest, pitch);
+        const __m256i lo = _mm256_srli_epi16(_mm256_add_epi16(
+                            _mm256_mullo_epi16(_mm256_unpacklo_epi8(fg, zero), fga),
+                            _mm256_mullo_epi16(_mm256_unpacklo_epi8(bg, zero), bga)), 8);
+        const __m256i hi = _mm256_srli_epi16(_mm256_add_epi16(
+                            _mm256_mullo_epi16(_mm256_unpackhi_epi8(fg, zero), fga),
+                            _mm256_mullo_epi16(_mm256_unpackhi_epi8(bg, zero), bga)), 8);
+
+        // Unpack and pack are both working within 128-bit lanes,
+        // so pixels are coming back in their original order.
+        StoreColumn8(dest, pitch, _mm256_or_si256(_mm256_packus_epi16(lo, hi), opaque));
+        fracs = _mm256_add_epi32(fracs, step8);
+        dest += pitch * 8;
+    }
+
+    DrawTLColumnPixels_SSE2(dest, pitch, count, _mm_cvtsi128_si32(_mm256_castsi256_si128(fracs)),
+                            fracstep, source, heightmask, brightmap, colormap0, colormap1,
+                            alpha);
+}
+
+TARGET_AVX2
+static void DrawTLAddColumnPixels_AVX2 (pixel_t *dest, int pitch, int count,
+                                        fixed_t frac, fixed_t fracstep,
+                                        const byte *source, int heightmask,
+                                        const byte *brightmap,
+                                        const pixel_t *colormap0,
+                                        const pixel_t *colormap1)
+{
+    const __m256i step8 = _mm256_set1_epi32((int)((unsigned int) fracstep * 8));
+    const __m256i mask = _mm256_set1_epi32(heightmask);
+    const __m256i opaque = _mm256_set1_epi32((int)0xFF000000);
+    __m256i fracs = Steps8(frac, fracstep);
+
+    for ( ; count >= 8 ; count -= 8)
+    {
+        const __m256i fg = ColumnTexels8(fracs, mask, source, brightmap,
+                                         colormap0, colormap1);
+
+        StoreColumn8(dest, pitch, _mm256_or_si256(_mm256_adds_epu8(LoadColumn8(dest, pitch), fg),
+                                                  opaque));
+        fracs = _mm256_add_epi32(fracs, step8);
+        dest += pitch * 8;
+    }
+
+    DrawTLAddColumnPixels_SSE2(dest, pitch, count, _mm_cvtsi128_si32(_mm256_castsi256_si128(fracs)),
+                               fracstep, source, heightmask, brightmap, colormap0, colormap1);
+}
+
+// -----------------------------------------------------------------------------
+// CPUHasAVX2
+// -----------------------------------------------------------------------------
+
+static boolean CPUHasAVX2 (void)
+{
+#ifdef _MSC_VER
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    // AVX and OSXSAVE, then YMM state enabled by the OS.
+    __cpuid(info, 1);
+    if ((info[2] & 0x18000000) != 0x18000000 || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif
+
+
+void (*I_DrawSpanPixels) (pixel_t *dest, int count,
+                          fixed_t *xfrac, fixed_t *yfrac,
+                          fixed_t xstep, fixed_t ystep,
+                          const byte *source, const byte *brightmap,
+                          const pixel_t *colormap0,
+                          const pixel_t *colormap1) = DrawSpanPixels_Scalar;
+
+void (*I_DrawColumnPixels) (pixel_t *dest, int pitch, int count,
+                            fixed_t frac, fixed_t fracstep,
+                            const byte *source, int heightmask,
+                            const byte *brightmap,
+                            const pixel_t *colormap0,
+                            const pixel_t *colormap1) = DrawColumnPixels_Scalar;
+
+void (*I_DrawSpanPixelsPlain) (pixel_t *dest, int count,
+                               fixed_t *xfrac, fixed_t *yfrac,
+                               fixed_t xstep, fixed_t ystep,
+                               const byte *source,
+                               const pixel_t *colormap) = DrawSpanPixelsPlain_Scalar;
+
+void (*I_DrawColumnPixelsPlain) (pixel_t *dest, int pitch, int count,
+                                 fixed_t frac, fixed_t fracstep,
+                                 const byte *source, int heightmask,
+                                 const pixel_t *colormap) = DrawColumnPixelsPlain_Scalar;
+
+void (*I_DrawTLColumnPixels) (pixel_t *dest, int pitch, int count,
+                              fixed_t frac, fixed_t fracstep,
+                              const byte *source, int heightmask,
+                              const byte *brightmap,
+                              const pixel_t *colormap0,
+                              const pixel_t *colormap1,
+                              int alpha) = DrawTLColumnPixels_Scalar;
+
+void (*I_DrawTLAddColumnPixels) (pixel_t *dest, int pitch, int count,
+                                 fixed_t frac, fixed_t fracstep,
+                                 const byte *source, int heightmask,
+                                 const byte *brightmap,
+                                 const pixel_t *colormap0,
+                                 const pixel_t *colormap1) = DrawTLAddColumnPixels_Scalar;
+
+void (*I_DrawFuzzPixels) (pixel_t *dest, int pitch, int count,
+                          const int *offsets, int alpha) = DrawFuzzPixels_Scalar;
+
+
+// -----------------------------------------------------------------------------
+// CheckKernels
+//  Compares selected kernels against the scalar ones with random input.
+// -----------------------------------------------------------------------------
+
+#define CHECK_PITCH  16
+#define CHECK_ROWS   64
+#define CHECK_PASSES 256
+
+static unsigned int check_seed = 1;
+
+static unsigned int CheckRandom (void)
+{
+    check_seed = check_seed * 1103515245 + 12345;
+    return check_seed >> 8;
+}
+
+static void CheckKernels (void)
+{
+    static byte    source[4096], brightmap[256], nobrightmap[256];
+    static pixel_t colormap0[256], colormap1[256];
+    static pixel_t screen[2][CHECK_PITCH * CHECK_ROWS];
+    static int     offsets[CHECK_ROWS];
+
+    // Scalar additive blending needs its LUT.
+    I_InitTCTransMaps();
+
+    for (int pass = 0 ; pass < CHECK_PASSES ; pass++)
+    {
+        const int count = 1 + CheckRandom() % (CHECK_ROWS - 2);
+        const int alpha = CheckRandom() & 0xFF;
+        const int heightmask = (pass & 1) ? -1 : 127;
+        const fixed_t frac = (fixed_t)(CheckRandom() % (64 << FRACBITS));
+        const fixed_t fracstep = (fixed_t)(CheckRandom() % (4 << FRACBITS));
+        const fixed_t xstep = (fixed_t)(CheckRandom() << 4) - (1 << 27);
+        const fixed_t ystep = (fixed_t)(CheckRandom() << 4) - (1 << 27);
+        fixed_t xfrac[2], yfrac[2];
+        pixel_t *dest[2];
+
+        for (int i = 0 ; i < 4096 ; i++)
+        {
+            source[i] = CheckRandom() & 0xFF;
+        }
+        for (int i = 0 ; i < 256 ; i++)
+        {
+            brightmap[i] = (CheckRandom() & 3) == 0;
+            colormap0[i] = CheckRandom() | (CheckRandom() << 24);
+            colormap1[i] = CheckRandom() | (CheckRandom() << 24);
+        }
+        for (int i = 0 ; i < CHECK_PITCH * CHECK_ROWS ; i++)
+        {
+            screen[0][i] = screen[1][i] = CheckRandom() | (CheckRandom() << 24);
+        }
+        for (int i = 0 ; i < count ; i++)
+        {
+            offsets[i] = (CheckRandom() & 1) ? CHECK_PITCH : -CHECK_PITCH;
+        }
+
+        // Keep a spare row above and below for the fuzz offsets.
+        dest[0] = &screen[0][CHECK_PITCH + 1];
+        dest[1] = &screen[1][CHECK_PITCH + 1];
+        xfrac[0] = xfrac[1] = (fixed_t) CheckRandom();
+        yfrac[0] = yfrac[1] = (fixed_t) CheckRandom();
+
+        switch (pass % 7)
+        {
+            case 0:
+                DrawSpanPixels_Scalar(dest[0], count, &xfrac[0], &yfrac[0], xstep, ystep,
+                                      source, brightmap, colormap0, colormap1);
+                I_DrawSpanPixels(dest[1], count, &xfrac[1], &yfrac[1], xstep, ystep,
+                                 source, brightmap, colormap0, colormap1);
+                break;
+            case 1:
+                DrawColumnPixels_Scalar(dest[0], CHECK_PITCH, count, frac, fracstep,
+                                        source, heightmask, brightmap, colormap0, colormap1);
+                I_DrawColumnPixels(dest[1], CHECK_PITCH, count, frac, fracstep,
+                                   source, heightmask, brightmap, colormap0, colormap1);
+                break;
+            case 2:
+                DrawTLColumnPixels_Scalar(dest[0], CHECK_PITCH, count, frac, fracstep,
+                                          source, heightmask, brightmap, colormap0, colormap1,
+                                          alpha);
+                I_DrawTLColumnPixels(dest[1], CHECK_PITCH, count, frac, fracstep,
+                                     source, heightmask, brightmap, colormap0, colormap1,
+                                     alpha);
+                break;
+            case 3:
+                DrawTLAddColumnPixels_Scalar(dest[0], CHECK_PITCH, count, frac, fracstep,
+                                             source, heightmask, brightmap, colormap0, colormap1);
+                I_DrawTLAddColumnPixels(dest[1], CHECK_PITCH, count, frac, fracstep,
+                                        source, heightmask, brightmap, colormap0, colormap1);
+                break;
+            case 4:
+                DrawFuzzPixels_Scalar(dest[0], CHECK_PITCH, count, offsets, alpha);
+                I_DrawFuzzPixels(dest[1], CHECK_PITCH, count, offsets, alpha);
+                break;
+            case 5:
+                DrawSpanPixels_Scalar(dest[0], count, &xfrac[0], &yfrac[0], xstep, ystep,
+                                      source, nobrightmap, colormap0, colormap1);
+                I_DrawSpanPixelsPlain(dest[1], count, &xfrac[1], &yfrac[1], xstep, ystep,
+                                      source, colormap0);
+                break;
+            case 6:
+                DrawColumnPixels_Scalar(dest[0], CHECK_PITCH, count, frac, fracstep,
+                                        source, heightmask, nobrightmap, colormap0, colormap1);
+                I_DrawColumnPixelsPlain(dest[1], CHECK_PITCH, count, frac, fracstep,
+                                        source, heightmask, colormap0);
+                break;
+        }
+
+        if (memcmp(screen[0], screen[1], sizeof(screen[0]))
+        ||  xfrac[0] != xfrac[1] || yfrac[0] != yfrac[1])
+        {
+            I_Error("I_InitSIMD: kernel %d differs from scalar one", pass % 7);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_InitSIMD
+// -----------------------------------------------------------------------------
+
+void I_InitSIMD (void)
+{
+    const char *name = "scalar";
+
+    //!
+    // @category video
+    //
+    // Don't use SIMD kernels for TrueColor drawing.
+    //
+
+    if (!M_CheckParm("-nosimd"))
+    {
+#ifdef HAVE_SSE2
+        I_DrawTLColumnPixels = DrawTLColumnPixels_SSE2;
+        I_DrawTLAddColumnPixels = DrawTLAddColumnPixels_SSE2;
+        I_DrawFuzzPixels = DrawFuzzPixels_SSE2;
+        name = "SSE2";
+#endif
+#ifdef HAVE_AVX2
+        // Fuzz reads are depending on previous writes too often
+        // for eight pixels at once, so it stays with SSE2.
+        if (CPUHasAVX2())
+        {
+            I_DrawSpanPixels = DrawSpanPixels_AVX2;
+            I_DrawColumnPixels = DrawColumnPixels_AVX2;
+            I_DrawSpanPixelsPlain = DrawSpanPixelsPlain_AVX2;
+            I_DrawColumnPixelsPlain = DrawColumnPixelsPlain_AVX2;
+            I_DrawTLColumnPixels = DrawTLColumnPixels_AVX2;
+            I_DrawTLAddColumnPixels = DrawTLAddColumnPixels_AVX2;
+            name = "AVX2";
+        }
+#endif
+    }
+
+    printf("I_InitSIMD: Using %s drawing kernels.\n", name);
+
+    //!
+    // @category video
+    //
+    // Compare SIMD drawing kernels against scalar ones at startup
+    // and quit with an error if any of them differs.
+    //
+
+    if (M_CheckParm("-simdcheck"))
+    {
+        CheckKernels();
+        printf("I_InitSIMD: %s kernels are matching scalar ones.\n", name);
+    }
+}
+
+#endif
@@ -0,0 +1,93 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      SIMD pixel kernels for TrueColor drawers.
+//
+
+
+#ifndef __I_SIMD__
+#define __I_SIMD__
+
+#include "config.h"
+
+#ifdef CRISPY_TRUECOLOR
+
+#include "doomtype.h"
+#include "m_fixed.h"
+
+// [JN] All kernels are producing exactly the same pixels as the scalar
+// drawers. Source texel of every pixel is a brightmap/colormap lookup:
+//  brightmap[s] ? colormap1[s] : colormap0[s]
+
+// Flat span, "count" pixels going to the right from "dest".
+// *xfrac and *yfrac are advanced past the last pixel.
+extern void (*I_DrawSpanPixels) (pixel_t *dest, int count,
+                                 fixed_t *xfrac, fixed_t *yfrac,
+                                 fixed_t xstep, fixed_t ystep,
+                                 const byte *source, const byte *brightmap,
+                                 const pixel_t *colormap0,
+                                 const pixel_t *colormap1);
+
+// Column, "count" pixels going down from "dest" by "pitch".
+// Texel is source[(frac >> FRACBITS) & heightmask], use heightmask
+// of -1 for textures that don't need wrapping.
+extern void (*I_DrawColumnPixels) (pixel_t *dest, int pitch, int count,
+                                   fixed_t frac, fixed_t fracstep,
+                                   const byte *source, int heightmask,
+                                   const byte *brightmap,
+                                   const pixel_t *colormap0,
+                                   const pixel_t *colormap1);
+
+// Same as above, blended over the screen with I_BlendOver.
+extern void (*I_DrawTLColumnPixels) (pixel_t *dest, int pitch, int count,
+                                     fixed_t frac, fixed_t fracstep,
+                                     const byte *source, int heightmask,
+                                     const byte *brightmap,
+                                     const pixel_t *colormap0,
+                                     const pixel_t *colormap1,
+                                     int alpha);
+
+// Same as above, blended over the screen with I_BlendAdd.
+extern void (*I_DrawTLAddColumnPixels) (pixel_t *dest, int pitch, int count,
+                                        fixed_t frac, fixed_t fracstep,
+                                        const byte *source, int heightmask,
+                                        const byte *brightmap,
+                                        const pixel_t *colormap0,
+                                        const pixel_t *colormap1);
+
+// Same as I_DrawSpanPixels and I_DrawColumnPixels, for sources without
+// brightmap or with both colormaps being the same. Texel is colormap[s],
+// there is no per pixel brightmap test.
+extern void (*I_DrawSpanPixelsPlain) (pixel_t *dest, int count,
+                                      fixed_t *xfrac, fixed_t *yfrac,
+                                      fixed_t xstep, fixed_t ystep,
+                                      const byte *source,
+                                      const pixel_t *colormap);
+
+extern void (*I_DrawColumnPixelsPlain) (pixel_t *dest, int pitch, int count,
+                                        fixed_t frac, fixed_t fracstep,
+                                        const byte *source, int heightmask,
+                                        const pixel_t *colormap);
+
+// Fuzz, "count" pixels going down from "dest" by "pitch".
+// Every pixel becomes I_BlendDark of the pixel at offsets[i] from it.
+extern void (*I_DrawFuzzPixels) (pixel_t *dest, int pitch, int count,
+                                 const int *offsets, int alpha);
+
+// Selects kernels for the running CPU.
+extern void I_InitSIMD (void);
+
+#endif
+
+#endif
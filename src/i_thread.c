@@ -0,0 +1,193 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker thread pool, used by the strip renderer.
+//
+//      Workers are created on demand and live until the program exits.
+//      Each of them sleeps on its own semaphore until I_RunThreadJobs
+//      wakes it up, then takes job indexes from a shared counter until
+//      none are left. The calling thread takes part in the work too.
+//
+
+#include "SDL.h"
+
+#include "i_system.h"
+#include "i_thread.h"
+#include "m_fixed.h"
+
+
+static SDL_Thread   *workers[MAXTHREADS];
+static SDL_sem      *worker_start[MAXTHREADS];
+static SDL_sem      *worker_done;
+static int           num_workers;
+
+static SDL_mutex    *cache_mutex;
+static SDL_atomic_t  jobs_active;     // read by the workers too
+
+static threadjob_t   job_func;
+static int           job_count;
+static SDL_atomic_t  job_next;
+
+
+// -----------------------------------------------------------------------------
+// I_GetThreadCount
+// -----------------------------------------------------------------------------
+
+int I_GetThreadCount (int count)
+{
+    if (count <= 0)
+    {
+        count = SDL_GetCPUCount();
+    }
+
+    return BETWEEN(1, MAXTHREADS, count);
+}
+
+// -----------------------------------------------------------------------------
+// RunJobs
+// Takes job indexes until none are left.
+// -----------------------------------------------------------------------------
+
+static void RunJobs (void)
+{
+    int index;
+
+    while ((index = SDL_AtomicAdd(&job_next, 1)) < job_count)
+    {
+        job_func(index);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// WorkerThread
+// -----------------------------------------------------------------------------
+
+static int SDLCALL WorkerThread (void *data)
+{
+    SDL_sem *start = data;
+
+    for (;;)
+    {
+        SDL_SemWait(start);
+        RunJobs();
+        SDL_SemPost(worker_done);
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+// StartWorkers
+// Makes sure there are at least "count" workers.
+// -----------------------------------------------------------------------------
+
+static void StartWorkers (int count)
+{
+    if (!cache_mutex)
+    {
+        cache_mutex = SDL_CreateMutex();
+        worker_done = SDL_CreateSemaphore(0);
+
+        if (!cache_mutex || !worker_done)
+        {
+            I_Error("I_RunThreadJobs: %s", SDL_GetError());
+        }
+    }
+
+    while (num_workers < count)
+    {
+        worker_start[num_workers] = SDL_CreateSemaphore(0);
+        workers[num_workers] = SDL_CreateThread(WorkerThread, "worker",
+                                                worker_start[num_workers]);
+
+        if (!worker_start[num_workers] || !workers[num_workers])
+        {
+            I_Error("I_RunThreadJobs: %s", SDL_GetError());
+        }
+
+        SDL_DetachThread(workers[num_workers]);
+        num_workers++;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// I_RunThreadJobs
+// -----------------------------------------------------------------------------
+
+void I_RunThreadJobs (threadjob_t job, int count)
+{
+    const int wake = MIN(count, MAXTHREADS) - 1;
+    int i;
+
+    if (wake <= 0)
+    {
+        for (i = 0 ; i < count ; i++)
+        {
+            job(i);
+        }
+        return;
+    }
+
+    StartWorkers(wake);
+
+    job_func = job;
+    job_count = count;
+    SDL_AtomicSet(&job_next, 0);
+    SDL_AtomicSet(&jobs_active, 1);
+
+    for (i = 0 ; i < wake ; i++)
+    {
+        SDL_SemPost(worker_start[i]);
+    }
+
+    RunJobs();
+
+    for (i = 0 ; i < wake ; i++)
+    {
+        SDL_SemWait(worker_done);
+    }
+
+    SDL_AtomicSet(&jobs_active, 0);
+}
+
+// -----------------------------------------------------------------------------
+// I_ThreadJobsActive
+// -----------------------------------------------------------------------------
+
+boolean I_ThreadJobsActive (void)
+{
+    return SDL_AtomicGet(&jobs_active) != 0;
+}
+
+// -----------------------------------------------------------------------------
+// I_LockCache, I_UnlockCache
+// SDL mutexes are recursive, so nested calls (W_CacheLumpNum calling
+// Z_Malloc) are fine.
+// -----------------------------------------------------------------------------
+
+void I_LockCache (void)
+{
+    if (SDL_AtomicGet(&jobs_active))
+    {
+        SDL_LockMutex(cache_mutex);
+    }
+}
+
+void I_UnlockCache (void)
+{
+    if (SDL_AtomicGet(&jobs_active))
+    {
+        SDL_UnlockMutex(cache_mutex);
+    }
+}
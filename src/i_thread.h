@@ -0,0 +1,44 @@
+//
+// Copyright(C) 2016-2025 Julia Nechaevskaya
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      Worker thread pool, used by the strip renderer.
+//
+
+
+#ifndef __I_THREAD__
+#define __I_THREAD__
+
+#include "doomtype.h"
+
+// Upper limit of threads, including the calling one.
+#define MAXTHREADS 16
+
+typedef void (*threadjob_t) (int index);
+
+// Resolves "0 = automatic" to the number of CPUs and clamps to MAXTHREADS.
+int I_GetThreadCount (int count);
+
+// Runs job(0) ... job(count-1) on the worker threads and the calling
+// thread, returns once all of them are done.
+void I_RunThreadJobs (threadjob_t job, int count);
+
+// True while I_RunThreadJobs is executing jobs.
+boolean I_ThreadJobsActive (void);
+
+// Serializes access to the zone memory and the WAD lump cache
+// while jobs are running. No-ops otherwise.
+void I_LockCache (void);
+void I_UnlockCache (void);
+
+#endif
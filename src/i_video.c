@@ -20,6 +20,7 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include "SDL.h"
 #include "SDL_opengl.h"
@@ -37,6 +38,7 @@
 #include "doomtype.h"
 #include "i_input.h"
 #include "i_joystick.h"
+#include "i_perf.h"
 #include "i_system.h"
 #include "i_timer.h"
 #include "i_video.h"
@@ -242,6 +244,15 @@ int demowarp;
 
 static boolean noblit;
 
+// [JN] If this is true, there is no window and renderer, the screen is
+// rendered into I_VideoBuffer only.
+
+static boolean headless;
+
+// [JN] File to write 64-bit hash of every frame to.
+
+static FILE *framehash_file;
+
 // Callback function to invoke to determine whether to grab the 
 // mouse pointer.
 
@@ -878,6 +889,34 @@ fixed_t fractionaltic;
 //
 // I_FinishUpdate
 //
+// -----------------------------------------------------------------------------
+// I_WriteFrameHash
+// [JN] Writes gametic and 64-bit FNV-1a hash of the screen buffer.
+// Palette flash effects are not included in TrueColor mode, since
+// they are applied by the renderer.
+// -----------------------------------------------------------------------------
+
+static void I_WriteFrameHash (void)
+{
+    const pixel_t *pixel = I_VideoBuffer;
+    const pixel_t *const end = I_VideoBuffer + SCREENWIDTH * SCREENHEIGHT;
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    while (pixel < end)
+    {
+        hash ^= *pixel++;
+        hash *= 0x100000001b3ull;
+    }
+
+    fprintf(framehash_file, "%d %016" PRIx64 "\n", gametic, hash);
+}
+
+static void CloseFrameHashFile (void)
+{
+    fclose(framehash_file);
+    framehash_file = NULL;
+}
+
 void I_FinishUpdate (void)
 {
     // static int lasttic;
@@ -890,6 +929,19 @@ void I_FinishUpdate (void)
     if (noblit)
         return;
 
+    // [JN] Hash the frame before it gets to the screen.
+    if (framehash_file)
+    {
+        I_WriteFrameHash();
+    }
+
+    // [JN] Nothing to show in headless mode.
+    if (headless)
+    {
+        I_PerfEndFrame();
+        return;
+    }
+
     if (need_resize)
     {
         if (SDL_GetTicks() > last_resize_time + vid_resize_delay)
@@ -974,6 +1026,8 @@ void I_FinishUpdate (void)
 		}
 	}
 
+    I_PerfStart(PERF_BLIT);
+
     // Draw disk icon before blit, if necessary.
     if (vid_diskicon && diskicon_enabled)
     V_DrawDiskIcon();
@@ -1040,6 +1094,9 @@ void I_FinishUpdate (void)
 
     SDL_RenderPresent(renderer);
 
+    I_PerfStop(PERF_BLIT);
+    I_PerfStart(PERF_SLEEP);
+
     if (vid_uncapped_fps && !singletics)
     {
         // Limit framerate
@@ -1069,6 +1126,9 @@ void I_FinishUpdate (void)
             }
         }
     }
+
+    I_PerfStop(PERF_SLEEP);
+    I_PerfEndFrame();
 }
 
 
@@ -1352,6 +1412,38 @@ void I_GraphicsCheckCommandLine(void)
 
     noblit = M_CheckParm ("-noblit");
 
+    //!
+    // @category video
+    //
+    // Render without a window. Frames are drawn into the screen buffer
+    // only, for benchmarks and -framehash checks on systems without
+    // a display.
+    //
+
+    headless = M_ParmExists("-headless");
+
+    //!
+    // @arg <file>
+    // @category video
+    //
+    // Write gametic and 64-bit hash of every rendered frame to the
+    // given file. Frames match between runs only with -timedemo.
+    //
+
+    i = M_CheckParmWithArgs("-framehash", 1);
+
+    if (i > 0)
+    {
+        framehash_file = M_fopen(myargv[i + 1], "w");
+
+        if (!framehash_file)
+        {
+            I_Error("Failed to open %s", myargv[i + 1]);
+        }
+
+        I_AtExit(CloseFrameHashFile, true);
+    }
+
     //!
     // @category video 
     //
@@ -1967,6 +2059,39 @@ void I_ToggleVsync (void)
 #endif
 }
 
+// -----------------------------------------------------------------------------
+// I_InitHeadless
+// [JN] Creates the screen buffer only.
+// -----------------------------------------------------------------------------
+
+static void I_InitHeadless (void)
+{
+    I_GetScreenDimensions();
+
+#ifndef CRISPY_TRUECOLOR
+    blit_rect.w = SCREENWIDTH;
+    blit_rect.h = SCREENHEIGHT;
+#endif
+
+    V_Init();
+
+#ifndef CRISPY_TRUECOLOR
+    screenbuffer = SDL_CreateRGBSurface(0, SCREENWIDTH, SCREENHEIGHT, 8,
+                                        0, 0, 0, 0);
+    I_SetPalette(W_CacheLumpName(DEH_String("PLAYPAL"), PU_CACHE));
+    I_VideoBuffer = screenbuffer->pixels;
+#else
+    argbbuffer = SDL_CreateRGBSurfaceWithFormat(0, SCREENWIDTH, SCREENHEIGHT,
+                                                32, SDL_PIXELFORMAT_ARGB8888);
+    I_VideoBuffer = argbbuffer->pixels;
+#endif
+    V_RestoreBuffer();
+
+    memset(I_VideoBuffer, 0, SCREENWIDTH * SCREENHEIGHT * sizeof(*I_VideoBuffer));
+
+    initialized = true;
+}
+
 void I_InitGraphics(void)
 {
     SDL_Event dummy;
@@ -1975,6 +2100,14 @@ void I_InitGraphics(void)
 #endif
     char *env;
 
+    // [JN] No window and renderer in headless mode,
+    // only the screen buffer at the current resolution.
+    if (headless)
+    {
+        I_InitHeadless();
+        return;
+    }
+
     // Pass through the XSCREENSAVER_WINDOW environment variable to 
     // SDL_WINDOWID, to embed the SDL window into the Xscreensaver
     // window.
@@ -2128,6 +2261,12 @@ void I_ReInitGraphics (int reinit)
 		SDL_DestroyTexture(texture);
 	}
 
+	// [JN] No renderer and textures in headless mode.
+	if (headless)
+	{
+		return;
+	}
+
 	// [crispy] re-create renderer
 	if (reinit & REINIT_RENDERER)
 	{
@@ -41,6 +41,8 @@ int vid_fpslimit = 0;
 int vid_vsync = 1;
 int vid_showfps = 0;
 int vid_smooth_scaling = 0;
+int vid_render_threads = 1;  // [JN] 0 = one per CPU core
+int vid_column_batch = 1;
 // Miscellaneous
 int vid_screenwipe = 1;
 // [JN] Heretic and Hexen doesn't have screen wipe enabled by default.
@@ -172,6 +174,8 @@ int demo_timer = 0;
 int demo_timerdir = 0;
 int demo_bar = 0;
 int demo_internal = 1;
+int demo_keyframe_interval = 10;  // [JN] seconds, 0 = off
+int demo_keyframe_budget = 64;    // [JN] megabytes
 
 // Compatibility-breaking
 int compat_pistol_start = 0;
@@ -212,6 +216,11 @@ void ID_BindVariables (GameMission_t mission)
     M_BindIntVariable("vid_vsync",                      &vid_vsync);
     M_BindIntVariable("vid_showfps",                    &vid_showfps);
     M_BindIntVariable("vid_smooth_scaling",             &vid_smooth_scaling);
+    M_BindIntVariable("vid_render_threads",             &vid_render_threads);
+    if (mission == doom)
+    {
+        M_BindIntVariable("vid_column_batch",           &vid_column_batch);
+    }
     // Miscellaneous
     if (mission == doom)
     {
@@ -411,6 +420,11 @@ void ID_BindVariables (GameMission_t mission)
     M_BindIntVariable("demo_timerdir",                  &demo_timerdir);
     M_BindIntVariable("demo_bar",                       &demo_bar);
     M_BindIntVariable("demo_internal",                  &demo_internal);
+    if (mission == doom)
+    {
+        M_BindIntVariable("demo_keyframe_interval",     &demo_keyframe_interval);
+        M_BindIntVariable("demo_keyframe_budget",       &demo_keyframe_budget);
+    }
     
     // Compatibility-breaking
     if (mission == doom || mission == heretic)
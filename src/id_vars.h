@@ -40,6 +40,8 @@ extern int vid_uncapped_fps;
 extern int vid_fpslimit;
 extern int vid_vsync;
 extern int vid_showfps;
+extern int vid_render_threads;
+extern int vid_column_batch;
 extern int vid_gamma;
 extern int vid_fov;
 extern int vid_saturation;
@@ -145,6 +147,8 @@ extern int demo_timer;
 extern int demo_timerdir;
 extern int demo_bar;
 extern int demo_internal;
+extern int demo_keyframe_interval;
+extern int demo_keyframe_budget;
 
 // Compatibility-breaking
 extern int compat_pistol_start;
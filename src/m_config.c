@@ -182,6 +182,8 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(vid_vsync),
     CONFIG_VARIABLE_INT(vid_showfps),
     CONFIG_VARIABLE_INT(vid_smooth_scaling),
+    CONFIG_VARIABLE_INT(vid_render_threads),
+    CONFIG_VARIABLE_INT(vid_column_batch),
     CONFIG_VARIABLE_INT(vid_screenwipe),
     CONFIG_VARIABLE_INT(vid_diskicon),
     CONFIG_VARIABLE_INT(vid_endoom),
@@ -301,6 +303,8 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_KEY(key_reloadlevel),
     CONFIG_VARIABLE_KEY(key_nextlevel),
     CONFIG_VARIABLE_KEY(key_demospeed),
+    CONFIG_VARIABLE_KEY(key_demo_rewind),
+    CONFIG_VARIABLE_KEY(key_demo_forward),
     CONFIG_VARIABLE_KEY(key_flip_levels),
     CONFIG_VARIABLE_KEY(key_widget_enable),
 
@@ -586,6 +590,8 @@ static default_t	doom_defaults_list[] =
     CONFIG_VARIABLE_INT(demo_timerdir),
     CONFIG_VARIABLE_INT(demo_bar),
     CONFIG_VARIABLE_INT(demo_internal),
+    CONFIG_VARIABLE_INT(demo_keyframe_interval),
+    CONFIG_VARIABLE_INT(demo_keyframe_budget),
 
     // Compatibility-breaking
     CONFIG_VARIABLE_INT(compat_pistol_start),
@@ -62,6 +62,8 @@ int key_novert     = 0;
 int key_reloadlevel = 0; // [crispy]
 int key_nextlevel   = 0; // [crispy]
 int key_demospeed   = 0; // [crispy]
+int key_demo_rewind  = 0;
+int key_demo_forward = 0;
 int key_flip_levels = 0; // [crispy]
 int key_widget_enable = 0;
 
@@ -279,6 +281,8 @@ void M_BindControls (void)
     M_BindIntVariable("key_reloadlevel",     &key_reloadlevel); // [crispy]
     M_BindIntVariable("key_nextlevel",       &key_nextlevel);   // [crispy]
     M_BindIntVariable("key_demospeed",       &key_demospeed);   // [crispy]
+    M_BindIntVariable("key_demo_rewind",     &key_demo_rewind);
+    M_BindIntVariable("key_demo_forward",    &key_demo_forward);
     M_BindIntVariable("key_flip_levels",     &key_flip_levels); // [crispy]
     M_BindIntVariable("key_widget_enable",   &key_widget_enable);
 
@@ -51,6 +51,8 @@ extern int key_novert;
 extern int key_nextlevel;   // [crispy]
 extern int key_reloadlevel; // [crispy]
 extern int key_demospeed;   // [crispy]
+extern int key_demo_rewind;
+extern int key_demo_forward;
 extern int key_flip_levels; // [crispy]
 extern int key_widget_enable;
 
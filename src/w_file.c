@@ -43,6 +43,19 @@ wad_file_t *W_OpenFile(const char *path)
     wad_file_t *result;
     int i;
 
+#ifdef HAVE_MMAP
+    //!
+    // @category obscure
+    //
+    // Don't use the OS's virtual memory subsystem to map WAD files
+    // directly into memory, read them into zone memory instead.
+    //
+
+    if (M_CheckParm("-nommap"))
+    {
+        return stdc_wad_file.OpenFile(path);
+    }
+#else
     //!
     // @category obscure
     //
@@ -54,6 +67,7 @@ wad_file_t *W_OpenFile(const char *path)
     {
         return stdc_wad_file.OpenFile(path);
     }
+#endif
 
     // Try all classes in order until we find one that works
 
@@ -83,3 +97,11 @@ size_t W_Read(wad_file_t *wad, unsigned int offset,
     return wad->file_class->Read(wad, offset, buffer, buffer_len);
 }
 
+void W_Prefetch(wad_file_t *wad, unsigned int offset, size_t len)
+{
+    if (wad->mapped != NULL && wad->file_class->Prefetch != NULL)
+    {
+        wad->file_class->Prefetch(wad, offset, len);
+    }
+}
+
@@ -25,6 +25,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <stdint.h>
 #include <string.h>
 
 #include "m_misc.h"
@@ -44,15 +45,14 @@ static void MapFile(posix_wad_file_t *wad, const char *filename)
     int protection;
     int flags;
 
-    // Mapped area can be read and written to.  Ideally
-    // this should be read-only, as none of the Doom code should 
-    // change the WAD files after being read.  However, there may
-    // be code lurking in the source that does.
+    // [JN] Mapped area is read-only, none of the code changes the
+    // WAD files after being read.  Code that needs to modify lump
+    // data has to work on its own copy of it.
 
-    protection = PROT_READ|PROT_WRITE;
+    protection = PROT_READ;
 
-    // Writes to the mapped area result in private changes that are
-    // *not* written to disk.
+    // Private mapping, changes of the file on disk are not guaranteed
+    // to be seen.
 
     flags = MAP_PRIVATE;
 
@@ -68,10 +68,16 @@ static void MapFile(posix_wad_file_t *wad, const char *filename)
     else
     {
         wad->wad.mapped = result;
+
+        // [JN] Lumps are accessed in no particular order, so don't
+        // let the kernel read ahead of them.  Lumps needed by the level
+        // are prefetched explicitly by W_Prefetch.
+
+        madvise(result, wad->wad.length, MADV_RANDOM);
     }
 }
 
-unsigned int GetFileLength(int handle)
+static unsigned int GetFileLength(int handle)
 {
     return lseek(handle, 0, SEEK_END);
 }
@@ -164,12 +170,50 @@ size_t W_POSIX_Read(wad_file_t *wad, unsigned int offset,
     return bytes_read;
 }
 
+// [JN] Ask the kernel to start reading the specified range of
+// the mapped file in background.
+
+static void W_POSIX_Prefetch(wad_file_t *wad, unsigned int offset,
+                             size_t len)
+{
+    static long pagesize;
+    uintptr_t start, end;
+
+    if (!pagesize)
+    {
+        pagesize = sysconf(_SC_PAGESIZE);
+
+        if (pagesize <= 0)
+        {
+            pagesize = 4096;
+        }
+    }
+
+    if (len == 0 || offset >= wad->length)
+    {
+        return;
+    }
+
+    if (len > wad->length - offset)
+    {
+        len = wad->length - offset;
+    }
+
+    // madvise() needs a page-aligned address.
+
+    start = (uintptr_t) (wad->mapped + offset) & ~(uintptr_t) (pagesize - 1);
+    end = (uintptr_t) (wad->mapped + offset + len);
+
+    madvise((void *) start, end - start, MADV_WILLNEED);
+}
+
 
 wad_file_class_t posix_wad_file = 
 {
     W_POSIX_OpenFile,
     W_POSIX_CloseFile,
     W_POSIX_Read,
+    W_POSIX_Prefetch,
 };
 
 
@@ -29,6 +29,7 @@
 
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_thread.h"
 #include "i_video.h"
 #include "m_misc.h"
 #include "v_diskicon.h"
@@ -440,20 +441,31 @@ void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
 
         result = lump->wad_file->mapped + lump->position;
     }
-    else if (lump->cache != NULL)
-    {
-        // Already cached, so just switch the zone tag.
-
-        result = lump->cache;
-        Z_ChangeTag(lump->cache, tag);
-    }
     else
     {
-        // Not yet loaded, so load it now
+        // [JN] Render threads may ask for the same lump at once.
+        I_LockCache();
+
+        if (lump->cache != NULL)
+        {
+            // Already cached, so just switch the zone tag.
+
+            result = lump->cache;
+            Z_ChangeTag(lump->cache, tag);
+        }
+        else
+        {
+            // Not yet loaded, so load it now
+
+            lump->cache = Z_Malloc(W_LumpLength(lumpnum), tag, &lump->cache);
+            W_ReadLump (lumpnum, lump->cache);
+            result = lump->cache;
+        }
 
-        lump->cache = Z_Malloc(W_LumpLength(lumpnum), tag, &lump->cache);
-	W_ReadLump (lumpnum, lump->cache);
-        result = lump->cache;
+        // [JN] Strip renderer draws from it until the frame is done.
+        Z_PinBlock(result);
+
+        I_UnlockCache();
     }
 	
     return result;
@@ -505,6 +517,22 @@ void W_ReleaseLumpName(const char *name)
     W_ReleaseLumpNum(W_GetNumForName(name));
 }
 
+//
+// [JN] W_PrefetchLumps
+// Hint that the given lumps will be read soon, so pages of the
+// memory-mapped files can be read in background while the
+// preceding ones are being processed.
+//
+
+void W_PrefetchLumps(lumpindex_t lump, int count)
+{
+    for ( ; count > 0 && (unsigned)lump < numlumps; lump++, count--)
+    {
+        W_Prefetch(lumpinfo[lump]->wad_file,
+                   lumpinfo[lump]->position, lumpinfo[lump]->size);
+    }
+}
+
 #if 0
 
 //
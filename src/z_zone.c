@@ -17,11 +17,15 @@
 //	Zone Memory Allocation. Neat.
 //
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "doomtype.h"
 #include "i_system.h"
+#include "i_thread.h"
+#include "i_timer.h"
 #include "m_argv.h"
+#include "m_misc.h"
 #include "z_zone.h"
 
 #include "id_vars.h"
@@ -44,6 +48,7 @@
 typedef struct memblock_s
 {
     int			size;	// including the header and possibly tiny fragments
+    int			pin;	// [JN] pinning generation, see Z_PinBlock
     void**		user;
     int			tag;	// PU_FREE if this is free
     int			id;	// should be ZONEID
@@ -70,6 +75,103 @@ static memzone_t *mainzone;
 static boolean zero_on_free;
 static boolean scan_on_free;
 
+// [JN] Blocks with "pin" equal to pingen are not purged while pinning is on.
+static int pingen;
+static boolean pinning;
+
+
+//
+// [JN] Arenas of level objects.
+//
+// Anonymous (without an owner) PU_LEVEL and PU_LEVSPEC blocks are not
+// taken from the block list, but from an arena of their tag.  Small
+// objects (mobjs, thinkers, specials) go to slabs of same-sized objects
+// with a free list per size class, larger ones are placed one after
+// another into chunks.  Slabs and chunks are PU_STATIC zone blocks, so
+// Z_FreeTags releases an arena a slab or chunk at a time instead of
+// merging its blocks one by one.
+//
+// An arena object has the usual memblock_t header with ARENAID, its
+// "prev" pointing to the zone block of the slab or chunk, and "next"
+// linking the free objects of a slab.
+//
+
+#define ARENAID        0x1d4a12
+
+#define SLAB_GRANULE   16
+#define SLAB_MAXSIZE   512     // largest object taken from slabs
+#define SLAB_SIZE      32768   // size of a slab, including its headers
+#define CHUNK_SIZE     262144  // size of a chunk, including its headers
+
+typedef struct chunk_s
+{
+    struct chunk_s  *next, *prev;   // slabs of the class, chunks of the arena
+    struct chunk_s  *nextfree;      // slabs with free objects
+    struct chunk_s **prevfree;
+    memblock_t      *freelist;      // free objects of a slab
+    int              used;          // objects in use
+    int              class;         // size class of a slab, -1 for a chunk
+    int              top;           // end of objects in a chunk
+    int              arena;
+} chunk_t;
+
+typedef struct
+{
+    chunk_t  slabs;                 // start / end cap for list of slabs
+    chunk_t *freeslabs;             // slabs with free objects
+} slabclass_t;
+
+static const int slab_sizes[] = {
+    16, 32, 48, 64, 96, 128, 160, 192, 256, 320, 384, 448, SLAB_MAXSIZE
+};
+
+#define NUMSLABCLASSES arrlen(slab_sizes)
+
+typedef struct
+{
+    slabclass_t classes[NUMSLABCLASSES];
+    chunk_t     chunks;             // start / end cap for list of chunks
+    chunk_t    *current;            // chunk new objects are placed into
+    int         used;               // objects in use
+    int         bytes;              // size of objects in use
+    int         changed;            // objects given another tag or an owner
+} arena_t;
+
+#define NUMARENAS (PU_LEVSPEC - PU_LEVEL + 1)
+
+static arena_t arenas[NUMARENAS];
+static int slab_objsize[NUMSLABCLASSES];    // including the header
+static int slab_objcount[NUMSLABCLASSES];   // objects per slab
+static byte slab_classfor[SLAB_MAXSIZE / SLAB_GRANULE + 1];
+
+
+//
+// [JN] Zone memory statistics.
+//
+
+static int          tag_bytes[PU_NUM_TAGS];
+static int          tag_blocks[PU_NUM_TAGS];
+static int          tag_peak[PU_NUM_TAGS];
+static unsigned int zone_mallocs;
+static unsigned int zone_frees;
+static int          zone_growths;
+static FILE        *zonestats_file;
+
+const char *zone_tagnames[PU_NUM_TAGS] = {
+    NULL, "STA", "SND", "MUS", NULL, "LVL", "SPC", "PRG", "CCH"
+};
+
+static void Z_CountBlock (int tag, int size)
+{
+    tag_bytes[tag] += size;
+    tag_blocks[tag] += size > 0 ? 1 : -1;
+
+    if (tag_bytes[tag] > tag_peak[tag])
+    {
+        tag_peak[tag] = tag_bytes[tag];
+    }
+}
+
 
 //
 // Z_ClearZone
@@ -97,6 +199,17 @@ void Z_ClearZone (memzone_t* zone)
 
 
 
+static void CloseZoneStats (void)
+{
+    if (zonestats_file)
+    {
+        fclose(zonestats_file);
+        zonestats_file = NULL;
+    }
+}
+
+static void Z_Benchmark (void);
+
 //
 // Z_Init
 //
@@ -135,6 +248,87 @@ void Z_Init (void)
     // heap is scanned to look for remaining pointers to the freed block.
     //
     scan_on_free = M_ParmExists("-zonescan");
+
+    // [JN] Set up arenas, once.  Z_Init is called again to add
+    // a bigger zone, existing arenas stay where they are.
+    if (!slab_objsize[0])
+    {
+        int i, j = 0;
+
+        for (i = 0; i < NUMSLABCLASSES; i++)
+        {
+            slab_objsize[i] = slab_sizes[i] + sizeof(memblock_t);
+            slab_objcount[i] = (SLAB_SIZE - sizeof(memblock_t) - sizeof(chunk_t))
+                             / slab_objsize[i];
+
+            for ( ; j * SLAB_GRANULE <= slab_sizes[i]; j++)
+            {
+                slab_classfor[j] = i;
+            }
+        }
+
+        for (i = 0; i < NUMARENAS; i++)
+        {
+            arena_t *const arena = &arenas[i];
+
+            for (j = 0; j < NUMSLABCLASSES; j++)
+            {
+                chunk_t *const slabs = &arena->classes[j].slabs;
+
+                slabs->next = slabs->prev = slabs;
+            }
+
+            arena->chunks.next = arena->chunks.prev = &arena->chunks;
+        }
+
+        //!
+        // @arg <file>
+        // @category obscure
+        //
+        // Log zone memory statistics to the given file as CSV, a line
+        // per level, written after memory of the previous level is
+        // freed.  Peaks and allocation counts are since the previous line.
+        //
+
+        i = M_CheckParmWithArgs("-zonestats", 1);
+
+        if (i)
+        {
+            zonestats_file = M_fopen(myargv[i + 1], "w");
+
+            if (!zonestats_file)
+            {
+                I_Error("Z_Init: Failed to open %s", myargv[i + 1]);
+            }
+
+            fprintf(zonestats_file, "map,zonesize,growths,free,largestfree,frag");
+
+            for (j = 1; j < PU_NUM_TAGS; j++)
+            {
+                if (zone_tagnames[j])
+                {
+                    fprintf(zonestats_file, ",%s_bytes,%s_blocks,%s_peak",
+                            zone_tagnames[j], zone_tagnames[j], zone_tagnames[j]);
+                }
+            }
+
+            fprintf(zonestats_file, ",mallocs,frees\n");
+
+            I_AtExit(CloseZoneStats, true);
+        }
+
+        //!
+        // @category obscure
+        //
+        // Time the zone allocator on a stress test of level objects
+        // at startup, with the block list and with the arenas.
+        //
+
+        if (M_ParmExists("-zonebench"))
+        {
+            Z_Benchmark();
+        }
+    }
 }
 
 // Scan the zone heap for pointers within the specified range, and warn about
@@ -174,10 +368,378 @@ static void ScanForBlock(void *start, void *end)
     }
 }
 
+// -----------------------------------------------------------------------------
+// [JN] Arenas of level objects.
+// -----------------------------------------------------------------------------
+
+static void *Z_MallocBlock (int size, int tag, void *user);
+static void Z_FreeBlock (void *ptr);
+
+#define CHUNK(block)        ((chunk_t *) ((byte *) (block)->prev + sizeof(memblock_t)))
+#define CHUNKDATA(chunk)    ((byte *) ((chunk) + 1))
+#define SLABOBJECT(slab, i) ((memblock_t *) (CHUNKDATA(slab) + \
+                             (i) * slab_objsize[(slab)->class]))
+
+static void LinkFreeSlab (slabclass_t *sc, chunk_t *slab)
+{
+    slab->nextfree = sc->freeslabs;
+    slab->prevfree = &sc->freeslabs;
+
+    if (sc->freeslabs)
+    {
+        sc->freeslabs->prevfree = &slab->nextfree;
+    }
+
+    sc->freeslabs = slab;
+}
+
+static void UnlinkFreeSlab (chunk_t *slab)
+{
+    *slab->prevfree = slab->nextfree;
+
+    if (slab->nextfree)
+    {
+        slab->nextfree->prevfree = slab->prevfree;
+    }
+
+    slab->nextfree = NULL;
+    slab->prevfree = NULL;
+}
+
+// Allocates a slab or chunk of the given size and adds it to the list.
+static chunk_t *Z_NewChunk (chunk_t *list, int size, int class, int arena)
+{
+    chunk_t *chunk;
+
+    chunk = Z_MallocBlock(size - sizeof(memblock_t), PU_STATIC, NULL);
+
+    chunk->next = list;
+    chunk->prev = list->prev;
+    chunk->prev->next = chunk;
+    list->prev = chunk;
+    chunk->nextfree = NULL;
+    chunk->prevfree = NULL;
+    chunk->freelist = NULL;
+    chunk->used = 0;
+    chunk->class = class;
+    chunk->top = 0;
+    chunk->arena = arena;
+
+    return chunk;
+}
+
+static void Z_ReleaseChunk (chunk_t *chunk)
+{
+    arena_t *const arena = &arenas[chunk->arena];
+
+    if (chunk->prevfree)
+    {
+        UnlinkFreeSlab(chunk);
+    }
+
+    if (arena->current == chunk)
+    {
+        arena->current = NULL;
+    }
+
+    chunk->prev->next = chunk->next;
+    chunk->next->prev = chunk->prev;
+
+    Z_FreeBlock(chunk);
+}
+
+static memblock_t *Z_MallocSlab (arena_t *arena, int class)
+{
+    slabclass_t *const sc = &arena->classes[class];
+    chunk_t *slab = sc->freeslabs;
+    memblock_t *block;
+    int i;
+
+    if (!slab)
+    {
+        slab = Z_NewChunk(&sc->slabs, SLAB_SIZE, class, arena - arenas);
+
+        // Objects are linked backwards, so they are taken
+        // from the start of the slab.
+        for (i = slab_objcount[class] - 1; i >= 0; i--)
+        {
+            block = SLABOBJECT(slab, i);
+            block->size = slab_objsize[class];
+            block->user = NULL;
+            block->tag = PU_FREE;
+            block->id = 0;
+            block->prev = (memblock_t *) ((byte *) slab - sizeof(memblock_t));
+            block->next = slab->freelist;
+            slab->freelist = block;
+        }
+
+        LinkFreeSlab(sc, slab);
+    }
+
+    block = slab->freelist;
+    slab->freelist = block->next;
+
+    if (++slab->used == slab_objcount[class])
+    {
+        UnlinkFreeSlab(slab);
+    }
+
+    return block;
+}
+
+static memblock_t *Z_MallocChunk (arena_t *arena, int size)
+{
+    const int space = CHUNK_SIZE - sizeof(memblock_t) - sizeof(chunk_t);
+    chunk_t *chunk = arena->current;
+    memblock_t *block;
+
+    if (size > space)
+    {
+        // Too big, gets a chunk of its own.
+        chunk = Z_NewChunk(&arena->chunks,
+                           size + sizeof(memblock_t) + sizeof(chunk_t),
+                           -1, arena - arenas);
+    }
+    else if (!chunk || chunk->top + size > space)
+    {
+        chunk = Z_NewChunk(&arena->chunks, CHUNK_SIZE, -1, arena - arenas);
+        arena->current = chunk;
+    }
+
+    block = (memblock_t *) (CHUNKDATA(chunk) + chunk->top);
+    block->size = size;
+    block->prev = (memblock_t *) ((byte *) chunk - sizeof(memblock_t));
+
+    chunk->top += size;
+    chunk->used++;
+
+    return block;
+}
+
+static void *Z_MallocArena (int size, int tag)
+{
+    arena_t *const arena = &arenas[tag - PU_LEVEL];
+    memblock_t *block;
+    void *result;
+
+    I_LockCache();
+
+    if (size <= SLAB_MAXSIZE)
+    {
+        block = Z_MallocSlab(arena, slab_classfor[(size + SLAB_GRANULE - 1)
+                                                  / SLAB_GRANULE]);
+    }
+    else
+    {
+        size = (size + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1);
+        block = Z_MallocChunk(arena, size + sizeof(memblock_t));
+    }
+
+    block->user = NULL;
+    block->tag = tag;
+    block->id = ARENAID;
+    block->next = NULL;
+    arena->used++;
+    arena->bytes += block->size;
+    Z_CountBlock(tag, block->size);
+    zone_mallocs++;
+
+    result = (void *) ((byte *) block + sizeof(memblock_t));
+
+    I_UnlockCache();
+
+    return result;
+}
+
+static void Z_FreeArena (memblock_t *block)
+{
+    chunk_t *const chunk = CHUNK(block);
+    void *const ptr = (byte *) block + sizeof(memblock_t);
+
+    I_LockCache();
+
+    if (block->user != NULL)
+    {
+        *block->user = 0;
+    }
+
+    Z_CountBlock(block->tag, -block->size);
+    zone_frees++;
+
+    block->tag = PU_FREE;
+    block->user = NULL;
+    block->id = 0;
+    arenas[chunk->arena].used--;
+    arenas[chunk->arena].bytes -= block->size;
+
+    if (zero_on_free)
+    {
+        memset(ptr, 0, block->size - sizeof(memblock_t));
+    }
+    if (scan_on_free)
+    {
+        ScanForBlock(ptr, (byte *) ptr + block->size - sizeof(memblock_t));
+    }
+
+    if (chunk->class >= 0)
+    {
+        block->next = chunk->freelist;
+        chunk->freelist = block;
+
+        // Slab was full, objects can be taken from it again.
+        if (chunk->used-- == slab_objcount[chunk->class])
+        {
+            LinkFreeSlab(&arenas[chunk->arena].classes[chunk->class], chunk);
+        }
+    }
+    else
+    {
+        // Last object of a chunk, its space can be reused.
+        if ((byte *) block + block->size == CHUNKDATA(chunk) + chunk->top)
+        {
+            chunk->top -= block->size;
+        }
+
+        if (--chunk->used == 0)
+        {
+            if (chunk == arenas[chunk->arena].current)
+            {
+                chunk->top = 0;
+            }
+            else
+            {
+                Z_ReleaseChunk(chunk);
+            }
+        }
+    }
+
+    I_UnlockCache();
+}
+
+// Frees objects of the arena in the given tag range, or purgable ones,
+// and releases slabs and chunks left empty.
+static void Z_FreeArenaTags (arena_t *arena, int lowtag, int hightag)
+{
+    chunk_t *chunk, *next;
+    memblock_t *block;
+    int i, j, size;
+
+    for (i = 0; i < NUMSLABCLASSES; i++)
+    {
+        chunk_t *const slabs = &arena->classes[i].slabs;
+
+        for (chunk = slabs->next; chunk != slabs; chunk = next)
+        {
+            next = chunk->next;
+
+            for (j = 0; j < slab_objcount[i] && chunk->used; j++)
+            {
+                block = SLABOBJECT(chunk, j);
+
+                if (block->id == ARENAID
+                && ((block->tag >= lowtag && block->tag <= hightag)
+                ||   block->tag >= PU_PURGELEVEL))
+                {
+                    Z_FreeArena(block);
+                }
+            }
+
+            if (!chunk->used)
+            {
+                Z_ReleaseChunk(chunk);
+            }
+        }
+    }
+
+    // Chunks are released by Z_FreeArena once their last object is freed.
+    for (chunk = arena->chunks.next; chunk != &arena->chunks; chunk = next)
+    {
+        next = chunk->next;
+
+        for (j = 0; j < chunk->top && chunk->used; j += size)
+        {
+            block = (memblock_t *) (CHUNKDATA(chunk) + j);
+            size = block->size;
+
+            if (block->id == ARENAID
+            && ((block->tag >= lowtag && block->tag <= hightag)
+            ||   block->tag >= PU_PURGELEVEL))
+            {
+                if (chunk->used == 1)
+                {
+                    Z_FreeArena(block);
+                    break;
+                }
+
+                Z_FreeArena(block);
+            }
+        }
+    }
+
+    if (!arena->used)
+    {
+        arena->changed = 0;
+    }
+}
+
+// Frees purgable objects of all arenas, returns true if there were any.
+// Called by the purge scan before the zone is grown, as such objects
+// are not in the block list.
+static boolean Z_PurgeArenas (void)
+{
+    boolean purged = false;
+    int i, used;
+
+    for (i = 0; i < NUMARENAS; i++)
+    {
+        // Arena objects become purgable only through Z_ChangeTag.
+        if (arenas[i].changed)
+        {
+            used = arenas[i].used;
+            // Empty tag range, only purgable objects are freed.
+            Z_FreeArenaTags(&arenas[i], PU_PURGELEVEL, PU_PURGELEVEL - 1);
+            purged |= arenas[i].used != used;
+        }
+    }
+
+    return purged;
+}
+
+// Releases all slabs and chunks of the arena, without looking
+// at the objects.
+static void Z_ResetArena (arena_t *arena)
+{
+    int i;
+
+    for (i = 0; i < NUMSLABCLASSES; i++)
+    {
+        chunk_t *const slabs = &arena->classes[i].slabs;
+
+        while (slabs->next != slabs)
+        {
+            Z_ReleaseChunk(slabs->next);
+        }
+    }
+
+    while (arena->chunks.next != &arena->chunks)
+    {
+        Z_ReleaseChunk(arena->chunks.next);
+    }
+
+    // All objects have the tag of the arena.
+    tag_bytes[PU_LEVEL + (arena - arenas)] -= arena->bytes;
+    tag_blocks[PU_LEVEL + (arena - arenas)] -= arena->used;
+    zone_frees += arena->used;
+
+    arena->used = 0;
+    arena->bytes = 0;
+    arena->changed = 0;
+}
+
 //
-// Z_Free
+// Z_FreeBlock
 //
-void Z_Free (void* ptr)
+static void Z_FreeBlock (void* ptr)
 {
     memblock_t*		block;
     memblock_t*		other;
@@ -187,6 +749,8 @@ void Z_Free (void* ptr)
     if (block->id != ZONEID)
 	I_Error ("Z_Free: freed a pointer without ZONEID");
 
+    I_LockCache();
+
     if (block->tag != PU_FREE && block->user != NULL)
     {
     	// clear the user's mark
@@ -236,19 +800,46 @@ void Z_Free (void* ptr)
         if (other == mainzone->rover)
             mainzone->rover = block;
     }
+
+    I_UnlockCache();
+}
+
+//
+// Z_Free
+//
+void Z_Free (void* ptr)
+{
+    memblock_t*		block;
+
+    block = (memblock_t *) ( (byte *)ptr - sizeof(memblock_t));
+
+    if (block->id == ARENAID)
+    {
+        Z_FreeArena(block);
+        return;
+    }
+
+    if (block->id != ZONEID)
+	I_Error ("Z_Free: freed a pointer without ZONEID");
+
+    I_LockCache();
+    Z_CountBlock(block->tag, -block->size);
+    zone_frees++;
+    Z_FreeBlock(ptr);
+    I_UnlockCache();
 }
 
 
 
 //
-// Z_Malloc
+// Z_MallocBlock
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
 //
 #define MINFRAGMENT		64
 
 
-void*
-Z_Malloc
+static void*
+Z_MallocBlock
 ( int		size,
   int		tag,
   void*		user )
@@ -259,6 +850,7 @@ Z_Malloc
     memblock_t* newblock;
     memblock_t*	base;
     void *result;
+    boolean purgedarenas = false;
 
     size = (size + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1);
     
@@ -269,6 +861,8 @@ Z_Malloc
 
     // account for size of block header
     size += sizeof(memblock_t);
+
+    I_LockCache();
     
     // if there is a free block behind the rover,
     //  back up over them
@@ -287,17 +881,33 @@ Z_Malloc
             // scanned all the way around the list
 //          I_Error ("Z_Malloc: failed on allocation of %i bytes", size);
 
-            // [crispy] allocate another zone twice as big
-            Z_Init();
+            // [JN] Purgable arena objects are not in the block list,
+            // so free them and scan once more before growing the zone.
+            if (!purgedarenas && Z_PurgeArenas())
+            {
+                purgedarenas = true;
+            }
+            else
+            {
+                // [crispy] allocate another zone twice as big
+                Z_Init();
+                zone_growths++;
+            }
 
             base = mainzone->rover;
+
+            if (base->prev->tag == PU_FREE)
+                base = base->prev;
+
             rover = base;
             start = base->prev;
         }
 	
         if (rover->tag != PU_FREE)
         {
-            if (rover->tag < PU_PURGELEVEL)
+            // [JN] Renderer may still be using pinned blocks.
+            if (rover->tag < PU_PURGELEVEL
+             || (pinning && rover->pin == pingen))
             {
                 // hit a block that can't be purged,
                 // so move base past it
@@ -346,6 +956,7 @@ Z_Malloc
 
     base->user = user;
     base->tag = tag;
+    base->pin = 0;
 
     result  = (void *) ((byte *)base + sizeof(memblock_t));
 
@@ -358,10 +969,37 @@ Z_Malloc
     mainzone->rover = base->next;	
 	
     base->id = ZONEID;
+
+    I_UnlockCache();
    
     return result;
 }
 
+//
+// Z_Malloc
+// You can pass a NULL user if the tag is < PU_PURGELEVEL.
+//
+void *Z_Malloc (int size, int tag, void *user)
+{
+    memblock_t *block;
+    void *result;
+
+    // [JN] Anonymous level objects are taken from arenas.
+    if ((tag == PU_LEVEL || tag == PU_LEVSPEC) && user == NULL && size >= 0)
+    {
+        return Z_MallocArena(size, tag);
+    }
+
+    I_LockCache();
+    result = Z_MallocBlock(size, tag, user);
+    block = (memblock_t *) ((byte *) result - sizeof(memblock_t));
+    Z_CountBlock(tag, block->size);
+    zone_mallocs++;
+    I_UnlockCache();
+
+    return result;
+}
+
 
 
 //
@@ -374,6 +1012,23 @@ Z_FreeTags
 {
     memblock_t*	block;
     memblock_t*	next;
+    int i;
+
+    // [JN] Arenas are released as a whole, unless some of their objects
+    // were given another tag or an owner.  Purgable objects are purged
+    // from arenas by Z_Malloc only when the zone is full, so they are
+    // freed here as well.
+    for (i = 0; i < NUMARENAS; i++)
+    {
+        if (arenas[i].changed)
+        {
+            Z_FreeArenaTags(&arenas[i], lowtag, hightag);
+        }
+        else if (PU_LEVEL + i >= lowtag && PU_LEVEL + i <= hightag)
+        {
+            Z_ResetArena(&arenas[i]);
+        }
+    }
 	
     for (block = mainzone->blocklist.next ;
 	 block != &mainzone->blocklist ;
@@ -434,12 +1089,109 @@ Z_DumpHeap
 }
 
 
+//
+// [JN] Z_WalkArena
+// Checks slabs and chunks of the arena, printing them and their
+// objects to the file, if given.  Returns the first error found.
+//
+static const char *Z_WalkChunk (const chunk_t *chunk, FILE *f)
+{
+    const memblock_t *block;
+    const int end = chunk->class >= 0 ?
+                    slab_objcount[chunk->class] * slab_objsize[chunk->class] :
+                    chunk->top;
+    int used = 0, free = 0;
+    int j;
+
+    if (f)
+        fprintf (f,"%s:%p    size:%7i    used:%4i\n",
+                 chunk->class >= 0 ? "slab" : "chunk",
+                 (const void*)chunk, end, chunk->used);
+
+    for (j = 0; j < end; j += block->size)
+    {
+        block = (const memblock_t *) ((const byte *) (chunk + 1) + j);
+
+        if (CHUNK(block) != chunk || block->size <= 0
+        || (chunk->class >= 0 && block->size != slab_objsize[chunk->class]))
+            return "arena object with wrong header";
+
+        if (block->id == ARENAID)
+        {
+            used++;
+
+            if (f)
+                fprintf (f,"  object:%p    size:%7i    user:%p    tag:%3i\n",
+                         (const void*)block, block->size,
+                         (void*)block->user, block->tag);
+        }
+    }
+
+    if (used != chunk->used)
+        return "arena object count mismatch";
+
+    if (chunk->class >= 0)
+    {
+        for (block = chunk->freelist; block; block = block->next)
+        {
+            if (block->id == ARENAID || ++free > slab_objcount[chunk->class])
+                return "slab free list is broken";
+        }
+
+        if (used + free != slab_objcount[chunk->class])
+            return "slab free list count mismatch";
+
+        if ((chunk->prevfree != NULL) != (used < slab_objcount[chunk->class]))
+            return "slab free list link mismatch";
+    }
+
+    return NULL;
+}
+
+static const char *Z_WalkArena (const arena_t *arena, FILE *f)
+{
+    const chunk_t *chunk;
+    const char *error;
+    int i;
+
+    for (i = 0; i < NUMSLABCLASSES; i++)
+    {
+        const chunk_t *const slabs = &arena->classes[i].slabs;
+
+        for (chunk = slabs->next; chunk != slabs; chunk = chunk->next)
+        {
+            if ((error = Z_WalkChunk(chunk, f)) != NULL)
+            {
+                if (f)
+                    fprintf (f,"ERROR: %s\n", error);
+                else
+                    return error;
+            }
+        }
+    }
+
+    for (chunk = arena->chunks.next; chunk != &arena->chunks; chunk = chunk->next)
+    {
+        if ((error = Z_WalkChunk(chunk, f)) != NULL)
+        {
+            if (f)
+                fprintf (f,"ERROR: %s\n", error);
+            else
+                return error;
+        }
+    }
+
+    return NULL;
+}
+
+
 //
 // Z_FileDumpHeap
 //
 void Z_FileDumpHeap (FILE* f)
 {
     memblock_t*	block;
+    int		i;
 	
     fprintf (f,"zone size: %i  location: %p\n",mainzone->size,(void*)mainzone);
 	
@@ -463,6 +1215,12 @@ void Z_FileDumpHeap (FILE* f)
 	if (block->tag == PU_FREE && block->next->tag == PU_FREE)
 	    fprintf (f,"ERROR: two consecutive free blocks\n");
     }
+
+    // [JN] Arenas.
+    for (i = 0; i < NUMARENAS; i++)
+    {
+        Z_WalkArena(&arenas[i], f);
+    }
 }
 
 
@@ -473,6 +1231,7 @@ void Z_FileDumpHeap (FILE* f)
 void Z_CheckHeap (void)
 {
     memblock_t*	block;
+    int		i;
 	
     for (block = mainzone->blocklist.next ; ; block = block->next)
     {
@@ -491,6 +1250,15 @@ void Z_CheckHeap (void)
 	if (block->tag == PU_FREE && block->next->tag == PU_FREE)
 	    I_Error ("Z_CheckHeap: two consecutive free blocks\n");
     }
+
+    // [JN] Arenas.
+    for (i = 0; i < NUMARENAS; i++)
+    {
+        const char *const error = Z_WalkArena(&arenas[i], NULL);
+
+        if (error)
+            I_Error ("Z_CheckHeap: %s\n", error);
+    }
 }
 
 
@@ -505,7 +1273,7 @@ void Z_ChangeTag2(void *ptr, int tag, const char *file, int line)
 	
     block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
 
-    if (block->id != ZONEID)
+    if (block->id != ZONEID && block->id != ARENAID)
         I_Error("%s:%i: Z_ChangeTag: block without a ZONEID!",
                 file, line);
 
@@ -513,20 +1281,67 @@ void Z_ChangeTag2(void *ptr, int tag, const char *file, int line)
         I_Error("%s:%i: Z_ChangeTag: an owner is required "
                 "for purgable blocks", file, line);
 
+    I_LockCache();
+    // [JN] Arena can't be released as a whole anymore.
+    if (block->id == ARENAID && block->tag != tag)
+        arenas[CHUNK(block)->arena].changed++;
+    Z_CountBlock(block->tag, -block->size);
+    Z_CountBlock(tag, block->size);
     block->tag = tag;
+    I_UnlockCache();
 }
 
-void Z_ChangeUser(void *ptr, void **user)
+//
+// [JN] Z_StartPinning, Z_StopPinning, Z_PinBlock
+// Blocks pinned between Z_StartPinning and Z_StopPinning keep their tag,
+// but are not purged until Z_StopPinning.  Used by the strip renderer,
+// which draws from cached blocks long after it has looked them up.
+//
+void Z_StartPinning (void)
+{
+    pingen++;
+    pinning = true;
+}
+
+void Z_StopPinning (void)
+{
+    pinning = false;
+}
+
+void Z_PinBlock (void *ptr)
 {
     memblock_t*	block;
 
+    if (!pinning)
+        return;
+
     block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
 
     if (block->id != ZONEID)
+        I_Error("Z_PinBlock: block without a ZONEID!");
+
+    I_LockCache();
+    block->pin = pingen;
+    I_UnlockCache();
+}
+
+void Z_ChangeUser(void *ptr, void **user)
+{
+    memblock_t*	block;
+
+    block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
+
+    if (block->id != ZONEID && block->id != ARENAID)
     {
         I_Error("Z_ChangeUser: Tried to change user for invalid block!");
     }
 
+    // [JN] Arena can't be released as a whole anymore.
+    if (block->id == ARENAID)
+    {
+        arenas[CHUNK(block)->arena].changed++;
+    }
+
     block->user = user;
     *user = ptr;
 }
@@ -559,3 +1374,198 @@ unsigned int Z_ZoneSize(void)
     return mainzone->size;
 }
 
+//
+// [JN] Z_GetStats
+//
+void Z_GetStats (zonestats_t *stats)
+{
+    memblock_t *block;
+
+    memcpy(stats->bytes, tag_bytes, sizeof(tag_bytes));
+    memcpy(stats->blocks, tag_blocks, sizeof(tag_blocks));
+    memcpy(stats->peak, tag_peak, sizeof(tag_peak));
+    stats->mallocs = zone_mallocs;
+    stats->frees = zone_frees;
+    stats->zonesize = mainzone->size;
+    stats->growths = zone_growths;
+    stats->freebytes = 0;
+    stats->largestfree = 0;
+
+    I_LockCache();
+
+    for (block = mainzone->blocklist.next ;
+         block != &mainzone->blocklist;
+         block = block->next)
+    {
+        if (block->tag == PU_FREE)
+        {
+            stats->freebytes += block->size;
+
+            if (block->size > stats->largestfree)
+            {
+                stats->largestfree = block->size;
+            }
+        }
+    }
+
+    I_UnlockCache();
+}
+
+//
+// [JN] Z_LogStats
+// Writes a line to the -zonestats file and starts new peaks.
+//
+void Z_LogStats (const char *mapname)
+{
+    static unsigned int lastmallocs, lastfrees;
+    zonestats_t stats;
+    int i;
+
+    if (!zonestats_file)
+    {
+        return;
+    }
+
+    Z_GetStats(&stats);
+
+    fprintf(zonestats_file, "%s,%d,%d,%d,%d,%.3f", mapname,
+            stats.zonesize, stats.growths, stats.freebytes, stats.largestfree,
+            stats.freebytes ? 1.0 - (double) stats.largestfree / stats.freebytes : 0.0);
+
+    for (i = 1; i < PU_NUM_TAGS; i++)
+    {
+        if (zone_tagnames[i])
+        {
+            fprintf(zonestats_file, ",%d,%d,%d",
+                    stats.bytes[i], stats.blocks[i], stats.peak[i]);
+        }
+    }
+
+    fprintf(zonestats_file, ",%u,%u\n",
+            stats.mallocs - lastmallocs, stats.frees - lastfrees);
+    fflush(zonestats_file);
+
+    lastmallocs = stats.mallocs;
+    lastfrees = stats.frees;
+    memcpy(tag_peak, tag_bytes, sizeof(tag_peak));
+}
+
+//
+// [JN] Z_Benchmark
+// Stress test of the allocator: each "level" fills the zone with small
+// objects, churns them with frees and allocations mixed with cached
+// lumps, then frees them with Z_FreeTags.  Objects with an owner go
+// through the block list, anonymous ones through the arenas, so both
+// are timed with the same sequence of sizes.
+//
+
+#define ZONEBENCH_LEVELS   20
+#define ZONEBENCH_OBJECTS  40000
+#define ZONEBENCH_CHURN    400000
+#define ZONEBENCH_LUMPS    64
+
+static unsigned int benchseed;
+
+static int BenchRandom (void)
+{
+    benchseed = benchseed * 1103515245 + 12345;
+    return (benchseed >> 16) & 0x7fff;
+}
+
+static void BenchAlloc (void **obj, boolean owned)
+{
+    // Mostly thinker and mobj sized, sometimes something larger.
+    static const int sizes[] = { 40, 56, 72, 104, 200, 232, 320, 1024 };
+    const int size = sizes[BenchRandom() % arrlen(sizes)];
+    const int tag = BenchRandom() % 4 ? PU_LEVEL : PU_LEVSPEC;
+
+    if (owned)
+    {
+        Z_Malloc(size, tag, obj);
+    }
+    else
+    {
+        *obj = Z_Malloc(size, tag, NULL);
+    }
+}
+
+static void Z_BenchmarkRun (boolean owned)
+{
+    void **objs = I_Realloc(NULL, ZONEBENCH_OBJECTS * sizeof(*objs));
+    void *lumps[ZONEBENCH_LUMPS] = { NULL };
+    const int growths = zone_growths;
+    uint64_t start, churntime = 0, freetime = 0;
+    int level, op, i;
+
+    benchseed = 1;
+
+    for (level = 0; level < ZONEBENCH_LEVELS; level++)
+    {
+        start = I_GetTimeUS();
+
+        for (i = 0; i < ZONEBENCH_OBJECTS; i++)
+        {
+            BenchAlloc(&objs[i], owned);
+        }
+
+        for (op = 0; op < ZONEBENCH_CHURN; op++)
+        {
+            i = BenchRandom() % ZONEBENCH_OBJECTS;
+            Z_Free(objs[i]);
+            BenchAlloc(&objs[i], owned);
+
+            // Lumps get cached now and then, and purged when needed.
+            if (op % 64 == 0)
+            {
+                i = BenchRandom() % ZONEBENCH_LUMPS;
+
+                if (!lumps[i])
+                {
+                    Z_Malloc(4096 + BenchRandom() % 16 * 1024, PU_CACHE, &lumps[i]);
+                }
+            }
+        }
+
+        churntime += I_GetTimeUS() - start;
+        start = I_GetTimeUS();
+
+        Z_FreeTags(PU_LEVEL, PU_PURGELEVEL - 1);
+
+        freetime += I_GetTimeUS() - start;
+
+        Z_CheckHeap();
+    }
+
+    for (i = 0; i < ZONEBENCH_LUMPS; i++)
+    {
+        if (lumps[i])
+        {
+            Z_Free(lumps[i]);
+        }
+    }
+
+    free(objs);
+
+    printf("  %s: %.1f ns per Z_Malloc/Z_Free, Z_FreeTags %.2f ms per level,"
+           " %d zone growths\n",
+           owned ? "block list" : "arenas    ",
+           churntime * 1000.0 / ZONEBENCH_LEVELS
+                     / (ZONEBENCH_OBJECTS + 2 * ZONEBENCH_CHURN),
+           freetime / 1000.0 / ZONEBENCH_LEVELS, zone_growths - growths);
+}
+
+static void Z_Benchmark (void)
+{
+    const unsigned int mallocs = zone_mallocs, frees = zone_frees;
+
+    printf("Z_Benchmark: %d levels of %d objects, %d churn operations each:\n",
+           ZONEBENCH_LEVELS, ZONEBENCH_OBJECTS, ZONEBENCH_CHURN);
+
+    Z_BenchmarkRun(true);
+    Z_BenchmarkRun(false);
+
+    // Keep the benchmark out of the -zonestats numbers.
+    zone_mallocs = mallocs;
+    zone_frees = frees;
+    memcpy(tag_peak, tag_bytes, sizeof(tag_peak));
+}
@@ -63,6 +63,30 @@ void    Z_ChangeUser(void *ptr, void **user);
 int     Z_FreeMemory (void);
 unsigned int Z_ZoneSize(void);
 
+// [JN] Keeps blocks looked up by the strip renderer from being purged.
+void    Z_StartPinning (void);
+void    Z_StopPinning (void);
+void    Z_PinBlock (void *ptr);
+
+// [JN] Zone memory statistics.
+typedef struct
+{
+    int          bytes[PU_NUM_TAGS];    // in use, including headers
+    int          blocks[PU_NUM_TAGS];
+    int          peak[PU_NUM_TAGS];     // highest bytes since last log line
+    unsigned int mallocs;               // allocations since startup
+    unsigned int frees;                 // blocks freed since startup
+    int          zonesize;
+    int          freebytes;             // in free blocks of the zone
+    int          largestfree;           // largest free block
+    int          growths;               // times a bigger zone was added
+} zonestats_t;
+
+extern const char *zone_tagnames[PU_NUM_TAGS];
+
+void    Z_GetStats (zonestats_t *stats);
+void    Z_LogStats (const char *mapname);
+
 //
 // This is used to get the local FILE:LINE info from CPP
 // prior to really call the function in question.